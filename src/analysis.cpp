@@ -618,6 +618,7 @@ void WidomInsertion::_sample() {
             group.cm =
                 Geometry::massCenter(group.begin(), group.end(), space.geo.getBoundaryFunc(), -group.begin()->pos);
         }
+        space.updateParticleArrays(change);
         double energy_change = hamiltonian.energy(change); // in kT units
         exponential_average += std::exp(-energy_change);   // widom average
     }
@@ -1598,8 +1599,10 @@ void VirtualTranslate::_sample() {
                 double uold = pot.energy(change);              // old energy
                 Point dr = dL * dir;                           // translation vector
                 it->translate(dr, spc.geo.getBoundaryFunc());  // translate
+                spc.updateParticleArrays(change);
                 double unew = pot.energy(change);              // new energy
                 it->translate(-dr, spc.geo.getBoundaryFunc()); // restore positions
+                spc.updateParticleArrays(change);
                 double du = unew - uold;
                 if (-du > pc::max_exp_argument)
                     faunus_logger->warn("{}: energy too negative to sample", name);
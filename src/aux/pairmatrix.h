@@ -1,14 +1,35 @@
 #pragma once
 #include <doctest/doctest.h>
 #include <vector>
+#include <new>
+#include <cassert>
+#include <algorithm>
+#include <cstdint>
 namespace Faunus {
+
+/**
+ * @brief Allocator aligning memory to a given boundary, e.g. a cache line
+ */
+template <class T, size_t alignment = 64> struct AlignedAllocator {
+    typedef T value_type;
+    template <class U> struct rebind { typedef AlignedAllocator<U, alignment> other; };
+    AlignedAllocator() = default;
+    template <class U> AlignedAllocator(const AlignedAllocator<U, alignment> &) {}
+    T *allocate(size_t n) {
+        return static_cast<T *>(::operator new(n * sizeof(T), std::align_val_t(std::max(alignment, alignof(T)))));
+    }
+    void deallocate(T *ptr, size_t) { ::operator delete(ptr, std::align_val_t(std::max(alignment, alignof(T)))); }
+    template <class U> bool operator==(const AlignedAllocator<U, alignment> &) const { return true; }
+    template <class U> bool operator!=(const AlignedAllocator<U, alignment> &) const { return false; }
+};
+
 /**
  * @brief Container for data between pairs
  *
  * Symmetric, dynamic NxN matrix for storing data
  * about pairs. Set values with `set()`. If `triangular==true`
- * the memory usage is reduced but introduces an `if`-statement
- * upon access.
+ * only the lower triangle is stored (packed) which reduces the memory
+ * usage to N(N+1)/2 elements at the cost of a min/max upon access.
  *
  * ~~~ cpp
  *     int i=2,j=3; // particle type, for example
@@ -18,51 +39,63 @@ namespace Faunus {
  *     cout << m(i,j)==m(j,i); // -> true
  * ~~~
  *
- * @note Vector of vector does not allocate contiguous memory
+ * All elements are stored in a single, contiguous buffer aligned to a
+ * cache line; full matrices are stored in row-major order.
  */
 template <class T, bool triangular = false> class PairMatrix {
   private:
-    T default_value; // default value when resizing
-    std::vector<std::vector<T>> matrix;
+    T default_value;                            // default value when resizing
+    size_t n = 0;                               // number of rows and columns
+    std::vector<T, AlignedAllocator<T>> matrix; // flat storage of all elements
+
+    static constexpr size_t packed(size_t row, size_t column) {
+        return row * (row + 1) / 2 + column;
+    } //!< index in packed lower triangle where row >= column
+
+    static constexpr size_t storageSize(size_t n) {
+        return triangular ? n * (n + 1) / 2 : n * n;
+    } //!< number of stored elements
+
+    constexpr size_t index(size_t i, size_t j) const {
+        if constexpr (triangular) {
+            return packed(std::max(i, j), std::min(i, j));
+        } else {
+            return i * n + j;
+        }
+    } //!< (i,j) --> index in flat storage
 
   public:
-    void resize(size_t n) {
-        matrix.resize(n);
-        for (size_t i = 0; i < matrix.size(); i++) {
-            if constexpr (triangular) {
-                matrix[i].resize(i + 1, default_value);
-            } else {
-                matrix[i].resize(n, default_value);
+    void resize(size_t new_size) {
+        if constexpr (triangular) { // packed index is independent of the matrix size
+            matrix.resize(storageSize(new_size), default_value);
+        } else if (new_size != n) { // row-major; copy the overlapping block
+            decltype(matrix) resized(storageSize(new_size), default_value);
+            for (size_t i = 0; i < std::min(n, new_size); i++) {
+                std::copy_n(matrix.begin() + i * n, std::min(n, new_size), resized.begin() + i * new_size);
             }
+            matrix = std::move(resized);
         }
+        n = new_size;
     }
 
     PairMatrix(size_t n = 0, T val = T()) : default_value(val) { resize(n); }
 
-    auto size() const { return matrix.size(); }
+    auto size() const { return n; }
 
     inline const T &operator()(size_t i, size_t j) const {
-        if constexpr (triangular) {
-            if (j > i) {
-                std::swap(i, j);
-            }
-        }
-        assert(i < matrix.size());
-        assert(j < matrix[i].size());
-        return matrix[i][j];
+        assert(i < n);
+        assert(j < n);
+        return matrix[index(i, j)];
     }
 
     void set(size_t i, size_t j, T val) {
-        if (j > i) {
-            std::swap(i, j);
-        }
-        if (i >= matrix.size()) {
-            resize(i + 1);
+        if (std::max(i, j) >= n) {
+            resize(std::max(i, j) + 1);
         }
         if constexpr (!triangular) {
-            matrix[j][i] = val;
+            matrix[index(j, i)] = val;
         }
-        matrix[i][j] = val;
+        matrix[index(i, j)] = val;
     }
 };
 
@@ -102,6 +135,27 @@ TEST_CASE("[Faunus] PairMatrix") {
         CHECK(m(0, 2) == 0);
         CHECK(m(2, 0) == 0);
     }
+
+    SUBCASE("resize keeps values") {
+        PairMatrix<double, false> full;
+        PairMatrix<double, true> packed;
+        full.set(1, 0, 1.5);
+        packed.set(1, 0, 1.5);
+        full.set(4, 3, 2.5); // grows the matrix
+        packed.set(4, 3, 2.5);
+        CHECK(full.size() == 5);
+        CHECK(packed.size() == 5);
+        CHECK(full(0, 1) == 1.5);
+        CHECK(packed(0, 1) == 1.5);
+        CHECK(full(3, 4) == 2.5);
+        CHECK(packed(3, 4) == 2.5);
+        CHECK(full(4, 4) == 0);
+    }
+
+    SUBCASE("alignment") {
+        PairMatrix<double> m(3);
+        CHECK(reinterpret_cast<std::uintptr_t>(&m(0, 0)) % 64 == 0);
+    }
 }
 
-} // namespace Faunus
\ No newline at end of file
+} // namespace Faunus
@@ -103,14 +103,12 @@ BondData::Variant HarmonicBond::type() const { return BondData::HARMONIC; }
  */
 void HarmonicBond::setEnergyFunction(const ParticleVector &particle) {
     energyFunc = [&](Geometry::DistanceFunction dist) { // potential energy functor
-        double d = req - dist(particle[index[0]].pos, particle[index[1]].pos).norm();
-        return k_half * d * d; // kT/Å
+        return BondTables::HarmonicKernel{k_half, req}.energy(dist(particle[index[0]].pos, particle[index[1]].pos));
     };
     forceFunc = [&](Geometry::DistanceFunction dist) -> std::vector<Point> { // force functor
-        auto rvec = dist(particle[index[0]].pos, particle[index[1]].pos); // vector between points
-        double r = rvec.norm();                                           // distance between particles
-        auto force = 2.0 * k_half * (req - r) * rvec / r;                 // force on first particle
-        return {force, -force};                                           // force on both particles (kT/Å)
+        auto rvec = dist(particle[index[0]].pos, particle[index[1]].pos);    // vector between points
+        auto force = BondTables::HarmonicKernel{k_half, req}.force(rvec);    // force on first particle
+        return {force, -force};                                              // force on both particles (kT/Å)
     };
 }
 
@@ -134,9 +132,7 @@ std::string FENEBond::name() const { return "fene"; }
 
 void FENEBond::setEnergyFunction(const ParticleVector &p) {
     energyFunc = [&](Geometry::DistanceFunction dist) {
-        double r_squared = dist(p[index[0]].pos, p[index[1]].pos).squaredNorm();
-        return (r_squared >= rmax_squared) ? pc::infty
-                                           : -k_half * rmax_squared * std::log(1 - r_squared / rmax_squared);
+        return BondTables::FENEKernel{k_half, rmax_squared}.energy(dist(p[index[0]].pos, p[index[1]].pos));
     };
 }
 
@@ -164,16 +160,8 @@ void FENEWCABond::to_json(Faunus::json &j) const {
 std::string FENEWCABond::name() const { return "fene+wca"; }
 void FENEWCABond::setEnergyFunction(const ParticleVector &p) {
     energyFunc = [&](Geometry::DistanceFunction dist) {
-        double r_squared = dist(p[index[0]].pos, p[index[1]].pos).squaredNorm();
-        double wca = 0;
-        double x = sigma_squared;
-        if (r_squared <= x * 1.2599210498948732) {
-            x = x / r_squared;
-            x = x * x * x;
-            wca = epsilon * (x * x - x + 0.25);
-        }
-        return (r_squared > rmax_squared) ? pc::infty
-                                          : -k_half * rmax_squared * std::log(1 - r_squared / rmax_squared) + wca;
+        return BondTables::FENEWCAKernel{k_half, rmax_squared, epsilon, sigma_squared}.energy(
+            dist(p[index[0]].pos, p[index[1]].pos));
     };
 }
 
@@ -200,8 +188,7 @@ void HarmonicTorsion::setEnergyFunction(const ParticleVector &p) {
     energyFunc = [&](Geometry::DistanceFunction dist) {
         Point ray1 = dist(p[index[0]].pos, p[index[1]].pos);
         Point ray2 = dist(p[index[2]].pos, p[index[1]].pos);
-        double angle = std::acos(ray1.dot(ray2) / ray1.norm() / ray2.norm());
-        return k_half * (angle - aeq) * (angle - aeq);
+        return BondTables::HarmonicTorsionKernel{k_half, aeq}.energy(ray1, ray2);
     };
 }
 
@@ -227,8 +214,7 @@ void GromosTorsion::setEnergyFunction(const ParticleVector &p) {
     energyFunc = [&](Geometry::DistanceFunction dist) {
         Point ray1 = dist(p[index[0]].pos, p[index[1]].pos);
         Point ray2 = dist(p[index[2]].pos, p[index[1]].pos);
-        double dcos = cos_aeq - ray1.dot(ray2) / (ray1.norm() * ray2.norm());
-        return k_half * dcos * dcos;
+        return BondTables::GromosTorsionKernel{k_half, cos_aeq}.energy(ray1, ray2);
     };
 }
 
@@ -258,11 +244,7 @@ void PeriodicDihedral::setEnergyFunction(const ParticleVector &p) {
         Point vec1 = dist(p[index[1]].pos, p[index[0]].pos);
         Point vec2 = dist(p[index[2]].pos, p[index[1]].pos);
         Point vec3 = dist(p[index[3]].pos, p[index[2]].pos);
-        Point norm1 = vec1.cross(vec2);
-        Point norm2 = vec2.cross(vec3);
-        // atan2( [v1×v2]×[v2×v3]⋅[v2/|v2|], [v1×v2]⋅[v2×v3] )
-        double angle = atan2((norm1.cross(norm2)).dot(vec2) / vec2.norm(), norm1.dot(norm2));
-        return k * (1 + cos(n * angle - phi));
+        return BondTables::PeriodicDihedralKernel{k, phi, n}.energy(vec1, vec2, vec3);
     };
 }
 
@@ -272,6 +254,87 @@ int StretchData::numindex() const { return 2; }
 TorsionData::TorsionData(const std::vector<int> &index) : BondData(index) {}
 int TorsionData::numindex() const { return 3; }
 
+/**
+ * @brief Forces on the three particles of an angle potential
+ * @param ray1  distance vector from the central to the first particle
+ * @param ray2  distance vector from the central to the third particle
+ * @param du_dcos  derivative of the energy with respect to the cosine of the angle
+ */
+static std::array<Point, 3> angleForces(const Point &ray1, const Point &ray2, double du_dcos) {
+    const double r1 = ray1.norm();
+    const double r2 = ray2.norm();
+    const double cos_angle = ray1.dot(ray2) / (r1 * r2);
+    const Point force1 = -du_dcos * (ray2 / (r1 * r2) - cos_angle * ray1 / (r1 * r1));
+    const Point force3 = -du_dcos * (ray1 / (r1 * r2) - cos_angle * ray2 / (r2 * r2));
+    return {force1, -force1 - force3, force3};
+}
+
+std::array<Point, 3> BondTables::HarmonicTorsionKernel::force(const Point &ray1, const Point &ray2) const {
+    const double cos_angle = std::clamp(ray1.dot(ray2) / (ray1.norm() * ray2.norm()), -1.0, 1.0);
+    const double sin_angle = std::max(std::sqrt(1.0 - cos_angle * cos_angle), pc::epsilon_dbl);
+    return angleForces(ray1, ray2, -2.0 * k_half * (std::acos(cos_angle) - aeq) / sin_angle);
+}
+
+std::array<Point, 3> BondTables::GromosTorsionKernel::force(const Point &ray1, const Point &ray2) const {
+    const double cos_angle = ray1.dot(ray2) / (ray1.norm() * ray2.norm());
+    return angleForces(ray1, ray2, -2.0 * k_half * (cos_aeq - cos_angle));
+}
+
+void BondTables::add(const BondData &bond) {
+    auto indices = [&bond](auto &table) {
+        auto &index = table.index.emplace_back();
+        std::copy_n(bond.index.begin(), index.size(), index.begin());
+    };
+    switch (bond.type()) {
+    case BondData::HARMONIC: {
+        const auto &harmonic_bond = static_cast<const HarmonicBond &>(bond);
+        indices(harmonic);
+        harmonic.kernel.push_back({harmonic_bond.k_half, harmonic_bond.req});
+        break;
+    }
+    case BondData::FENE: {
+        const auto &fene_bond = static_cast<const FENEBond &>(bond);
+        indices(fene);
+        fene.kernel.push_back({fene_bond.k_half, fene_bond.rmax_squared});
+        break;
+    }
+    case BondData::FENEWCA: {
+        const auto &fene_wca_bond = static_cast<const FENEWCABond &>(bond);
+        indices(fene_wca);
+        fene_wca.kernel.push_back(
+            {fene_wca_bond.k_half, fene_wca_bond.rmax_squared, fene_wca_bond.epsilon, fene_wca_bond.sigma_squared});
+        break;
+    }
+    case BondData::HARMONIC_TORSION: {
+        const auto &torsion = static_cast<const HarmonicTorsion &>(bond);
+        indices(harmonic_torsion);
+        harmonic_torsion.kernel.push_back({torsion.k_half, torsion.aeq});
+        break;
+    }
+    case BondData::GROMOS_TORSION: {
+        const auto &torsion = static_cast<const GromosTorsion &>(bond);
+        indices(gromos_torsion);
+        gromos_torsion.kernel.push_back({torsion.k_half, torsion.cos_aeq});
+        break;
+    }
+    case BondData::PERIODIC_DIHEDRAL: {
+        const auto &dihedral = static_cast<const PeriodicDihedral &>(bond);
+        indices(periodic_dihedral);
+        periodic_dihedral.kernel.push_back({dihedral.k, dihedral.phi, dihedral.n});
+        break;
+    }
+    default:
+        throw std::runtime_error("unknown bond type: " + bond.name());
+    }
+}
+
+void BondTables::clear() { *this = BondTables(); }
+
+size_t BondTables::size() const {
+    return harmonic.index.size() + fene.index.size() + fene_wca.index.size() + harmonic_torsion.index.size() +
+           gromos_torsion.index.size() + periodic_dihedral.index.size();
+}
+
 TEST_SUITE_BEGIN("Bonds");
 
 TEST_CASE("[Faunus] BondData") {
@@ -474,6 +537,58 @@ TEST_CASE("[Faunus] BondData") {
         CHECK(harmonic_bonds.front() == bonds.back()); // harmonic_bonds should contain references to bonds
     }
 }
+TEST_CASE("[Faunus] BondTables") {
+    using doctest::Approx;
+    ParticleVector p(5, Particle());
+    p[0].pos = {0.0, 0.0, 0.0};
+    p[1].pos = {1.1, 0.3, -0.2};
+    p[2].pos = {1.9, 1.2, 0.4};
+    p[3].pos = {2.2, 2.4, 1.5};
+    p[4].pos = {3.0, 2.1, 2.7};
+    std::vector<std::shared_ptr<BondData>> bonds = {
+        std::make_shared<HarmonicBond>(100.0, 1.5, std::vector<int>{0, 1}),
+        std::make_shared<FENEBond>(10.0, 3.0, std::vector<int>{1, 2}),
+        std::make_shared<FENEWCABond>(10.0, 3.0, 1.0, 1.2, std::vector<int>{2, 3}),
+        std::make_shared<HarmonicTorsion>(20.0, 100.0_deg, std::vector<int>{0, 1, 2}),
+        std::make_shared<GromosTorsion>(20.0, cos(120.0_deg), std::vector<int>{2, 3, 4})};
+    auto distance = [](const Point &a, const Point &b) -> Point { return a - b; };
+
+    BondTables tables;
+    double energy = 0;
+    for (auto &bond : bonds) {
+        setBondEnergyFunction(bond, p);
+        energy += bond->energyFunc(distance);
+        tables.add(*bond);
+    }
+    CHECK(tables.size() == bonds.size());
+    CHECK(tables.energy(p, distance) == Approx(energy));
+
+    SUBCASE("Forces") { // compare with central differences of the energy
+        PointVector forces(p.size(), Point::Zero());
+        tables.force(p, distance, forces);
+        const double delta = 1e-6;
+        for (size_t i = 0; i < p.size(); i++) {
+            for (int dim = 0; dim < 3; dim++) {
+                p[i].pos[dim] += delta;
+                const double energy_forward = tables.energy(p, distance);
+                p[i].pos[dim] -= 2 * delta;
+                const double energy_backward = tables.energy(p, distance);
+                p[i].pos[dim] += delta;
+                CHECK(forces[i][dim] == Approx(-(energy_forward - energy_backward) / (2 * delta)).epsilon(1e-5));
+            }
+        }
+    }
+
+    SUBCASE("Periodic dihedral") {
+        auto dihedral = std::make_shared<PeriodicDihedral>(10.0, 0.0, 3, std::vector<int>{0, 1, 2, 3});
+        dihedral->setEnergyFunction(p);
+        tables.add(*dihedral);
+        CHECK(tables.energy(p, distance) == Approx(energy + dihedral->energyFunc(distance)));
+        PointVector forces(p.size(), Point::Zero());
+        CHECK_THROWS(tables.force(p, distance, forces));
+    }
+}
+
 TEST_SUITE_END();
 
 } // namespace
\ No newline at end of file
@@ -3,6 +3,7 @@
 #include "core.h"
 //#include "auxiliary.h"
 #include "particle.h"
+#include "units.h"
 
 namespace Faunus {
 
@@ -157,6 +158,192 @@ struct PeriodicDihedral : public BondData {
     PeriodicDihedral(double k, double phi, double n, const std::vector<int> &index);
 };
 
+/**
+ * @brief Bonds sorted by type into contiguous tables of particle indices and parameters
+ *
+ * Each bond type is stored in its own table and evaluated in a tight loop, i.e. without virtual
+ * function calls or `std::function` overhead as for `BondData::energyFunc`. The tables are compiled
+ * from `BondData` objects which remain the input and output representation. The kernels below
+ * define the potentials and are shared with the `BondData` energy functions.
+ *
+ * Distance vectors are obtained as `distance(a, b)`, e.g. `Geometry::Chameleon::vdist()`.
+ */
+class BondTables {
+  public:
+    struct HarmonicKernel {
+        double k_half, req;
+        double energy(const Point &r) const {
+            const double d = req - r.norm();
+            return k_half * d * d;
+        }
+        Point force(const Point &r) const {
+            const double r_norm = r.norm();
+            return 2.0 * k_half * (req - r_norm) * r / r_norm;
+        } //!< Force on first particle; `r` is the distance vector from the second particle
+    };
+
+    struct FENEKernel {
+        double k_half, rmax_squared;
+        double energy(const Point &r) const {
+            const double r_squared = r.squaredNorm();
+            return (r_squared >= rmax_squared) ? pc::infty
+                                               : -k_half * rmax_squared * std::log(1 - r_squared / rmax_squared);
+        }
+        Point force(const Point &r) const {
+            return -2.0 * k_half * r / (1 - r.squaredNorm() / rmax_squared);
+        } //!< Force on first particle; `r` is the distance vector from the second particle
+    };
+
+    struct FENEWCAKernel {
+        double k_half, rmax_squared, epsilon, sigma_squared;
+        double energy(const Point &r) const {
+            const double r_squared = r.squaredNorm();
+            double wca = 0;
+            if (r_squared <= sigma_squared * 1.2599210498948732) {
+                double x = sigma_squared / r_squared;
+                x = x * x * x;
+                wca = epsilon * (x * x - x + 0.25);
+            }
+            return (r_squared > rmax_squared) ? pc::infty
+                                              : -k_half * rmax_squared * std::log(1 - r_squared / rmax_squared) + wca;
+        }
+        Point force(const Point &r) const {
+            const double r_squared = r.squaredNorm();
+            Point force = -2.0 * k_half * r / (1 - r_squared / rmax_squared);
+            if (r_squared <= sigma_squared * 1.2599210498948732) {
+                double x = sigma_squared / r_squared;
+                x = x * x * x;
+                force += 6.0 * epsilon * x * (2.0 * x - 1.0) / r_squared * r;
+            }
+            return force;
+        } //!< Force on first particle; `r` is the distance vector from the second particle
+    };
+
+    struct HarmonicTorsionKernel {
+        double k_half, aeq;
+        double energy(const Point &ray1, const Point &ray2) const {
+            const double angle = std::acos(ray1.dot(ray2) / ray1.norm() / ray2.norm());
+            return k_half * (angle - aeq) * (angle - aeq);
+        }
+        std::array<Point, 3> force(const Point &ray1, const Point &ray2) const; //!< Forces on the three particles
+    };
+
+    struct GromosTorsionKernel {
+        double k_half, cos_aeq;
+        double energy(const Point &ray1, const Point &ray2) const {
+            const double dcos = cos_aeq - ray1.dot(ray2) / (ray1.norm() * ray2.norm());
+            return k_half * dcos * dcos;
+        }
+        std::array<Point, 3> force(const Point &ray1, const Point &ray2) const; //!< Forces on the three particles
+    };
+
+    struct PeriodicDihedralKernel {
+        double k, phi, n;
+        double energy(const Point &vec1, const Point &vec2, const Point &vec3) const {
+            const Point norm1 = vec1.cross(vec2);
+            const Point norm2 = vec2.cross(vec3);
+            // atan2( [v1×v2]×[v2×v3]⋅[v2/|v2|], [v1×v2]⋅[v2×v3] )
+            const double angle = std::atan2((norm1.cross(norm2)).dot(vec2) / vec2.norm(), norm1.dot(norm2));
+            return k * (1 + std::cos(n * angle - phi));
+        }
+    };
+
+  private:
+    template <typename TKernel, size_t N> struct Table {
+        std::vector<std::array<int, N>> index; //!< absolute particle indices of each bond
+        std::vector<TKernel> kernel;           //!< parameters of each bond
+    };
+    Table<HarmonicKernel, 2> harmonic;
+    Table<FENEKernel, 2> fene;
+    Table<FENEWCAKernel, 2> fene_wca;
+    Table<HarmonicTorsionKernel, 3> harmonic_torsion;
+    Table<GromosTorsionKernel, 3> gromos_torsion;
+    Table<PeriodicDihedralKernel, 4> periodic_dihedral;
+
+    template <typename TKernel, typename TDistance>
+    static double stretchEnergy(const Table<TKernel, 2> &table, const ParticleVector &p, TDistance &distance) {
+        double energy = 0;
+        for (size_t i = 0; i < table.index.size(); ++i) {
+            const auto &[a, b] = table.index[i];
+            energy += table.kernel[i].energy(distance(p[a].pos, p[b].pos));
+        }
+        return energy;
+    }
+
+    template <typename TKernel, typename TDistance>
+    static double torsionEnergy(const Table<TKernel, 3> &table, const ParticleVector &p, TDistance &distance) {
+        double energy = 0;
+        for (size_t i = 0; i < table.index.size(); ++i) {
+            const auto &[a, b, c] = table.index[i];
+            energy += table.kernel[i].energy(distance(p[a].pos, p[b].pos), distance(p[c].pos, p[b].pos));
+        }
+        return energy;
+    }
+
+    template <typename TKernel, typename TDistance>
+    static void stretchForce(const Table<TKernel, 2> &table, const ParticleVector &p, TDistance &distance,
+                             PointVector &forces) {
+        for (size_t i = 0; i < table.index.size(); ++i) {
+            const auto &[a, b] = table.index[i];
+            const Point force = table.kernel[i].force(distance(p[a].pos, p[b].pos));
+            forces[a] += force;
+            forces[b] -= force;
+        }
+    }
+
+    template <typename TKernel, typename TDistance>
+    static void torsionForce(const Table<TKernel, 3> &table, const ParticleVector &p, TDistance &distance,
+                             PointVector &forces) {
+        for (size_t i = 0; i < table.index.size(); ++i) {
+            const auto &[a, b, c] = table.index[i];
+            const auto force = table.kernel[i].force(distance(p[a].pos, p[b].pos), distance(p[c].pos, p[b].pos));
+            forces[a] += force[0];
+            forces[b] += force[1];
+            forces[c] += force[2];
+        }
+    }
+
+  public:
+    void add(const BondData &); //!< Add bond to the table of its type
+    void clear();               //!< Remove all bonds
+    size_t size() const;        //!< Total number of bonds
+
+    /**
+     * @brief Sum of the energies of all bonds
+     * @param p  particle vector indexed by the bonds
+     * @param distance  function returning the (minimum) distance vector between two positions
+     */
+    template <typename TDistance> double energy(const ParticleVector &p, TDistance distance) const {
+        double energy = stretchEnergy(harmonic, p, distance) + stretchEnergy(fene, p, distance) +
+                        stretchEnergy(fene_wca, p, distance) + torsionEnergy(harmonic_torsion, p, distance) +
+                        torsionEnergy(gromos_torsion, p, distance);
+        for (size_t i = 0; i < periodic_dihedral.index.size(); ++i) {
+            const auto &[a, b, c, d] = periodic_dihedral.index[i];
+            energy += periodic_dihedral.kernel[i].energy(distance(p[b].pos, p[a].pos), distance(p[c].pos, p[b].pos),
+                                                         distance(p[d].pos, p[c].pos));
+        }
+        return energy;
+    }
+
+    /**
+     * @brief Adds the forces of all bonds
+     * @param p  particle vector indexed by the bonds
+     * @param distance  function returning the (minimum) distance vector between two positions
+     * @param forces  force on each particle in `p` (kT/Å)
+     * @throw std::runtime_error if forces are unavailable for a bond type
+     */
+    template <typename TDistance> void force(const ParticleVector &p, TDistance distance, PointVector &forces) const {
+        if (!periodic_dihedral.index.empty()) {
+            throw std::runtime_error("forces not implemented for periodic dihedrals");
+        }
+        stretchForce(harmonic, p, distance, forces);
+        stretchForce(fene, p, distance, forces);
+        stretchForce(fene_wca, p, distance, forces);
+        torsionForce(harmonic_torsion, p, distance, forces);
+        torsionForce(gromos_torsion, p, distance, forces);
+    }
+};
+
 /*
  * Serialize to/from json
  */
@@ -2,7 +2,9 @@
 
 #include <iostream>
 #include <vector>
-#include <set>
+#include <functional>
+#include <stdexcept>
+#include <algorithm>
 #include <cassert>
 #include <cmath>
 #include <array>
@@ -19,114 +21,178 @@ namespace Faunus {
  *
  * - cartesian space is assumed to use all 8 octants (i.e. +/i round 0,0,0)
  * - grid space use only the first octant (all +)
- * - resolution and size is set by `resize`
+ * - resolution and size is set by `resize`; the cell side lengths
+ *   are never smaller than the given cutoff distance
  * - index of neighbors to a grid point
  *   is obtained with `neighbors()`
- * - index can be moved from one grid point to another with `move()`
+ * - index can be inserted, erased or moved with `insert()`, `erase()`
+ *   and `update()`; a full rebuild is done by `update(vector)`
  * - the list of particle index in each grid point is stored in a
- *   `std::set<int>` container.
+ *   contiguous `std::vector`; cells are stored in row-major order
  *
- * @todo
- * - Update cell list based on Change object
- * - Make a non-periodic version
- * - std::set --> set::vector?
+ * All incremental modifications are recorded in a journal such that
+ * the list can be restored with `rollback()`, e.g. when a Monte Carlo
+ * move is rejected. The journal is emptied with `commit()`. Changing the
+ * grid with `resize()` invalidates the journal, whereas `rescale()`
+ * keeps the cells and may be rolled back.
+ *
+ * @todo Make a non-periodic version
  *
  * @date Malmo, March 2018
  */
 template <typename CellPoint = Eigen::Vector3i> class CellList {
     typedef size_t Tindex;
     typedef Eigen::Vector3d Point;
-    Point halfbox;
-    double cellsize = 0;                                           // cell side length (angstrom)
-    std::vector<std::vector<std::vector<std::set<Tindex>>>> cells; // dense storage
+    typedef std::vector<Tindex> Tcell;
+
+    struct Grid {
+        Point halfbox = {0, 0, 0};
+        Point cellsize = {0, 0, 0}; // cell side lengths (angstrom)
+    };
 
-    std::vector<std::set<Tindex>> cells_dense;    // dense storage (to replace `cells`)
-    std::map<int, std::set<Tindex>> cells_sparse; // sparse storage
+    Grid grid;
+    std::vector<Tcell> cells;                    // dense storage of all cells in row-major order
+    std::vector<int> cell_of_index;              // cell of each index (row-major); -1 if not present
+    std::vector<std::pair<Tindex, int>> journal; // index and its previous cell (or -1) since last commit
+    Grid committed_grid;                         // grid at last commit
+    bool journal_is_valid = false;               // false if the list cannot be rolled back
 
-    inline std::set<Tindex> &row_major(const CellPoint &c) {
-        return cells_dense[c[0] * KLM[0] * KLM[2] + c[1] * KLM[2] + c[2]]; // to replace operator[] below
-    }                                                                      // row-major ordering of dense storage
+    static inline int wrap(int c, int size) {
+        return c < 0 ? c + size : (c >= size ? c - size : c);
+    } //!< periodic boundary for cell index in [-size, 2*size)
+
+    inline int row_major(const CellPoint &c) const { return (c[0] * KLM[1] + c[1]) * KLM[2] + c[2]; }
+
+    int relocate(Tindex i, int cell) {
+        if (i >= cell_of_index.size())
+            cell_of_index.resize(i + 1, -1);
+        const int old_cell = cell_of_index[i];
+        if (old_cell != cell) {
+            if (old_cell >= 0) {
+                auto &src = cells[old_cell];
+                auto it = std::find(src.begin(), src.end(), i);
+                assert(it != src.end() && "i not present in old cell");
+                *it = src.back(); // order within a cell is irrelevant; avoid shifting
+                src.pop_back();
+            }
+            if (cell >= 0)
+                cells[cell].push_back(i);
+            cell_of_index[i] = cell;
+        }
+        return old_cell;
+    } //!< move index i to cell (-1 = remove) and return previous cell (complexity: cell size)
+
+    void place(Tindex i, int cell) {
+        const int old_cell = relocate(i, cell);
+        if (journal_is_valid && old_cell != cell)
+            journal.emplace_back(i, old_cell);
+    } //!< as relocate() but recorded in a valid journal
 
   public:
-    bool sparse = false;
-    CellPoint KLM = {0, 0, 0}; // max cell index K,L,M
+    CellPoint KLM = {0, 0, 0}; // number of cells K,L,M in each direction
 
-    std::set<Tindex> &operator[](const CellPoint &c) {
-        return cells[c[0]][c[1]][c[2]];
-    } //!< returns set with all index in given cell (complexity: constant)
+    const Tcell &operator[](const CellPoint &c) const {
+        return cells[row_major(c)];
+    } //!< returns all index in given cell (complexity: constant)
 
     CellPoint p2c(const Point &p) const {
-        return ((p + halfbox) / cellsize).array().round().template cast<int>();
+        CellPoint c = ((p + grid.halfbox).array() / grid.cellsize.array()).floor().template cast<int>();
+        for (int i = 0; i < 3; i++)
+            c[i] = wrap(c[i], KLM[i]); // points on the upper boundary belong to the first cell
+        return c;
     } //!< cartesian point --> cell point
 
     Point c2p(const CellPoint &c) const {
-        return (c.template cast<double>()) * cellsize - halfbox;
-    } //!< cell point --> cartesian point
+        return c.template cast<double>().array() * grid.cellsize.array() - grid.halfbox.array();
+    } //!< cell point --> cartesian point (lower cell corner)
+
+    bool contains(Tindex i) const {
+        return i < cell_of_index.size() && cell_of_index[i] >= 0;
+    } //!< true if index i is present in any cell
 
-    void move(Tindex i, const CellPoint &src, const CellPoint &dst) {
-        assert((*this)[src].count(i) == 1 && "i not present in old cell");
-        assert((*this)[dst].count(i) == 0 && "i already in new cell");
-        (*this)[src].erase(i);
-        (*this)[dst].insert(i);
-    } //!< move particle index i from one cell to another (complexity: log N)
+    void insert(Tindex i, const Point &pos) { place(i, row_major(p2c(pos))); } //!< insert (or move) index i
+
+    void erase(Tindex i) {
+        if (contains(i))
+            place(i, -1);
+    } //!< remove index i if present
+
+    bool update(Tindex i, const Point &pos) {
+        const int cell = row_major(p2c(pos));
+        if (i < cell_of_index.size() && cell_of_index[i] == cell)
+            return false;
+        place(i, cell);
+        return true;
+    } //!< move index i into the cell matching `pos`; true if moved
 
     void resize(const Point &box, double cutoff) {
-        clear();
-        halfbox = 0.5 * box;
-        cellsize = cutoff;
-        KLM = (box / cellsize).array().round().template cast<int>();
-        if (KLM.minCoeff() >= 3) {
-            cells.resize(KLM[0] + 1);
-            for (auto &k : cells) {
-                k.resize(KLM[1] + 1);
-                for (auto &l : k)
-                    l.resize(KLM[2] + 1);
-            }
-        } else
+        KLM = (box / cutoff).array().floor().template cast<int>();
+        if (KLM.minCoeff() < 3)
             throw std::runtime_error("celllist error: too few grid point - cutoff or box too small");
-    }
+        grid.halfbox = 0.5 * box;
+        grid.cellsize = box.array() / KLM.template cast<double>().array();
+        cells.resize(KLM.prod());
+        clear();
+    } //!< new empty grid with cell side lengths of at least `cutoff`; invalidates the journal
+
+    bool rescale(const Point &box, double cutoff) {
+        const Point cellsize = box.array() / KLM.template cast<double>().array();
+        if (cells.empty() || cellsize.minCoeff() < cutoff)
+            return false;
+        grid.halfbox = 0.5 * box;
+        grid.cellsize = cellsize;
+        return true;
+    } //!< keep cells but change box; false if cells would become smaller than `cutoff`
 
     void clear() {
-        for (auto &k : cells)
-            for (auto &l : k)
-                for (auto &m : l)
-                    m.clear();
-    } //<! clear all index in cell list
+        for (auto &cell : cells)
+            cell.clear();
+        std::fill(cell_of_index.begin(), cell_of_index.end(), -1);
+        journal.clear();
+        journal_is_valid = false;
+    } //<! clear all index in cell list; invalidates the journal
 
     template <class Tpvec, class T = std::function<Point(const typename Tpvec::value_type &)>>
     void update(
         const Tpvec &p, T getpos = [](auto &i) { return i; }) {
         clear();
-        for (Tindex i = 0; i < p.size(); i++)
-            (*this)[p2c(getpos(p[i]))].insert(i);
-    }
+        cell_of_index.assign(p.size(), -1);
+        for (Tindex i = 0; i < p.size(); i++) {
+            const int cell = row_major(p2c(getpos(p[i])));
+            cells[cell].push_back(i);
+            cell_of_index[i] = cell;
+        }
+    } //!< rebuild list from scratch; invalidates the journal
+
+    void commit() {
+        journal.clear();
+        committed_grid = grid;
+        journal_is_valid = true;
+    } //!< accept all changes since last commit
+
+    bool rollback() {
+        if (!journal_is_valid)
+            return false;
+        for (auto it = journal.rbegin(); it != journal.rend(); ++it)
+            relocate(it->first, it->second);
+        journal.clear();
+        grid = committed_grid;
+        return true;
+    } //!< restore state at last commit; false if the journal is invalid (complexity: journal size)
 
     void neighbors(const Eigen::Vector3i &c, std::vector<Tindex> &index, bool clear = true) const {
         if (clear)
             index.clear();
-        int cnt = 0;
-        std::array<int, 3> k = {{c[0] - 1, c[0], c[0] + 1}}, l = {{c[1] - 1, c[1], c[1] + 1}},
-                           m = {{c[2] - 1, c[2], c[2] + 1}};
-        if (k[0] < 0)
-            k[0] = KLM[0];
-        else if (k[2] > KLM[0])
-            k[2] = 0;
-        if (l[0] < 0)
-            l[0] = KLM[1];
-        else if (l[2] > KLM[1])
-            l[2] = 0;
-        if (m[0] < 0)
-            m[0] = KLM[2];
-        else if (m[2] > KLM[2])
-            m[2] = 0;
-        for (int _k : k)
-            for (int _l : l)
-                for (int _m : m) {
-                    cnt++;
-                    auto &s = cells[_k][_l][_m];
-                    std::copy(s.begin(), s.end(), std::back_inserter(index));
+        for (int dk = -1; dk <= 1; dk++) {
+            const int k = wrap(c[0] + dk, KLM[0]);
+            for (int dl = -1; dl <= 1; dl++) {
+                const int l = wrap(c[1] + dl, KLM[1]);
+                for (int dm = -1; dm <= 1; dm++) {
+                    const auto &cell = cells[(k * KLM[1] + l) * KLM[2] + wrap(c[2] + dm, KLM[2])];
+                    index.insert(index.end(), cell.begin(), cell.end());
                 }
-        assert(cnt == 27);
+            }
+        }
     } //!< Index from all 26+1 neighboring+own cells (complexity: N neighbors)
 };
 
@@ -137,25 +203,67 @@ TEST_CASE("[Faunus] CellList") {
     CellList<Eigen::Vector3i> l;
     l.resize(box, 2);
     CHECK(l.KLM == Eigen::Vector3i(5, 10, 3));
-    CHECK(l.p2c({5, 10, 3}) == l.KLM);
+    CHECK(l.p2c({4.9, 9.9, 2.9}) == Eigen::Vector3i(4, 9, 2));
+    CHECK(l.p2c({5, 10, 3}) == Eigen::Vector3i(0, 0, 0)); // periodic boundary
     CHECK(l.p2c({-5, -10, -3}) == Eigen::Vector3i(0, 0, 0));
-    CHECK(l.p2c({0, 0, 0}) == Eigen::Vector3i(3, 5, 2));
+    CHECK(l.p2c({0, 0, 0}) == Eigen::Vector3i(2, 5, 1));
+    CHECK(l.c2p({2, 5, 1}) == Point(-1, 0, -1));
 
+    l.resize({10, 10, 10}, 3); // cells are enlarged to fill the box
+    CHECK(l.KLM == Eigen::Vector3i(3, 3, 3));
+    CHECK(l.p2c({1.7, -1.7, 0}) == Eigen::Vector3i(2, 0, 1));
+    CHECK_THROWS(l.resize(box, 2.5)); // too few cells in z
+
+    l.resize(box, 2);
     std::vector<size_t> index; // index of neighbors (and self) in...
     std::vector<Point> vec;    // ...array of points
 
-    vec = {{0, 0, 0}, {0, 3, 0}};
+    vec = {{0, 0, 0}, {0, 5, 0}};
     l.update(vec);
     l.neighbors(l.p2c(vec[0]), index);
     CHECK(index.size() == 1);  // alone by myself...
     CHECK(index.front() == 0); // ...am I really me?
 
-    vec = {{0, 0, 0}, {0, -3, 0}};
+    vec = {{0, 0, 0}, {0, -1.5, 0}};
     l.update(vec);
     l.neighbors(l.p2c(vec[0]), index);
     CHECK(index.size() == 2); // now we're two
     l.neighbors(l.p2c(vec[1]), index);
     CHECK(index.size() == 2); // now we're two
+
+    vec = {{-4.9, 0, 0}, {4.9, 0, 0}}; // neighbors across the periodic boundary
+    l.update(vec);
+    l.neighbors(l.p2c(vec[0]), index);
+    CHECK(index.size() == 2);
+
+    SUBCASE("Incremental update and rollback") {
+        vec = {{0, 0, 0}, {0, 5, 0}, {3, 3, 0}};
+        l.update(vec);
+        CHECK(l.rollback() == false); // a rebuild cannot be rolled back
+        l.commit();
+        CHECK(l.update(1, {0, 1, 0}) == true);
+        CHECK(l.update(1, {0, 1.1, 0}) == false); // same cell
+        l.erase(2);
+        l.insert(3, {0, 0, 0});
+        CHECK(l[l.p2c({0, 0, 0})].size() == 3);
+        CHECK(l.contains(2) == false);
+        CHECK(l.rollback() == true);
+        CHECK(l[l.p2c({0, 0, 0})].size() == 1);
+        CHECK(l[l.p2c({0, 5, 0})].size() == 1);
+        CHECK(l[l.p2c({3, 3, 0})].size() == 1);
+        CHECK(l.contains(2) == true);
+        CHECK(l.contains(3) == false);
+    }
+
+    SUBCASE("Rescale") {
+        l.commit();
+        CHECK(l.rescale(box * 1.1, 2) == true); // same number of cells
+        CHECK(l.KLM == Eigen::Vector3i(5, 10, 3));
+        CHECK(l.p2c({0, 5.5, 0}) == Eigen::Vector3i(2, 7, 1));
+        CHECK(l.rescale(box * 0.9, 2) == false); // cells would be too small
+        CHECK(l.rollback() == true);
+        CHECK(l.p2c({0, 5.0, 0}) == Eigen::Vector3i(2, 7, 1));
+    }
 }
 #endif
 } // namespace Faunus
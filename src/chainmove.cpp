@@ -49,6 +49,7 @@ void ChainRotationMove::_from_json(const json &j) {
 void ChainRotationMove::rotate_segment(double angle) {
     if (!segment_ndx.empty()) {
         auto &chain = *molecule_iter;
+        spc.journal.recordGroup(spc, chain);
         auto old_cm = chain.cm;
         // Uses an implementation from the old Pivot class. The translation of the chain might be unnecessary.
         auto shift_pos = spc.p[axis_ndx[0]].pos;
@@ -74,14 +75,13 @@ void ChainRotationMove::store_change(Change &change) {
     if (!segment_ndx.empty()) {
         auto &chain = *molecule_iter;
         auto offset = std::distance(spc.p.begin(), chain.begin());
-        Change::data change_data;
+        auto &change_data = change.addGroup(Change::data()); // add to list of moved groups
         for (int i : segment_ndx) {
             change_data.atoms.push_back(i - offset); // `atoms` index are relative to chain
         }
         change_data.index = Faunus::distance(spc.groups.begin(), &chain); // integer *index* of moved group
         change_data.all = false;
-        change_data.internal = true;          // trigger internal interactions
-        change.groups.push_back(change_data); // add to list of moved groups
+        change_data.internal = true; // trigger internal interactions
     }
 }
 bool ChainRotationMove::box_big_enough() {
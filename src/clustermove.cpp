@@ -241,6 +241,7 @@ void Cluster::_move(Change &change) {
         auto cluster_groups =
             cluster | views::transform([&](size_t index) -> Space::Tgroup & { return spc.groups.at(index); });
         for (auto &group : cluster_groups) {
+            spc.journal.recordGroup(spc, group);
             if (perform_rotation) {
                 rotate_group(group);
             }
@@ -0,0 +1,472 @@
+#include <doctest/doctest.h>
+#include "domainmove.h"
+#include "energy.h"
+#include "spdlog/spdlog.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+namespace Faunus::Move {
+
+static int threadNumber() {
+#ifdef _OPENMP
+    return omp_get_thread_num();
+#else
+    return 0;
+#endif
+}
+
+static int numberOfThreads() {
+#ifdef _OPENMP
+    return omp_get_max_threads();
+#else
+    return 1;
+#endif
+}
+
+/** Metropolis criterion using the given random number generator */
+static bool acceptLocalMove(double energy_change, Random &random) {
+    if (std::isnan(energy_change)) {
+        return false;
+    }
+    return energy_change <= 0.0 || random() < std::exp(-energy_change);
+}
+
+CheckerboardSweep::CheckerboardSweep(Space &spc, const Energy::Hamiltonian &pot, const json &energy)
+    : spc(spc), hamiltonian(pot), energy_input(energy) {
+    name = "checkerboard";
+    repeat = 1;
+    for (const auto &term : pot.vec) {
+        if (term->locality() == Energy::Energybase::Locality::NONLOCAL) {
+            throw ConfigurationError("{}: energy term '{}' is not local to the moved groups", name, term->name);
+        }
+    }
+}
+
+CheckerboardSweep::~CheckerboardSweep() = default;
+
+void CheckerboardSweep::_from_json(const json &j) {
+    if (spc.geo.type != Geometry::CUBOID) {
+        throw ConfigurationError("{} requires a cuboidal box", name);
+    }
+    molecule_name = j.at("molecule").get<std::string>();
+    auto molecule = findName(molecules, molecule_name);
+    if (molecule == molecules.end()) {
+        throw ConfigurationError("unknown molecule '{}'", molecule_name);
+    }
+    molid = molecule->id();
+    atomic = molecule->atomic;
+    cutoff = j.at("cutoff").get<double>();
+    dptrans = j.at("dp").get<double>();
+    dprot = j.value("dprot", 0.0);
+    directions = j.value("dir", Point(1, 1, 1));
+    if (cutoff <= 0.0) {
+        throw ConfigurationError("{}: cutoff must be positive", name);
+    }
+    for (const auto &term : hamiltonian.vec) {
+        if (!term->vanishesBeyond(cutoff)) {
+            throw ConfigurationError("{}: interactions of energy term '{}' do not vanish beyond the cutoff", name,
+                                     term->name);
+        }
+    }
+}
+
+void CheckerboardSweep::_to_json(json &j) const {
+    j = {{"molecule", molecule_name},
+         {"dp", dptrans},
+         {"dprot", dprot},
+         {"dir", directions},
+         {"cutoff", cutoff},
+         {"domains", {number_of_domains.x(), number_of_domains.y(), number_of_domains.z()}},
+         {"threads", workers.size()},
+         {u8::rootof + u8::bracket("r" + u8::squared), std::sqrt(mean_square_displacement.avg())}};
+    if (local_attempts > 0) {
+        j["local acceptance"] = double(local_accepted) / local_attempts;
+    }
+    _roundjson(j, 3);
+}
+
+Eigen::Vector3i CheckerboardSweep::domainOf(const Point &position) const {
+    Eigen::Vector3i domain;
+    for (int i = 0; i < 3; i++) {
+        double x = position[i] + 0.5 * box_length[i] - offset[i]; // in [-offset, box_length - offset)
+        if (x < 0.0) {
+            x += box_length[i];
+        }
+        domain[i] = std::min(static_cast<int>(x / domain_length[i]), number_of_domains[i] - 1);
+    }
+    return domain;
+}
+
+int CheckerboardSweep::index(const Eigen::Vector3i &domain) const {
+    return (domain.x() * number_of_domains.y() + domain.y()) * number_of_domains.z() + domain.z();
+}
+
+/**
+ * The group iterators of the copied groups are shifted to the particles of the target. The target
+ * must either be empty or have the same number of particles as the source; the particle vector is
+ * then never relocated, such that energy terms referring to the target stay valid.
+ */
+void CheckerboardSweep::copySpace(const Space &source, Space &target) {
+    target.geo = source.geo;
+    target.p = source.p;
+    target.groups.clear();
+    for (const auto &group : source.groups) {
+        target.groups.push_back(group); // still refers to the particles of the source...
+        target.groups.back().relocate(source.p.cbegin(), target.p.begin()); // ...until relocated
+    }
+    Change change;
+    change.all = true;
+    target.updateParticleArrays(change);
+}
+
+/**
+ * @param entity Atom as (group index, index relative to group) or molecule as (group index, -1)
+ */
+void CheckerboardSweep::copyEntity(const Space &source, Space &target, const std::pair<int, int> &entity) {
+    const auto [group_index, atom_index] = entity;
+    auto &group = target.groups[group_index];
+    const auto offset = std::distance(target.p.begin(), group.begin());
+    if (atom_index >= 0) {
+        group[atom_index] = source.groups[group_index][atom_index];
+        target.particle_arrays.set(offset + atom_index, group[atom_index]);
+    } else {
+        group = source.groups[group_index]; // particles and mass center
+        target.particle_arrays.update(group.begin(), group.end(), offset);
+    }
+}
+
+/**
+ * The Hamiltonians are created on first use as the number of threads may be set after
+ * the moves have been constructed.
+ */
+void CheckerboardSweep::addWorkers() {
+    while (static_cast<int>(workers.size()) < numberOfThreads()) {
+        auto &worker = workers.emplace_back();
+        worker.space = std::make_shared<Space>();
+        copySpace(spc, *worker.space); // the Hamiltonian may depend on the groups in the Space
+        const auto log_level = faunus_logger->level();
+        faunus_logger->set_level(spdlog::level::off); // do not duplicate log info
+        worker.hamiltonian = std::make_unique<Energy::Hamiltonian>(*worker.space, energy_input);
+        faunus_logger->set_level(log_level);
+        worker.hamiltonian->key = Energy::Energybase::TRIAL_MONTE_CARLO_STATE; // always evaluate
+        auto &change_data = worker.change.groups.emplace_back();
+        change_data.all = !atomic;
+        change_data.internal = atomic;
+        change_data.atoms.resize(atomic ? 1 : 0);
+    }
+}
+
+/**
+ * The number of domains along each axis is even such that domains of equal color, i.e. with
+ * equal parities of their coordinates, are separated by at least one domain of another color.
+ * Atomic groups may be partially active so all groups are searched for atoms, whereas only
+ * active molecules are moved.
+ */
+void CheckerboardSweep::setupDomains() {
+    box_length = spc.geo.getLength();
+    for (int i = 0; i < 3; i++) {
+        number_of_domains[i] = 2 * static_cast<int>(box_length[i] / (4.0 * cutoff));
+    }
+    if (number_of_domains.minCoeff() < 2) {
+        throw std::runtime_error(name + ": the box must be at least four cutoffs wide");
+    }
+    domain_length = box_length.array() / number_of_domains.cast<double>().array();
+    for (int i = 0; i < 3; i++) {
+        offset[i] = domain_length[i] * slump();
+    }
+
+    domains.resize(number_of_domains.prod());
+    Eigen::Vector3i coordinates;
+    for (coordinates.x() = 0; coordinates.x() < number_of_domains.x(); coordinates.x()++) {
+        for (coordinates.y() = 0; coordinates.y() < number_of_domains.y(); coordinates.y()++) {
+            for (coordinates.z() = 0; coordinates.z() < number_of_domains.z(); coordinates.z()++) {
+                auto &domain = domains[index(coordinates)];
+                domain.coordinates = coordinates;
+                domain.entities.clear();
+                domain.moved.clear();
+                domain.accepted = 0;
+                domain.square_displacement = 0.0;
+            }
+        }
+    }
+
+    for (auto &group : spc.findMolecules(molid, atomic ? Space::ALL : Space::ACTIVE)) {
+        const int group_index = Faunus::distance(spc.groups.begin(), &group);
+        if (atomic) {
+            for (int i = 0; i < static_cast<int>(group.size()); i++) {
+                domains[index(domainOf(group[i].pos))].entities.emplace_back(group_index, i);
+            }
+        } else if (!group.empty()) {
+            const auto domain = domainOf(group.begin()->pos);
+            if (std::all_of(group.begin(), group.end(),
+                            [&](const auto &particle) { return domainOf(particle.pos) == domain; })) {
+                domains[index(domain)].entities.emplace_back(group_index, -1);
+            }
+        }
+    }
+}
+
+/**
+ * On average, every atom or molecule in the domain is attempted to be moved once. The random
+ * number stream is seeded by the domain index.
+ */
+void CheckerboardSweep::sweepDomain(Domain &domain, unsigned int seed, Worker &worker) {
+    Random random;
+    std::seed_seq sequence{seed, static_cast<unsigned int>(index(domain.coordinates))};
+    random.engine.seed(sequence);
+    for (size_t n = 0; n < domain.entities.size(); n++) {
+        const auto [group_index, atom_index] = *random.sample(domain.entities.begin(), domain.entities.end());
+        double square_displacement = 0.0;
+        const bool accepted =
+            atomic ? moveAtom(domain.coordinates, group_index, atom_index, random, worker, square_displacement)
+                   : moveMolecule(domain.coordinates, group_index, random, worker, square_displacement);
+        if (accepted) {
+            domain.accepted++;
+            domain.square_displacement += square_displacement;
+            domain.moved.emplace_back(group_index, atom_index);
+        }
+    }
+}
+
+bool CheckerboardSweep::moveAtom(const Eigen::Vector3i &domain, int group_index, int atom_index, Random &random,
+                                 Worker &worker, double &square_displacement) {
+    auto &space = *worker.space;
+    auto &particle = space.groups[group_index][atom_index];
+    auto &change_data = worker.change.groups.front();
+    change_data.index = group_index;
+    change_data.atoms.front() = atom_index;
+    const double old_energy = worker.hamiltonian->energy(worker.change);
+
+    worker.backup.resize(1);
+    worker.backup.front() = particle;
+    particle.pos += ranunit(random, directions) * dptrans * random();
+    space.geo.boundary(particle.pos);
+    if (dprot > 0.0) {
+        const double angle = dprot * (random() - 0.5);
+        const Eigen::Quaterniond quaternion(Eigen::AngleAxisd(angle, ranunit(random)));
+        particle.rotate(quaternion, quaternion.toRotationMatrix());
+    }
+    space.updateParticleArrays(worker.change);
+
+    if (domainOf(particle.pos) == domain) {
+        const double new_energy = worker.hamiltonian->energy(worker.change);
+        if (acceptLocalMove(new_energy - old_energy, random)) {
+            square_displacement = space.geo.sqdist(worker.backup.front().pos, particle.pos);
+            return true;
+        }
+    }
+    particle = worker.backup.front(); // reject
+    space.updateParticleArrays(worker.change);
+    return false;
+}
+
+bool CheckerboardSweep::moveMolecule(const Eigen::Vector3i &domain, int group_index, Random &random, Worker &worker,
+                                     double &square_displacement) {
+    auto &space = *worker.space;
+    auto &group = space.groups[group_index];
+    worker.change.groups.front().index = group_index;
+    const double old_energy = worker.hamiltonian->energy(worker.change);
+
+    worker.backup.resize(group.size());
+    std::copy(group.begin(), group.end(), worker.backup.begin());
+    const Point old_mass_center = group.cm;
+    if (dptrans > 0.0) {
+        group.translate(ranunit(random, directions) * dptrans * random(), space.geo.getBoundaryFunc());
+    }
+    if (dprot > 0.0) {
+        const double angle = dprot * (random() - 0.5);
+        const Eigen::Quaterniond quaternion(Eigen::AngleAxisd(angle, ranunit(random)));
+        group.rotate(quaternion, space.geo.getBoundaryFunc());
+    }
+    space.updateParticleArrays(worker.change);
+
+    if (std::all_of(group.begin(), group.end(),
+                    [&](const auto &particle) { return domainOf(particle.pos) == domain; })) {
+        const double new_energy = worker.hamiltonian->energy(worker.change);
+        if (acceptLocalMove(new_energy - old_energy, random)) {
+            square_displacement = space.geo.sqdist(old_mass_center, group.cm);
+            return true;
+        }
+    }
+    std::copy(worker.backup.begin(), worker.backup.end(), group.begin()); // reject
+    group.cm = old_mass_center;
+    space.updateParticleArrays(worker.change);
+    return false;
+}
+
+/**
+ * The moves are first copied from the replicas to the shared Space, one domain at a time, and then
+ * concurrently from the shared Space to the replicas that did not make them.
+ */
+void CheckerboardSweep::publishColor() {
+    for (const int i : same_color) {
+        const auto &domain = domains[i];
+        for (const auto &entity : domain.moved) {
+            copyEntity(*workers[domain.worker].space, spc, entity);
+        }
+    }
+#pragma omp parallel for schedule(static)
+    for (int worker_index = 0; worker_index < static_cast<int>(workers.size()); worker_index++) {
+        for (const int i : same_color) {
+            const auto &domain = domains[i];
+            if (domain.worker != worker_index) {
+                for (const auto &entity : domain.moved) {
+                    copyEntity(spc, *workers[worker_index].space, entity);
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Domains of the same color are swept concurrently and the colors one after another. Each thread
+ * reads and writes only its own replica of the Space, and the shared Space is modified only
+ * between colors. A replica differs from the shared Space only by the moves made in other domains
+ * of the same color. Domains of equal color are separated by at least one domain, i.e. by two
+ * cutoffs, and entities never leave their domain, so the missing moves are always beyond the
+ * cutoff and do not change any energy difference. As each domain also draws random numbers from
+ * its own stream, the outcome is independent of the number of threads.
+ *
+ * Other moves may have changed any particle, the geometry or the groups since the latest sweep,
+ * hence the replicas are copied anew from the shared Space; concurrently, as each worker is
+ * copied by the thread that uses it.
+ */
+void CheckerboardSweep::_move(Change &change) {
+    addWorkers();
+    setupDomains();
+    if (dprot > 0.0) { // orientations of particles may change
+        for (const auto &group : spc.groups) {
+            spc.journal.recordGroup(spc, group);
+        }
+    } else {
+        spc.journal.recordPositions(spc);
+    }
+#pragma omp parallel for schedule(static)
+    for (int worker_index = 0; worker_index < static_cast<int>(workers.size()); worker_index++) {
+        auto &worker = workers[worker_index];
+        copySpace(spc, *worker.space);
+        worker.hamiltonian->init();
+    }
+
+    const unsigned int seed = slump.engine();
+    for (int color = 0; color < 8; color++) {
+        same_color.clear();
+        for (int i = 0; i < static_cast<int>(domains.size()); i++) {
+            const auto &coordinates = domains[i].coordinates;
+            if ((coordinates.x() % 2) + 2 * (coordinates.y() % 2) + 4 * (coordinates.z() % 2) == color) {
+                same_color.push_back(i);
+            }
+        }
+#pragma omp parallel for schedule(dynamic)
+        for (int k = 0; k < static_cast<int>(same_color.size()); k++) {
+            auto &domain = domains[same_color[k]];
+            domain.worker = threadNumber();
+            sweepDomain(domain, seed, workers.at(domain.worker));
+        }
+        publishColor();
+    }
+
+    moved.clear();
+    for (const auto &domain : domains) {
+        local_attempts += domain.entities.size();
+        local_accepted += domain.accepted;
+        if (domain.accepted > 0) {
+            mean_square_displacement += domain.square_displacement / domain.accepted;
+        }
+        moved.insert(moved.end(), domain.moved.begin(), domain.moved.end());
+    }
+    std::sort(moved.begin(), moved.end());
+    moved.erase(std::unique(moved.begin(), moved.end()), moved.end());
+    for (const auto [group_index, atom_index] : moved) {
+        if (change.groups.empty() || change.groups.back().index != group_index) {
+            auto &change_data = change.addGroup(Change::data());
+            change_data.index = group_index;
+            change_data.all = !atomic;     // rigid body move of molecules...
+            change_data.internal = atomic; // ...or atoms interacting within their atomic group
+        }
+        if (atom_index >= 0) {
+            change.groups.back().atoms.push_back(atom_index);
+        }
+    }
+}
+
+double CheckerboardSweep::bias(Change &, double, double) {
+    return force_accept; // local moves have been accepted individually
+}
+
+#ifdef DOCTEST_LIBRARY_INCLUDED
+TEST_CASE("[Faunus] CheckerboardSweep") {
+    using doctest::Approx;
+    atoms = R"([{ "A": { "q": 1.0, "sigma": 2.0, "eps": 1.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "salt": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    const json energy = R"([{"nonbonded": {"default": [{"wca": {"mixing": "LB"}}]}}])"_json;
+    const json input = R"({"molecule": "salt", "cutoff": 2.5, "dp": 1.0})"_json;
+
+    auto setup = [](Space &space) { // 500 particles on every other site of a lattice
+        space.geo = R"( {"type": "cuboid", "length": 24} )"_json;
+        ParticleVector particles;
+        for (int i = 0; i < 1000; i += 2) {
+            const Point site(i / 100, (i / 10) % 10, i % 10 + (i / 10) % 2);
+            particles.emplace_back(atoms.front(), 2.4 * site - Point(11.9, 11.9, 11.9));
+        }
+        space.push_back(molecules.front().id(), particles);
+    };
+    auto sweep = [&](Space &space, const Energy::Hamiltonian &hamiltonian, Change &change, unsigned int seed) {
+        CheckerboardSweep move(space, hamiltonian, energy);
+        move.from_json(input);
+        Movebase::slump.engine.seed(seed);
+        move.move(change);
+    };
+
+    Space spc, reference;
+    setup(spc);
+    setup(reference);
+    Energy::Hamiltonian hamiltonian(spc, energy), reference_hamiltonian(reference, energy);
+    Change change_all;
+    change_all.all = true;
+    spc.updateParticleArrays(change_all);
+    reference.updateParticleArrays(change_all);
+
+    SUBCASE("Energy change") {
+        Change change;
+        sweep(spc, hamiltonian, change, 1);
+        REQUIRE(!change.empty());
+        CHECK(change.groups.front().atoms.size() < spc.p.size());
+        const double energy_change = hamiltonian.energy(change) - reference_hamiltonian.energy(change);
+        const double full_energy_change = hamiltonian.energy(change_all) - reference_hamiltonian.energy(change_all);
+        CHECK(energy_change == Approx(full_energy_change));
+        CHECK(std::isfinite(full_energy_change));
+    }
+
+#ifdef _OPENMP
+    SUBCASE("Independence of number of threads") {
+        const int max_threads = omp_get_max_threads();
+        Change change;
+        omp_set_num_threads(1);
+        sweep(spc, hamiltonian, change, 2);
+        omp_set_num_threads(4);
+        sweep(reference, reference_hamiltonian, change, 2);
+        omp_set_num_threads(max_threads);
+        for (size_t i = 0; i < spc.p.size(); i++) {
+            CHECK(spc.p[i].pos == reference.p[i].pos);
+        }
+    }
+#endif
+
+    SUBCASE("Cutoff shorter than the interactions") {
+        auto create = [&](const Energy::Hamiltonian &pot, const json &terms, const json &j) {
+            CheckerboardSweep move(spc, pot, terms);
+            move.from_json(j);
+        };
+        CHECK_NOTHROW(create(hamiltonian, energy, input));
+        CHECK_THROWS_AS(create(hamiltonian, energy, R"({"molecule": "salt", "cutoff": 2.0, "dp": 1.0})"_json),
+                        ConfigurationError);
+        const json coulomb = R"([{"nonbonded": {"default": [{"coulomb": {"epsr": 80, "type": "plain"}}]}}])"_json;
+        const Energy::Hamiltonian long_ranged(spc, coulomb);
+        CHECK_THROWS_AS(create(long_ranged, coulomb, input), ConfigurationError);
+    }
+}
+#endif
+
+} // namespace Faunus::Move
@@ -0,0 +1,106 @@
+#pragma once
+
+#include "move.h"
+
+namespace Faunus {
+
+namespace Energy {
+class Hamiltonian;
+}
+
+namespace Move {
+
+/**
+ * @brief Parallel sweep of local moves using a checkerboard decomposition of a cuboidal box
+ *
+ * The box is split into an even number of domains along each axis, each at least two
+ * interaction cutoffs wide. The domains are colored as a 3D checkerboard so that domains
+ * of equal color are never adjacent, not even across the periodic boundaries. All domains of
+ * one color are therefore swept concurrently: for each domain, a thread performs Metropolis
+ * translations and rotations of the atoms (atomic molecules) or molecules that are entirely
+ * inside the domain; trial moves leaving the domain are rejected. The grid is shifted by a
+ * random offset before each sweep to preserve detailed balance.
+ *
+ * Every thread (worker) moves particles in its own replica of the Space and evaluates energies
+ * with its own Hamiltonian acting on the replica, hence no memory is shared between threads
+ * while a color is swept. Afterwards, the accepted local moves are copied to the shared Space
+ * and from there to the other replicas. A replica thus lacks only the moves made by other
+ * threads in the current color, all of which are at least two cutoffs away. The Hamiltonian may
+ * only contain terms local to the changed group or pair interactions (see `Energybase::Locality`),
+ * and pair interactions must vanish beyond `cutoff`, which is checked when the move is set up.
+ * The accepted local moves are reported as a single change that is always accepted.
+ */
+class CheckerboardSweep : public Movebase {
+  private:
+    /**
+     * @brief Domain with the atoms or molecules to move
+     *
+     * Atoms are stored as (group index, index relative to group) and molecules as (group index, -1)
+     */
+    struct Domain {
+        Eigen::Vector3i coordinates;               //!< Position in the grid of domains
+        std::vector<std::pair<int, int>> entities; //!< Atoms or molecules entirely inside the domain
+        std::vector<std::pair<int, int>> moved;    //!< Entities moved by accepted local moves
+        int accepted = 0;                          //!< Number of accepted local moves in latest sweep
+        double square_displacement = 0.0;          //!< Sum of squared displacements in latest sweep
+        int worker = 0;                            //!< Worker that swept the domain in latest sweep
+    };
+
+    /**
+     * @brief Data used by a single thread
+     */
+    struct Worker {
+        std::shared_ptr<Space> space;                     //!< Replica of the shared Space
+        std::unique_ptr<Energy::Hamiltonian> hamiltonian; //!< Hamiltonian operating on the replica
+        Change change;                                    //!< Change of a single local move
+        ParticleVector backup;                            //!< Particles before a local move
+    };
+
+    Space &spc;
+    const Energy::Hamiltonian &hamiltonian;           //!< Hamiltonian of the shared Space
+    json energy_input;                                //!< Input for the Hamiltonians of the workers
+    std::vector<Worker> workers;                      //!< One worker per thread
+    std::vector<Domain> domains;                      //!< All domains in row-major order
+    std::vector<int> same_color;                      //!< Index of domains with the same color
+    std::vector<std::pair<int, int>> moved;           //!< Entities moved in all domains
+    std::string molecule_name;                        //!< Name of molecule to move
+    int molid = -1;                                   //!< Molecule id to move
+    bool atomic = true;                               //!< Move single atoms of an atomic molecule
+    double cutoff = 0.0;                              //!< Range of all interactions
+    double dptrans = 0.0;                             //!< Maximum displacement
+    double dprot = 0.0;                               //!< Maximum rotation angle
+    Point directions = {1, 1, 1};                     //!< Displacement directions
+    Point box_length = {0, 0, 0};                     //!< Box side lengths in latest sweep
+    Point domain_length = {0, 0, 0};                  //!< Domain side lengths in latest sweep
+    Point offset = {0, 0, 0};                         //!< Random offset of the grid in latest sweep
+    Eigen::Vector3i number_of_domains = {0, 0, 0};    //!< Number of domains along each axis in latest sweep
+    unsigned long local_attempts = 0;                 //!< Number of local moves
+    unsigned long local_accepted = 0;                 //!< Number of accepted local moves
+    Average<double> mean_square_displacement;         //!< Mean squared displacement of accepted local moves
+    const double force_accept = -1e12;                //!< Very negative energy change to force-accept the sweep
+
+    Eigen::Vector3i domainOf(const Point &position) const; //!< Domain coordinates of a position
+    int index(const Eigen::Vector3i &domain) const;        //!< Row-major domain index
+    void addWorkers();                                     //!< Ensure a worker for every thread
+    void setupDomains();                                   //!< Draw offset and assign entities to domains
+    void sweepDomain(Domain &, unsigned int seed, Worker &); //!< Local moves within a domain
+    void publishColor();                                   //!< Copy moves of latest color to Space and replicas
+    bool moveAtom(const Eigen::Vector3i &domain, int group_index, int atom_index, Random &, Worker &,
+                  double &square_displacement); //!< True if accepted
+    bool moveMolecule(const Eigen::Vector3i &domain, int group_index, Random &, Worker &,
+                      double &square_displacement); //!< True if accepted
+    static void copySpace(const Space &source, Space &target); //!< Copy particles, groups and geometry
+    static void copyEntity(const Space &source, Space &target,
+                           const std::pair<int, int> &entity); //!< Copy a single atom or molecule
+    void _move(Change &) override;
+    void _to_json(json &) const override;
+    void _from_json(const json &) override;
+
+  public:
+    CheckerboardSweep(Space &, const Energy::Hamiltonian &, const json &energy);
+    ~CheckerboardSweep() override;
+    double bias(Change &, double, double) override; //!< Forces acceptance of the whole sweep
+};
+
+} // namespace Move
+} // namespace Faunus
@@ -2,6 +2,9 @@
 #include "penalty.h"
 #include "potentials.h"
 #include "externalpotential.h"
+#ifdef _OPENMP
+#include <omp.h>
+#endif
 
 #define ANKERL_NANOBENCH_IMPLEMENT
 #include <nanobench.h>
@@ -83,10 +86,14 @@ std::shared_ptr<EwaldPolicyBase> EwaldPolicyBase::makePolicy(EwaldData::Policies
         return std::make_shared<PolicyIonIon>();
     case EwaldData::PBCEigen:
         return std::make_shared<PolicyIonIonEigen>();
+    case EwaldData::PBCRecurrence:
+        return std::make_shared<PolicyIonIonRecurrence>();
     case EwaldData::IPBC:
         return std::make_shared<PolicyIonIonIPBC>();
     case EwaldData::IPBCEigen:
         return std::make_shared<PolicyIonIonIPBCEigen>();
+    case EwaldData::SPME:
+        throw std::runtime_error("SPME is handled by ParticleMeshEwald, not by an Ewald policy");
     case EwaldData::INVALID:
         throw std::runtime_error("invalid Ewald policy");
     }
@@ -100,7 +107,7 @@ PolicyIonIonIPBC::PolicyIonIonIPBC() { cite = "doi:10/css8"; }
  * Resize k-vectors according to current variables and box length
  */
 void PolicyIonIon::updateBox(EwaldData &d, const Point &box) const {
-    assert(d.policy == EwaldData::PBC or d.policy == EwaldData::PBCEigen);
+    assert(d.policy == EwaldData::PBC or d.policy == EwaldData::PBCEigen or d.policy == EwaldData::PBCRecurrence);
     d.box_length = box;
     int n_cutoff_ceil = ceil(d.n_cutoff);
     d.check_k2_zero = 0.1 * std::pow(2 * pc::pi / d.box_length.maxCoeff(), 2);
@@ -151,53 +158,286 @@ void PolicyIonIon::updateBox(EwaldData &d, const Point &box) const {
 }
 
 /**
- * @todo Add OpenMP pragma to first loop
+ * @brief Calls `visit(particle, sign)` for the changed particles after (+1) and before (-1) a move
+ *
+ * Only particles active in the respective state are visited and groups without atom indices, or with all
+ * particles changed, are visited as a whole. The state before the move is held by `old_groups` of another
+ * Space or, if trial and accepted state share `spc`, by its journal.
+ *
+ * @param committed_particles Buffer for the journal records, see `SpaceJournal::committedParticles()`
  */
-void PolicyIonIon::updateComplex(EwaldData &data, Space::Tgvec &groups) const {
-    for (int k = 0; k < data.k_vectors.cols(); k++) {
-        const Point &q = data.k_vectors.col(k);
-        EwaldData::Tcomplex Q(0, 0);
-        for (auto &g : groups) {       // loop over molecules
-            for (auto &particle : g) { // loop over active particles
-                double qr = q.dot(particle.pos);
-                Q += particle.charge * EwaldData::Tcomplex(std::cos(qr),
-                                                           std::sin(qr)); // 'Q^q', see eq. 25 in ref.
+template <typename TVisitor>
+static void visitChangedParticles(const Change &change, const Space &spc, const Space::Tgvec &old_groups,
+                                  std::vector<std::pair<size_t, const Particle *>> &committed_particles,
+                                  TVisitor visit) {
+    const bool use_journal = &old_groups == &spc.groups;
+    assert(!use_journal || spc.journal.enabled());
+    if (use_journal) {
+        spc.journal.committedParticles(committed_particles);
+    }
+    auto committed_particle = [&](size_t index) -> const Particle & { // unrecorded particles are unmodified
+        auto record = std::lower_bound(committed_particles.begin(), committed_particles.end(), index,
+                                       [](const auto &record, size_t index) { return record.first < index; });
+        return (record != committed_particles.end() && record->first == index) ? *record->second : spc.p[index];
+    };
+    for (const auto &changed_group : change.groups) {
+        const auto &group = spc.groups.at(changed_group.index);
+        const int size = group.size();
+        const Space::Tgroup *old_group = use_journal ? nullptr : &old_groups.at(changed_group.index);
+        const auto offset = group.begin() - spc.p.begin();
+        int old_size = size;
+        if (old_group) {
+            old_size = old_group->size();
+        } else if (const auto *recorded_group = spc.journal.committedGroupData(changed_group.index)) {
+            old_size = recorded_group->size();
+        }
+        auto old_particle = [&](int i) -> const Particle & {
+            return old_group ? (*old_group)[i] : committed_particle(offset + i);
+        };
+        auto visit_atom = [&](int i) {
+            if (i < size) {
+                visit(group[i], 1.0);
+            }
+            if (i < old_size) {
+                visit(old_particle(i), -1.0);
             }
-            data.Q_ion[k] = Q;
+        };
+        if (changed_group.all or changed_group.atoms.empty()) { // e.g. rigid body moves
+            for (int i = 0; i < std::max(size, old_size); i++) {
+                visit_atom(i);
+            }
+        } else {
+            std::for_each(changed_group.atoms.begin(), changed_group.atoms.end(), visit_atom);
         }
     }
 }
 
-void PolicyIonIonEigen::updateComplex(EwaldData &data, Space::Tgvec &groups) const {
-    auto [pos, charge] = mapGroupsToEigen(groups);                             // throws if inactive particles
-    Eigen::MatrixXd kr = pos.matrix() * data.k_vectors;                        // ( N x 3 ) * ( 3 x K ) = N x K
-    data.Q_ion.real() = (kr.array().cos().colwise() * charge).colwise().sum(); // real part of 'Q^q', see eq. 25 in ref.
-    data.Q_ion.imag() = kr.array().sin().colwise().sum(); // imaginary part of 'Q^q', see eq. 25 in ref.
-}
+/**
+ * @brief Charges and positions gathered into contiguous storage for blocked loops over k-vectors
+ *
+ * Old positions of changed particles are added with negated charge such that
+ * a partial update of 'Q^q' is a single sum over all sources.
+ */
+struct EwaldSources {
+    std::vector<Point> positions;
+    std::vector<double> charges;
 
-void PolicyIonIon::updateComplex(EwaldData &d, Change &change, Space::Tgvec &groups, Space::Tgvec &oldgroups) const {
-    assert(groups.size() == oldgroups.size());
-    for (int k = 0; k < d.k_vectors.cols(); k++) {
-        auto &Q = d.Q_ion[k];
-        const Point &q = d.k_vectors.col(k);
+    void add(const Space::Tparticle &particle, double sign = 1.0) {
+        positions.push_back(particle.pos);
+        charges.push_back(sign * particle.charge);
+    }
+
+    int size() const { return static_cast<int>(charges.size()); }
+
+    EwaldSources() = default;
 
+    explicit EwaldSources(Space::Tgvec &groups) {
+        for (auto &group : groups) {
+            for (auto &particle : group) { // active particles only
+                add(particle);
+            }
+        }
+    } //!< all active particles
+
+    EwaldSources(Change &change, Space::Tgvec &groups, Space::Tgvec &oldgroups) {
         for (auto &changed_group : change.groups) {
             auto &g_new = groups.at(changed_group.index);
             auto &g_old = oldgroups.at(changed_group.index);
+            if (changed_group.all && changed_group.atoms.empty()) { // e.g. rigid body moves
+                for (auto &particle : g_new) {
+                    add(particle);
+                }
+                for (auto &particle : g_old) {
+                    add(particle, -1.0);
+                }
+                continue;
+            }
             for (auto i : changed_group.atoms) {
-                if (i < g_new.size()) {
-                    double qr = q.dot(g_new[i].pos);
-                    Q += g_new[i].charge * EwaldData::Tcomplex(std::cos(qr), std::sin(qr));
+                if (i < g_new.size())
+                    add(g_new[i]);
+                if (i < g_old.size())
+                    add(g_old[i], -1.0);
+            }
+        }
+    } //!< new (positive) and old (negative) changed particles
+
+    auto positionMatrix() const {
+        return Eigen::Map<const Eigen::Matrix3Xd>(positions.front().data(), 3, size()).transpose();
+    } //!< N x 3 view of the positions; requires at least one source
+
+    auto chargeVector() const {
+        return Eigen::Map<const Eigen::VectorXd>(charges.data(), size());
+    } //!< N x 1 view of the charges
+};
+
+/**
+ * @brief Add `sum_i q_i * phase(k, r_i)` to `Q_ion` for all k-vectors
+ *
+ * k-vectors are distributed over threads in blocks while particles are
+ * visited in tiles so that a tile of positions stays in cache for all
+ * k-vectors in a block. Each k-vector is owned by a single thread, hence
+ * no synchronization is needed.
+ */
+template <typename Tphase> static void addStructureFactors(EwaldData &d, const EwaldSources &sources, Tphase phase) {
+    constexpr int k_block_size = 64;          // k-vectors per work item
+    constexpr int particle_block_size = 256;  // particles per cache tile
+    constexpr int min_parallel_work = 4096;   // smaller problems are not worth waking threads
+    const int num_kvectors = d.k_vectors.cols();
+    const int num_particles = sources.size();
+#pragma omp parallel for schedule(static) if (num_kvectors * num_particles > min_parallel_work)
+    for (int first_k = 0; first_k < num_kvectors; first_k += k_block_size) {
+        const int last_k = std::min(first_k + k_block_size, num_kvectors);
+        for (int first_i = 0; first_i < num_particles; first_i += particle_block_size) {
+            const int last_i = std::min(first_i + particle_block_size, num_particles);
+            for (int k = first_k; k < last_k; k++) {
+                const Point q = d.k_vectors.col(k);
+                EwaldData::Tcomplex Q(0, 0);
+                for (int i = first_i; i < last_i; i++) {
+                    Q += sources.charges[i] * phase(q, sources.positions[i]);
+                }
+                d.Q_ion[k] += Q;
+            }
+        }
+    }
+}
+
+void PolicyIonIon::updateComplex(EwaldData &data, Space::Tgvec &groups) const {
+    data.Q_ion.setZero();
+    addStructureFactors(data, EwaldSources(groups), [](const Point &q, const Point &pos) {
+        const double qr = q.dot(pos);
+        return EwaldData::Tcomplex(std::cos(qr), std::sin(qr)); // 'Q^q', see eq. 25 in ref.
+    });
+}
+
+/**
+ * @brief Add `sum_i q_i * exp(i k·r_i)` to `Q_ion` for all k-vectors using Eigen array operations
+ * @param positions  N x 3 matrix of positions
+ * @param charges  N x 1 vector of charges; zero for particles that shall not contribute
+ */
+template <typename TPositions, typename TCharges>
+static void addStructureFactorsEigen(EwaldData &d, const TPositions &positions, const TCharges &charges) {
+    const Eigen::MatrixXd kr = positions * d.k_vectors; // ( N x 3 ) * ( 3 x K ) = N x K
+    d.Q_ion.real() += (kr.array().cos().colwise() * charges.array()).colwise().sum().matrix().transpose();
+    d.Q_ion.imag() += (kr.array().sin().colwise() * charges.array()).colwise().sum().matrix().transpose();
+}
+
+void PolicyIonIonEigen::updateComplex(EwaldData &data, Space::Tgvec &groups) const {
+    auto [pos, charge] = mapGroupsToEigen(groups); // inactive particles have zero charge
+    data.Q_ion.setZero();
+    addStructureFactorsEigen(data, pos.matrix(), charge); // see eq. 25 in ref.
+}
+
+void PolicyIonIonEigen::updateComplex(EwaldData &d, Change &change, Space::Tgvec &groups,
+                                      Space::Tgvec &oldgroups) const {
+    assert(groups.size() == oldgroups.size());
+    addSources(d, EwaldSources(change, groups, oldgroups));
+}
+
+void PolicyIonIonEigen::addSources(EwaldData &d, const EwaldSources &sources) const {
+    if (sources.size() > 0) {
+        addStructureFactorsEigen(d, sources.positionMatrix(), sources.chargeVector());
+    }
+}
+
+void PolicyIonIon::updateComplex(EwaldData &d, Change &change, Space::Tgvec &groups, Space::Tgvec &oldgroups) const {
+    assert(groups.size() == oldgroups.size());
+    addSources(d, EwaldSources(change, groups, oldgroups));
+}
+
+void PolicyIonIon::addSources(EwaldData &d, const EwaldSources &sources) const {
+    addStructureFactors(d, sources, [](const Point &q, const Point &pos) {
+        const double qr = q.dot(pos);
+        return EwaldData::Tcomplex(std::cos(qr), std::sin(qr));
+    });
+}
+
+/**
+ * @brief Add `sum_i q_i * exp(i k·r_i)` to `Q_ion` for all k-vectors using trigonometric recurrences
+ *
+ * For a tile of particles, `exp(i 2π n r_a / L_a)` is tabulated along each axis `a` for all integers
+ * `|n| <= n_max` by repeated complex multiplication, hence only a single `sin`/`cos` pair is evaluated per
+ * particle and axis. As `nz` runs fastest in the k-vector ordering (see `PolicyIonIon::updateBox()`), the
+ * charge weighted product of the x and y factors is formed once per (nx, ny) and reused for all nz. Real and
+ * imaginary parts are kept in separate arrays over the particles such that the innermost loops vectorize.
+ */
+static void addStructureFactorsByRecurrence(EwaldData &d, const EwaldSources &sources) {
+    constexpr int particle_block_size = 256; // particles per tile
+    constexpr int min_parallel_work = 4096;  // smaller problems are not worth waking threads
+    const int num_kvectors = d.k_vectors.cols();
+    const int num_particles = sources.size();
+    const Eigen::Matrix3Xi n = (d.k_vectors.array().colwise() * (d.box_length / (2.0 * pc::pi)).array())
+                                   .round()
+                                   .cast<int>(); // integer k-vector components, n = k L / 2π
+    const int n_max = num_kvectors > 0 ? n.cwiseAbs().maxCoeff() : 0;
+    const int rows = 2 * n_max + 1;         // table rows for n in [-n_max, n_max]
+    std::vector<double> table_re, table_im; // (axis, n, particle in tile) in row-major order
+
+    for (int first_i = 0; first_i < num_particles; first_i += particle_block_size) {
+        const int tile = std::min(particle_block_size, num_particles - first_i);
+        auto row = [&](int axis, int n) { return (axis * rows + n + n_max) * tile; }; // offset of a table row
+        table_re.resize(3 * rows * tile);
+        table_im.resize(3 * rows * tile);
+        for (int i = 0; i < tile; i++) {
+            const Point &position = sources.positions[first_i + i];
+            for (int axis = 0; axis < 3; axis++) {
+                const double theta = 2.0 * pc::pi * position[axis] / d.box_length[axis];
+                const EwaldData::Tcomplex step(std::cos(theta), std::sin(theta));
+                EwaldData::Tcomplex power(1.0, 0.0);
+                for (int m = 0; m <= n_max; m++) {
+                    table_re[row(axis, m) + i] = table_re[row(axis, -m) + i] = power.real();
+                    table_im[row(axis, m) + i] = power.imag();
+                    table_im[row(axis, -m) + i] = -power.imag(); // exp(-iθ) = conj(exp(iθ))
+                    power *= step;
+                }
+            }
+        }
+#pragma omp parallel if (num_kvectors * tile > min_parallel_work)
+        {
+            std::vector<double> xy_re(tile), xy_im(tile); // charge times the x and y factors
+            int nx = 0, ny = 0;
+            bool xy_is_valid = false;
+#pragma omp for schedule(static)
+            for (int k = 0; k < num_kvectors; k++) {
+                if (!xy_is_valid || n(0, k) != nx || n(1, k) != ny) {
+                    nx = n(0, k);
+                    ny = n(1, k);
+                    xy_is_valid = true;
+                    const double *x_re = &table_re[row(0, nx)], *x_im = &table_im[row(0, nx)];
+                    const double *y_re = &table_re[row(1, ny)], *y_im = &table_im[row(1, ny)];
+                    const double *charges = &sources.charges[first_i];
+                    for (int i = 0; i < tile; i++) {
+                        xy_re[i] = charges[i] * (x_re[i] * y_re[i] - x_im[i] * y_im[i]);
+                        xy_im[i] = charges[i] * (x_re[i] * y_im[i] + x_im[i] * y_re[i]);
+                    }
                 }
-                if (i < g_old.size()) {
-                    double qr = q.dot(g_old[i].pos);
-                    Q -= g_old[i].charge * EwaldData::Tcomplex(std::cos(qr), std::sin(qr));
+                const double *z_re = &table_re[row(2, n(2, k))], *z_im = &table_im[row(2, n(2, k))];
+                double sum_re = 0.0, sum_im = 0.0;
+#pragma omp simd reduction(+ : sum_re, sum_im)
+                for (int i = 0; i < tile; i++) {
+                    sum_re += xy_re[i] * z_re[i] - xy_im[i] * z_im[i];
+                    sum_im += xy_re[i] * z_im[i] + xy_im[i] * z_re[i];
                 }
+                d.Q_ion[k] += EwaldData::Tcomplex(sum_re, sum_im);
             }
         }
     }
 }
 
+void PolicyIonIonRecurrence::updateComplex(EwaldData &data, Space::Tgvec &groups) const {
+    data.Q_ion.setZero();
+    addStructureFactorsByRecurrence(data, EwaldSources(groups));
+}
+
+void PolicyIonIonRecurrence::updateComplex(EwaldData &d, Change &change, Space::Tgvec &groups,
+                                           Space::Tgvec &oldgroups) const {
+    assert(groups.size() == oldgroups.size());
+    addSources(d, EwaldSources(change, groups, oldgroups));
+}
+
+void PolicyIonIonRecurrence::addSources(EwaldData &d, const EwaldSources &sources) const {
+    addStructureFactorsByRecurrence(d, sources);
+}
+
 TEST_CASE("[Faunus] Ewald - IonIonPolicy") {
     using doctest::Approx;
     Space spc;
@@ -233,6 +473,46 @@ TEST_CASE("[Faunus] Ewald - IonIonPolicy") {
         CHECK(ionion.reciprocalEnergy(data) == Approx(0.21303063979675319 * data.bjerrum_length));
     }
 
+    SUBCASE("PBCRecurrence") {
+        PolicyIonIonRecurrence ionion;
+        ionion.updateBox(data, spc.geo.getLength());
+        ionion.updateComplex(data, spc.groups);
+        CHECK(ionion.selfEnergy(data, c, spc.groups) == Approx(-1.0092530088080642 * data.bjerrum_length));
+        CHECK(ionion.surfaceEnergy(data, c, spc.groups) == Approx(0.0020943951023931952 * data.bjerrum_length));
+        CHECK(ionion.reciprocalEnergy(data) == Approx(0.21303063979675319 * data.bjerrum_length));
+
+        // partial update of a displaced particle compared with a full update
+        ParticleVector old_particles = spc.p;
+        Space::Tgvec old_groups = {Group<Particle>(old_particles.begin(), old_particles.end())};
+        spc.p[1].pos = {-1.3, 2.2, 4.1};
+        Change displacement;
+        displacement.groups.resize(1);
+        displacement.groups[0].index = 0;
+        displacement.groups[0].atoms = {1};
+        ionion.updateComplex(data, displacement, spc.groups, old_groups);
+        EwaldData full_data = data;
+        PolicyIonIon().updateComplex(full_data, spc.groups);
+        CHECK((data.Q_ion - full_data.Q_ion).cwiseAbs().maxCoeff() < 1e-10);
+        CHECK(ionion.reciprocalEnergy(data) == Approx(ionion.reciprocalEnergy(full_data)));
+    }
+
+#ifdef _OPENMP
+    SUBCASE("PBC independence of number of threads") {
+        data.n_cutoff = 16.0; // enough k-vectors to run in parallel
+        PolicyIonIon ionion;
+        ionion.updateBox(data, spc.geo.getLength());
+        ionion.updateComplex(data, spc.groups);
+        REQUIRE(data.Q_ion.size() > 4096);
+        const int max_threads = omp_get_max_threads();
+        omp_set_num_threads(1);
+        const double single_thread_energy = ionion.reciprocalEnergy(data);
+        omp_set_num_threads(3);
+        const double multi_thread_energy = ionion.reciprocalEnergy(data);
+        omp_set_num_threads(max_threads);
+        CHECK(single_thread_energy == multi_thread_energy);
+    }
+#endif
+
     SUBCASE("IPBC") {
         PolicyIonIonIPBC ionion;
         data.policy = EwaldData::IPBC;
@@ -243,16 +523,39 @@ TEST_CASE("[Faunus] Ewald - IonIonPolicy") {
         CHECK(ionion.reciprocalEnergy(data) == Approx(0.0865107467 * data.bjerrum_length));
     }
 
-    // IPBCEigen is under construction
-    /*SUBCASE("IPBCEigen") {
-        PolicyIonIonIPBCEigen ionion();
-        data.type = EwaldData::IPBCEigen;
+    SUBCASE("IPBCEigen") {
+        PolicyIonIonIPBCEigen ionion;
+        data.policy = EwaldData::IPBCEigen;
+        ionion.updateBox(data, spc.geo.getLength());
+        ionion.updateComplex(data, spc.groups);
+        CHECK(ionion.selfEnergy(data, c, spc.groups) == Approx(-1.0092530088080642 * data.bjerrum_length));
+        CHECK(ionion.surfaceEnergy(data, c, spc.groups) == Approx(0.0020943951023931952 * data.bjerrum_length));
+        CHECK(ionion.reciprocalEnergy(data) == Approx(0.0865107467 * data.bjerrum_length));
+    }
+
+    SUBCASE("PBCEigen with inactive particles") {
+        spc.p.push_back(R"( {"pos": [2,3,1], "q": 2.0} )"_json); // inactive particle
+        spc.groups.front() = Group<Particle>(spc.p.begin(), spc.p.end());
+        spc.groups.front().deactivate(spc.p.end() - 1, spc.p.end());
+        PolicyIonIonEigen ionion;
         ionion.updateBox(data, spc.geo.getLength());
         ionion.updateComplex(data, spc.groups);
-        CHECK(ionion.selfEnergy(data, c, spc.groups) == Approx(-1.0092530088080642 * data.lB));
-        CHECK(ionion.surfaceEnergy(data, c, spc.groups) == Approx(0.0020943951023931952 * data.lB));
-        CHECK(ionion.reciprocalEnergy(data) == Approx(0.0865107467 * data.lB));
-    }*/
+        CHECK(ionion.reciprocalEnergy(data) == Approx(0.21303063979675319 * data.bjerrum_length));
+
+        // partial update of a displaced particle compared with a full update
+        ParticleVector old_particles = spc.p;
+        Space::Tgvec old_groups = {Group<Particle>(old_particles.begin(), old_particles.end())};
+        old_groups.front().deactivate(old_particles.end() - 1, old_particles.end());
+        spc.p[1].pos = {-1.3, 2.2, 4.1};
+        Change displacement;
+        displacement.groups.resize(1);
+        displacement.groups[0].index = 0;
+        displacement.groups[0].atoms = {1};
+        ionion.updateComplex(data, displacement, spc.groups, old_groups);
+        EwaldData full_data = data;
+        PolicyIonIon().updateComplex(full_data, spc.groups);
+        CHECK((data.Q_ion - full_data.Q_ion).cwiseAbs().maxCoeff() < 1e-10);
+    }
 }
 
 TEST_CASE("[Faunus] Ewald - IonIonPolicy Benchmarks") {
@@ -276,13 +579,16 @@ TEST_CASE("[Faunus] Ewald - IonIonPolicy Benchmarks") {
     {
         PolicyIonIon pbc;
         PolicyIonIonEigen pbc_eigen;
+        PolicyIonIonRecurrence pbc_recurrence;
         pbc.updateBox(data, spc.geo.getLength());
         pbc_eigen.updateBox(data, spc.geo.getLength());
+        pbc_recurrence.updateBox(data, spc.geo.getLength());
 
         ankerl::nanobench::Config bench;
         bench.minEpochIterations(20);
         bench.run("PBC", [&] { pbc.updateComplex(data, spc.groups); }).doNotOptimizeAway();
         bench.run("PBCEigen", [&] { pbc_eigen.updateComplex(data, spc.groups); }).doNotOptimizeAway();
+        bench.run("PBCRecurrence", [&] { pbc_recurrence.updateComplex(data, spc.groups); }).doNotOptimizeAway();
     }
 }
 
@@ -347,45 +653,60 @@ void PolicyIonIonIPBC::updateBox(EwaldData &data, const Point &box) const {
 
 void PolicyIonIonIPBC::updateComplex(EwaldData &d, Space::Tgvec &groups) const {
     assert(d.policy == EwaldData::IPBC or d.policy == EwaldData::IPBCEigen);
-    for (int k = 0; k < d.k_vectors.cols(); k++) {
-        const Point &q = d.k_vectors.col(k);
-        EwaldData::Tcomplex Q(0, 0);
-        for (auto &g : groups) {
-            for (auto &particle : g) {
-                Q += q.cwiseProduct(particle.pos).array().cos().prod() * particle.charge; // see eq. 2 in doi:10/css8
-            }
-        }
-        d.Q_ion[k] = Q;
+    d.Q_ion.setZero();
+    addStructureFactors(d, EwaldSources(groups), [](const Point &q, const Point &pos) {
+        return EwaldData::Tcomplex(q.cwiseProduct(pos).array().cos().prod(), 0); // see eq. 2 in doi:10/css8
+    });
+}
+
+/**
+ * @brief Add `sum_i q_i * prod_a cos(k_a r_ia)` to the real part of `Q_ion` using Eigen array operations
+ * @param positions  N x 3 matrix of positions
+ * @param charges  N x 1 vector of charges; zero for particles that shall not contribute
+ */
+template <typename TPositions, typename TCharges>
+static void addIPBCStructureFactorsEigen(EwaldData &d, const TPositions &positions, const TCharges &charges) {
+    Eigen::ArrayXXd cos_product = (positions.col(0) * d.k_vectors.row(0)).eval().array().cos(); // N x K
+    for (int axis = 1; axis < 3; axis++) {
+        cos_product *= (positions.col(axis) * d.k_vectors.row(axis)).eval().array().cos();
     }
+    // see eq. 2 in doi:10/css8
+    d.Q_ion.real() += (cos_product.colwise() * charges.array()).colwise().sum().matrix().transpose();
 }
 
 void PolicyIonIonIPBCEigen::updateComplex(EwaldData &d, Space::Tgvec &groups) const {
     assert(d.policy == EwaldData::IPBC or d.policy == EwaldData::IPBCEigen);
-    auto [pos, charge] = mapGroupsToEigen(groups); // throws if inactive particles
-    d.Q_ion.real() = (d.k_vectors.array().cwiseProduct(pos).array().cos().prod() * charge)
-                         .colwise()
-                         .sum(); // see eq. 2 in doi:10/css8
+    auto [pos, charge] = mapGroupsToEigen(groups); // inactive particles have zero charge
+    d.Q_ion.setZero();
+    addIPBCStructureFactorsEigen(d, pos.matrix(), charge);
+}
+
+void PolicyIonIonIPBCEigen::updateComplex(EwaldData &d, Change &change, Space::Tgvec &groups,
+                                          Space::Tgvec &oldgroups) const {
+    assert(d.policy == EwaldData::IPBC or d.policy == EwaldData::IPBCEigen);
+    assert(groups.size() == oldgroups.size());
+    addSources(d, EwaldSources(change, groups, oldgroups));
+}
+
+void PolicyIonIonIPBCEigen::addSources(EwaldData &d, const EwaldSources &sources) const {
+    assert(d.policy == EwaldData::IPBC or d.policy == EwaldData::IPBCEigen);
+    if (sources.size() > 0) {
+        addIPBCStructureFactorsEigen(d, sources.positionMatrix(), sources.chargeVector());
+    }
 }
 
 void PolicyIonIonIPBC::updateComplex(EwaldData &d, Change &change, Space::Tgvec &groups,
                                      Space::Tgvec &oldgroups) const {
     assert(d.policy == EwaldData::IPBC or d.policy == EwaldData::IPBCEigen);
     assert(groups.size() == oldgroups.size());
+    addSources(d, EwaldSources(change, groups, oldgroups));
+}
 
-    for (int k = 0; k < d.k_vectors.cols(); k++) {
-        auto &Q = d.Q_ion[k];
-        const Point &q = d.k_vectors.col(k);
-        for (auto &changed_group : change.groups) {
-            auto &g_new = groups.at(changed_group.index);
-            auto &g_old = oldgroups.at(changed_group.index);
-            for (auto i : changed_group.atoms) {
-                if (i < g_new.size())
-                    Q += q.cwiseProduct(g_new[i].pos).array().cos().prod() * g_new[i].charge;
-                if (i < g_old.size())
-                    Q -= q.cwiseProduct(g_old[i].pos).array().cos().prod() * g_old[i].charge;
-            }
-        }
-    }
+void PolicyIonIonIPBC::addSources(EwaldData &d, const EwaldSources &sources) const {
+    assert(d.policy == EwaldData::IPBC or d.policy == EwaldData::IPBCEigen);
+    addStructureFactors(d, sources, [](const Point &q, const Point &pos) {
+        return EwaldData::Tcomplex(q.cwiseProduct(pos).array().cos().prod(), 0);
+    });
 }
 
 double PolicyIonIon::surfaceEnergy(const EwaldData &d, Change &change, Space::Tgvec &groups) {
@@ -444,12 +765,23 @@ double PolicyIonIon::selfEnergy(const EwaldData &d, Change &change, Space::Tgvec
 /**
  * Updates the reciprocal space terms 'Q^q' and 'A_k'.
  * See eqs. 24 and 25 in ref. for PBC Ewald, and eq. 2 in doi:10/css8 for IPBC Ewald.
+ *
+ * The k-vectors are summed in chunks of fixed size and the chunk sums are added in order,
+ * hence the energy does not depend on the number of threads.
  */
 double PolicyIonIon::reciprocalEnergy(const EwaldData &d) {
-    double energy = 0;
-    for (int k = 0; k < d.Q_ion.size(); k++) {
-        energy += d.Aks[k] * std::norm(d.Q_ion[k]);
+    constexpr int chunk_size = 1024; // k-vectors per partial sum
+    const int num_kvectors = d.Q_ion.size();
+    const int num_chunks = (num_kvectors + chunk_size - 1) / chunk_size;
+    std::vector<double> partial_energies(num_chunks, 0.0);
+#pragma omp parallel for schedule(static) if (num_kvectors > 4096)
+    for (int chunk = 0; chunk < num_chunks; chunk++) {
+        const int last_k = std::min(num_kvectors, (chunk + 1) * chunk_size);
+        for (int k = chunk * chunk_size; k < last_k; k++) {
+            partial_energies[chunk] += d.Aks[k] * std::norm(d.Q_ion[k]);
+        }
     }
+    const double energy = std::accumulate(partial_energies.begin(), partial_energies.end(), 0.0);
     return 2 * pc::pi * energy * d.bjerrum_length / d.box_length.prod();
 }
 
@@ -478,11 +810,14 @@ double Ewald::energy(Change &change) {
             if (change.all or change.dV) { // everything changes
                 policy->updateBox(data, spc.geo.getLength());
                 policy->updateComplex(data, spc.groups); // update all (expensive!)
-            } else { // much cheaper partial update
-              if (change.groups.size() > 0) {
-                assert(old_groups != nullptr);
-                policy->updateComplex(data, change, spc.groups, *old_groups);
-              }
+            } else if (old_groups == &spc.groups && !spc.journal.enabled()) { // previous positions are unavailable
+                policy->updateComplex(data, spc.groups);
+            } else if (change.groups.size() > 0) { // much cheaper partial update
+                assert(old_groups != nullptr);     // previous positions are in the old Space or the journal
+                EwaldSources sources;
+                visitChangedParticles(change, spc, *old_groups, committed_particles,
+                                      [&](const Particle &particle, double sign) { sources.add(particle, sign); });
+                policy->addSources(data, sources);
             }
         }
         // the selfEnergy() is omitted as this is added as a separate term in `Hamiltonian`
@@ -554,102 +889,551 @@ void Ewald::sync(Energybase *energybase_pointer, Change &change) {
 
 void Ewald::to_json(json &j) const { j = data; }
 
-double Example2D::energy(Change &) {
-    double s =
-        1 + std::sin(2.0 * pc::pi * particle.x()) + std::cos(2.0 * pc::pi * particle.y()) * static_cast<double>(use_2d);
-    s *= scale_energy;
-    if (particle.x() >= -2.00 && particle.x() <= -1.25)
-        return 1 * s;
-    if (particle.x() >= -1.25 && particle.x() <= -0.25)
-        return 2 * s;
-    if (particle.x() >= -0.25 && particle.x() <= 0.75)
-        return 3 * s;
-    if (particle.x() >= 0.75 && particle.x() <= 1.75)
-        return 4 * s;
-    if (particle.x() >= 1.75 && particle.x() <= 2.00)
-        return 5 * s;
-    return 1e10;
-}
+//----------------- Particle-mesh Ewald -------------------
 
-Example2D::Example2D(const json &j, Space &spc) : particle(spc.p.at(0).pos) {
-    scale_energy = j.value("scale", 1.0);
-    use_2d = j.value("2D", true);
-    name = "Example2D";
-}
-void Example2D::to_json(json &j) const {
-    j["scale"] = scale_energy;
-    j["2D"] = use_2d;
+/**
+ * @brief In-place, unnormalized discrete Fourier transform of a row-major 3D mesh
+ * @param mesh Complex mesh values
+ * @param size Number of mesh points in each dimension; must be powers of two
+ * @param sign Sign of the exponent, i.e. -1 for the forward and +1 for the inverse transform
+ *
+ * Radix-2 Cooley-Tukey transform applied along each dimension in turn.
+ */
+static void fourierTransform(std::vector<std::complex<double>> &mesh, const Eigen::Vector3i &size, int sign) {
+    std::vector<std::complex<double>> line;
+    for (int dim = 0; dim < 3; dim++) {
+        const int n = size[dim];
+        const int stride = (dim == 0) ? size[1] * size[2] : (dim == 1 ? size[2] : 1);
+        line.resize(n);
+        for (size_t offset = 0; offset < mesh.size(); offset++) {
+            if ((offset / stride) % n != 0) {
+                continue; // not the first point of a line along `dim`
+            }
+            for (int i = 0; i < n; i++) {
+                line[i] = mesh[offset + i * stride];
+            }
+            for (int i = 1, j = 0; i < n; i++) { // bit-reversal permutation
+                int bit = n >> 1;
+                for (; j & bit; bit >>= 1) {
+                    j ^= bit;
+                }
+                j ^= bit;
+                if (i < j) {
+                    std::swap(line[i], line[j]);
+                }
+            }
+            for (int length = 2; length <= n; length <<= 1) { // butterflies
+                const double angle = sign * 2.0 * pc::pi / length;
+                const std::complex<double> root(std::cos(angle), std::sin(angle));
+                for (int first = 0; first < n; first += length) {
+                    std::complex<double> twiddle(1.0, 0.0);
+                    for (int i = 0; i < length / 2; i++) {
+                        const auto even = line[first + i];
+                        const auto odd = line[first + i + length / 2] * twiddle;
+                        line[first + i] = even + odd;
+                        line[first + i + length / 2] = even - odd;
+                        twiddle *= root;
+                    }
+                }
+            }
+            for (int i = 0; i < n; i++) {
+                mesh[offset + i * stride] = line[i];
+            }
+        }
+    }
 }
 
-double ContainerOverlap::energy(Change &change) {
-    // if (spc.geo.type not_eq Geometry::CUBOID) // cuboid have PBC in all directions
-    if (change) {
-        // all groups have been updated
-        if (change.dV or change.all) {
-            for (auto &g : spc.groups) // loop over *all* groups in system
-                for (auto &p : g)      // loop over *all* active particles in group
-                    if (spc.geo.collision(p.pos))
-                        return pc::infty;
-            return 0;
+/**
+ * @brief Cardinal B-spline weights, `weights[j] = M_n(w + j)` for `j = 0...order-1`
+ * @param w Fractional part of the scaled coordinate, [0:1)
+ * @param order Spline order, n (>=2)
+ * @param weights Destination of `order` weights
+ *
+ * Uses the recursion `M_n(x) = [x M_(n-1)(x) + (n - x) M_(n-1)(x - 1)] / (n - 1)`.
+ */
+static void bsplineWeights(double w, int order, double *weights) {
+    std::fill(weights, weights + order, 0.0);
+    weights[0] = w;       // M_2(w)
+    weights[1] = 1.0 - w; // M_2(w + 1)
+    for (int n = 3; n <= order; n++) {
+        for (int j = n - 1; j >= 0; j--) {
+            const double previous = (j > 0) ? weights[j - 1] : 0.0;
+            weights[j] = ((w + j) * weights[j] + (n - w - j) * previous) / (n - 1);
         }
+    }
+}
 
-        // only a subset of groups have been updated
-        for (auto &d : change.groups) {
-            auto &g = spc.groups[d.index];
-            // all atoms were updated
-            if (d.all) {
-                for (auto &p : g) // loop over *all* active particles in group
-                    if (spc.geo.collision(p.pos))
-                        return pc::infty;
-            } else
-                // only a subset of atoms were updated
-                for (int i : d.atoms) // loop over specific atoms
-                    if (i < g.size())
-                        if (spc.geo.collision((g.begin() + i)->pos))
-                            return pc::infty;
+ParticleMeshEwald::ParticleMeshEwald(const json &j, Space &spc) : data(j), spc(spc) {
+    name = "spme";
+    citation_information = "doi:10.1063/1.470117";
+    spline_order = j.value("order", 6);
+    if (spline_order < 3 or spline_order > max_spline_order) {
+        throw ConfigurationError("{}: spline order must be in the range [3, {}]", name, max_spline_order);
+    }
+    if (auto it = j.find("mesh"); it != j.end()) {
+        if (it->is_array()) {
+            mesh_size = {it->at(0).get<int>(), it->at(1).get<int>(), it->at(2).get<int>()};
+        } else {
+            mesh_size.setConstant(it->get<int>());
+        }
+    } else { // smallest power of two that resolves all wave-vectors within `ncutoff`
+        const int min_size = 2 * static_cast<int>(std::ceil(data.n_cutoff)) + 1;
+        int size = 2;
+        while (size < min_size) {
+            size *= 2;
         }
+        mesh_size.setConstant(size);
     }
-    return 0;
+    for (int dim = 0; dim < 3; dim++) {
+        const int n = mesh_size[dim];
+        if (n < spline_order or (n & (n - 1)) != 0) {
+            throw ConfigurationError("{}: mesh size must be a power of two not smaller than the spline order", name);
+        }
+    }
+    init();
 }
 
-// ------------- Isobaric ---------------
+void ParticleMeshEwald::init() {
+    updateMesh(spc.geo.getLength());
+    rebuild();
+    mesh_is_rebuilt = false;
+}
 
-Isobaric::Isobaric(const json &j, Space &spc) : spc(spc) {
-    name = "isobaric";
-    citation_information = "Frenkel & Smith 2nd Ed (Eq. 5.4.13)";
-    P = j.value("P/mM", 0.0) * 1.0_millimolar;
-    if (P < 1e-10) {
-        P = j.value("P/Pa", 0.0) * 1.0_Pa;
-        if (P < 1e-10)
-            P = j.at("P/atm").get<double>() * 1.0_atm;
+/**
+ * The influence function includes the B-spline moduli, |b(m)|^2, that correct for the
+ * interpolation as well as the prefactor such that the energy is `sum_m influence(m) |F(Q)(m)|^2`.
+ * Its inverse transform is the real-space kernel, theta, used for local energy changes.
+ */
+void ParticleMeshEwald::updateMesh(const Point &box) {
+    data.box_length = box;
+    std::vector<double> knots(spline_order); // M_n at integer arguments
+    bsplineWeights(0.0, spline_order, knots.data());
+    std::array<std::vector<double>, 3> inverse_moduli; // 1 / |b(m)|^2 in each dimension
+    for (int dim = 0; dim < 3; dim++) {
+        const int n = mesh_size[dim];
+        inverse_moduli[dim].resize(n);
+        for (int m = 0; m < n; m++) {
+            std::complex<double> sum(0.0, 0.0);
+            for (int k = 0; k < spline_order - 1; k++) {
+                const double angle = 2.0 * pc::pi * m * k / n;
+                sum += knots[k + 1] * std::complex<double>(std::cos(angle), std::sin(angle));
+            }
+            inverse_moduli[dim][m] = 1.0 / std::norm(sum);
+        }
+    }
+    const double prefactor = 2.0 * pc::pi * data.bjerrum_length / box.prod();
+    influence.assign(mesh_size.prod(), 0.0);
+    for (int i = 0; i < mesh_size[0]; i++) {
+        for (int j = 0; j < mesh_size[1]; j++) {
+            for (int k = 0; k < mesh_size[2]; k++) {
+                Eigen::Vector3i m(i, j, k); // wrap to [-n/2, n/2)
+                for (int dim = 0; dim < 3; dim++) {
+                    if (m[dim] >= mesh_size[dim] / 2) {
+                        m[dim] -= mesh_size[dim];
+                    }
+                }
+                if (m.isZero()) {
+                    continue;
+                }
+                const Point k_vector = 2.0 * pc::pi * m.cast<double>().cwiseQuotient(box);
+                const double k2 = k_vector.squaredNorm() + data.kappa_squared; // last term is only for Yukawa-Ewald
+                influence[meshIndex(i, j, k)] = prefactor * std::exp(-k2 / (4.0 * data.alpha * data.alpha)) / k2 *
+                                                inverse_moduli[0][i] * inverse_moduli[1][j] * inverse_moduli[2][k];
+            }
+        }
     }
+    std::vector<std::complex<double>> transform(influence.begin(), influence.end());
+    fourierTransform(transform, mesh_size, 1);
+    kernel.resize(transform.size());
+    std::transform(transform.begin(), transform.end(), kernel.begin(), [](auto &z) { return z.real(); });
 }
 
-double Isobaric::energy(Change &change) {
-    if (change.dV || change.all || change.dN) {
-        size_t N = 0;
-        for (auto &g : spc.groups) {
-            if (!g.empty()) {
-                if (g.atomic)
-                    N += g.size();
-                else
-                    N++;
+/**
+ * @param particle Particle to spread onto the mesh
+ * @param sign Charge multiplier; use -1 to remove a previous contribution
+ * @param function Called with mesh index and mesh charge for each of the `order^3` mesh points
+ */
+template <typename Tfunction>
+void ParticleMeshEwald::spread(const Particle &particle, double sign, Tfunction function) const {
+    std::array<int, 3> last;
+    double weights[3][max_spline_order];
+    for (int dim = 0; dim < 3; dim++) {
+        const double u = (particle.pos[dim] / data.box_length[dim] + 0.5) * mesh_size[dim]; // scaled coordinate
+        const double floor_u = std::floor(u);
+        bsplineWeights(u - floor_u, spline_order, weights[dim]);
+        last[dim] = static_cast<int>(floor_u);
+    }
+    auto wrap = [&](int index, int dim) {
+        index %= mesh_size[dim];
+        return (index < 0) ? index + mesh_size[dim] : index;
+    };
+    for (int a = 0; a < spline_order; a++) {
+        const int i = wrap(last[0] - a, 0);
+        for (int b = 0; b < spline_order; b++) {
+            const int j = wrap(last[1] - b, 1);
+            const double charge = sign * particle.charge * weights[0][a] * weights[1][b];
+            for (int c = 0; c < spline_order; c++) {
+                function(meshIndex(i, j, wrap(last[2] - c, 2)), charge * weights[2][c]);
             }
         }
-        double V = spc.geo.getVolume();
-        return P * V - (N+1)*std::log(V);
-    } else
-        return 0;
+    }
 }
-void Isobaric::to_json(json &j) const {
-    j["P/atm"] = P / 1.0_atm;
-    j["P/mM"] = P / 1.0_millimolar;
-    j["P/Pa"] = P / 1.0_Pa;
-    _roundjson(j, 5);
+
+void ParticleMeshEwald::updatePotential() {
+    std::vector<std::complex<double>> transform(charge_mesh.begin(), charge_mesh.end());
+    fourierTransform(transform, mesh_size, -1);
+    reciprocal_energy = 0.0;
+    for (size_t m = 0; m < transform.size(); m++) {
+        reciprocal_energy += influence[m] * std::norm(transform[m]);
+        transform[m] *= influence[m];
+    }
+    fourierTransform(transform, mesh_size, 1);
+    potential_mesh.resize(transform.size());
+    std::transform(transform.begin(), transform.end(), potential_mesh.begin(), [](auto &z) { return z.real(); });
+    unapplied.clear();
+    potential_is_stale = false;
 }
 
-Constrain::Constrain(const json &j, Space &spc) {
-    using namespace Faunus::ReactionCoordinate;
+void ParticleMeshEwald::rebuild() {
+    charge_mesh.assign(mesh_size.prod(), 0.0);
+    for (auto &group : spc.groups) {
+        for (auto &particle : group) {
+            spread(particle, 1.0, [&](int index, double charge) { charge_mesh[index] += charge; });
+        }
+    }
+    updatePotential();
+    pending.clear();
+    mesh_is_rebuilt = true;
+}
+
+double ParticleMeshEwald::kernelBetween(int a, int b) const {
+    const int plane = mesh_size[1] * mesh_size[2];
+    auto wrap = [](int delta, int size) { return (delta < 0) ? delta + size : delta; };
+    return kernel[meshIndex(wrap(a / plane - b / plane, mesh_size[0]),
+                            wrap((a / mesh_size[2]) % mesh_size[1] - (b / mesh_size[2]) % mesh_size[1], mesh_size[1]),
+                            wrap(a % mesh_size[2] - b % mesh_size[2], mesh_size[2]))];
+}
+
+double ParticleMeshEwald::transformCost() const {
+    const double mesh_points = charge_mesh.size();
+    return 2.0 * mesh_points * std::log2(mesh_points);
+}
+
+/**
+ * The mesh potential at the changed mesh points includes the accepted, but not yet
+ * transformed, charge changes in `unapplied`.
+ */
+double ParticleMeshEwald::energyChange() const {
+    double du = 0.0;
+    for (auto [a, charge_a] : pending) {
+        double potential = potential_mesh[a];
+        for (auto [b, charge_b] : unapplied) {
+            potential += kernelBetween(a, b) * charge_b;
+        }
+        double convolution = 0.0; // sum_b theta(a - b) dQ_b
+        for (auto [b, charge_b] : pending) {
+            convolution += kernelBetween(a, b) * charge_b;
+        }
+        du += charge_a * (2.0 * potential + convolution);
+    }
+    return du;
+}
+
+double ParticleMeshEwald::energy(Change &change) {
+    if (not change) {
+        return 0.0;
+    }
+    if (key == TRIAL_MONTE_CARLO_STATE) {
+        if (change.all or change.dV) {
+            if (change.dV) {
+                updateMesh(spc.geo.getLength());
+            }
+            rebuild();
+        } else if (old_groups == &spc.groups && !spc.journal.enabled()) { // previous positions are unavailable
+            rebuild();
+        } else if (not change.groups.empty()) {
+            assert(old_groups != nullptr); // previous positions are in the old Space or the journal
+            if (potential_is_stale) { // mesh copied from the accepted state
+                updatePotential();
+            }
+            pending.clear();
+            auto add_to_pending = [&](int index, double charge) { pending.emplace_back(index, charge); };
+            visitChangedParticles(change, spc, *old_groups, committed_particles,
+                                  [&](const Particle &particle, double sign) { spread(particle, sign, add_to_pending); });
+            std::sort(pending.begin(), pending.end()); // merge overlapping old and new mesh points
+            size_t merged = 0;
+            for (size_t i = 1; i < pending.size(); i++) {
+                if (pending[i].first == pending[merged].first) {
+                    pending[merged].second += pending[i].second;
+                } else {
+                    pending[++merged] = pending[i];
+                }
+            }
+            pending.resize(std::min(pending.size(), merged + 1));
+
+            const double transform_cost = transformCost();
+            if (double(pending.size()) * double(pending.size()) > transform_cost) {
+                rebuild(); // local update is more expensive than a full transform
+            } else {
+                if (double(pending.size()) * double(unapplied.size()) > transform_cost) {
+                    updatePotential(); // as is the on-the-fly potential of many accepted changes
+                }
+                reciprocal_energy += energyChange();
+                for (auto [index, charge] : pending) {
+                    charge_mesh[index] += charge;
+                }
+            }
+        }
+    }
+    // the self energy is added by the pair potential (see `Ewald::energy()`)
+    return surface_policy.surfaceEnergy(data, change, spc.groups) + reciprocal_energy;
+}
+
+/**
+ * On acceptance, the trial mesh charges are committed and added to the charge changes that are
+ * not yet transformed into the trial mesh potential. The accepted state never evaluates local
+ * changes and merely marks its potential as stale. On rejection the trial mesh changes are undone.
+ */
+void ParticleMeshEwald::sync(Energybase *energybase_pointer, Change &change) {
+    auto other = dynamic_cast<decltype(this)>(energybase_pointer);
+    assert(other);
+    if (other->key == ACCEPTED_MONTE_CARLO_STATE) {
+        old_groups = &(other->spc.groups);
+    }
+    if (change.all or change.dV or mesh_is_rebuilt or other->mesh_is_rebuilt) {
+        data = other->data;
+        mesh_size = other->mesh_size;
+        influence = other->influence;
+        kernel = other->kernel;
+        charge_mesh = other->charge_mesh;
+        potential_mesh = other->potential_mesh;
+        unapplied = other->unapplied;
+        potential_is_stale = other->potential_is_stale;
+    } else if (key == ACCEPTED_MONTE_CARLO_STATE) { // move accepted
+        for (auto [index, charge] : other->pending) {
+            charge_mesh[index] += charge;
+        }
+        potential_is_stale = true;
+        unapplied.clear();
+        // the trial mesh now holds the committed charges but its potential lacks them
+        other->unapplied.insert(other->unapplied.end(), other->pending.begin(), other->pending.end());
+        other->pending.clear();
+    } else { // move rejected
+        for (auto [index, charge] : pending) {
+            charge_mesh[index] -= charge;
+        }
+    }
+    reciprocal_energy = other->reciprocal_energy;
+    pending.clear();
+    mesh_is_rebuilt = false;
+    other->mesh_is_rebuilt = false;
+}
+
+void ParticleMeshEwald::to_json(json &j) const {
+    j = data;
+    j["mesh"] = {mesh_size[0], mesh_size[1], mesh_size[2]};
+    j["order"] = spline_order;
+}
+
+TEST_CASE("[Faunus] ParticleMeshEwald") {
+    using doctest::Approx;
+    Space spc;
+    spc.geo = R"( {"type": "cuboid", "length": 10} )"_json;
+    spc.p.resize(2);
+    spc.p[0] = R"( {"pos": [0,0,0], "q": 1.0} )"_json;
+    spc.p[1] = R"( {"pos": [1,0,0], "q": -1.0} )"_json;
+    spc.groups.emplace_back(spc.p.begin(), spc.p.end());
+
+    json j = R"({"epsr": 1.0, "alpha": 0.894427190999916, "epss": 1.0, "ewaldscheme": "SPME",
+                 "ncutoff": 11.0, "spherical_sum": true, "cutoff": 5.0, "mesh": 32})"_json;
+    ParticleMeshEwald spme(j, spc);
+    const double bjerrum_length = pc::bjerrumLength(1.0);
+    const double surface_energy = 0.0020943951023931952 * bjerrum_length;
+
+    Change change;
+    change.all = true;
+    spme.key = Energybase::TRIAL_MONTE_CARLO_STATE;
+    CHECK(spme.energy(change) == Approx(0.21303063979675319 * bjerrum_length + surface_energy).epsilon(1e-5));
+
+    json out;
+    spme.to_json(out);
+    CHECK(out.at("ewaldscheme") == "SPME");
+    CHECK(out.at("order") == 6);
+
+    j["mesh"] = 30;
+    CHECK_THROWS(ParticleMeshEwald(j, spc));
+    j["mesh"] = 32;
+    j["order"] = 2;
+    CHECK_THROWS(ParticleMeshEwald(j, spc));
+}
+
+TEST_CASE("[Faunus] ParticleMeshEwald incremental updates") {
+    using doctest::Approx;
+    const json j = R"({"epsr": 1.0, "alpha": 0.894427190999916, "epss": 0.0, "ewaldscheme": "SPME",
+                       "ncutoff": 11.0, "spherical_sum": true, "cutoff": 5.0, "mesh": 16, "order": 4})"_json;
+    Space old_spc, spc; // accepted and trial Space
+    for (auto space : {&old_spc, &spc}) {
+        space->geo = R"( {"type": "cuboid", "length": 10} )"_json;
+        space->p.resize(10);
+        for (size_t i = 0; i < space->p.size(); i++) {
+            space->p[i].charge = (i % 2 == 0) ? 1.0 : -1.0;
+            space->p[i].pos = Point(0.9 * i - 4.5, 0.7 * i - 3.5, 4.0 - 0.8 * i);
+        }
+        for (size_t first = 0; first < space->p.size(); first += 2) { // five molecules with two atoms each
+            space->groups.emplace_back(space->p.begin() + first, space->p.begin() + first + 2);
+        }
+    }
+    ParticleMeshEwald accepted(j, old_spc), trial(j, spc);
+    accepted.key = Energybase::ACCEPTED_MONTE_CARLO_STATE;
+    trial.key = Energybase::TRIAL_MONTE_CARLO_STATE;
+    Change change_all;
+    change_all.all = true;
+    trial.sync(&accepted, change_all); // gives the trial state access to the accepted particles
+
+    auto rebuilt_energy = [&](Space &space) { // fresh evaluation by a full transform
+        ParticleMeshEwald rebuilt(j, space);
+        rebuilt.key = Energybase::TRIAL_MONTE_CARLO_STATE;
+        return rebuilt.energy(change_all);
+    };
+    auto check_moves = [&](auto move, Change &change) {
+        for (int step = 0; step < 30; step++) { // enough accepted moves to transform the accepted charges
+            move(step);
+            const double energy_change = trial.energy(change) - accepted.energy(change);
+            CHECK(energy_change == Approx(rebuilt_energy(spc) - rebuilt_energy(old_spc)));
+            if (step % 3 != 0) { // accept
+                old_spc.sync(spc, change);
+                accepted.sync(&trial, change);
+            } else { // reject
+                spc.sync(old_spc, change);
+                trial.sync(&accepted, change);
+            }
+            // the mesh of the accepted state gives the energy of a full transform whereas the trial
+            // mesh and its potential are checked by the energy change of the next step
+            CHECK(accepted.energy(change) == Approx(rebuilt_energy(old_spc)));
+        }
+    };
+    Change change;
+    auto &changed_group = change.groups.emplace_back();
+
+    SUBCASE("Atom moves") {
+        check_moves(
+            [&](int step) {
+                const int i = (7 * step) % 10;
+                changed_group.index = i / 2;
+                changed_group.atoms = {i % 2};
+                spc.p[i].pos = (random() - 0.5) * spc.geo.getLength();
+            },
+            change);
+    }
+
+    SUBCASE("Rigid body moves") { // all particles of a molecule are changed; no atom index
+        changed_group.all = true;
+        check_moves(
+            [&](int step) {
+                changed_group.index = (3 * step) % 5;
+                const Point displacement = 4.0 * Point(random() - 0.5, random() - 0.5, random() - 0.5);
+                spc.groups[changed_group.index].translate(displacement, spc.geo.getBoundaryFunc());
+            },
+            change);
+    }
+}
+
+double Example2D::energy(Change &) {
+    double s =
+        1 + std::sin(2.0 * pc::pi * particle.x()) + std::cos(2.0 * pc::pi * particle.y()) * static_cast<double>(use_2d);
+    s *= scale_energy;
+    if (particle.x() >= -2.00 && particle.x() <= -1.25)
+        return 1 * s;
+    if (particle.x() >= -1.25 && particle.x() <= -0.25)
+        return 2 * s;
+    if (particle.x() >= -0.25 && particle.x() <= 0.75)
+        return 3 * s;
+    if (particle.x() >= 0.75 && particle.x() <= 1.75)
+        return 4 * s;
+    if (particle.x() >= 1.75 && particle.x() <= 2.00)
+        return 5 * s;
+    return 1e10;
+}
+
+Example2D::Example2D(const json &j, Space &spc) : particle(spc.p.at(0).pos) {
+    scale_energy = j.value("scale", 1.0);
+    use_2d = j.value("2D", true);
+    name = "Example2D";
+}
+void Example2D::to_json(json &j) const {
+    j["scale"] = scale_energy;
+    j["2D"] = use_2d;
+}
+
+double ContainerOverlap::energy(Change &change) {
+    // if (spc.geo.type not_eq Geometry::CUBOID) // cuboid have PBC in all directions
+    if (change) {
+        // all groups have been updated
+        if (change.dV or change.all) {
+            for (auto &g : spc.groups) // loop over *all* groups in system
+                for (auto &p : g)      // loop over *all* active particles in group
+                    if (spc.geo.collision(p.pos))
+                        return pc::infty;
+            return 0;
+        }
+
+        // only a subset of groups have been updated
+        for (auto &d : change.groups) {
+            auto &g = spc.groups[d.index];
+            // all atoms were updated
+            if (d.all) {
+                for (auto &p : g) // loop over *all* active particles in group
+                    if (spc.geo.collision(p.pos))
+                        return pc::infty;
+            } else
+                // only a subset of atoms were updated
+                for (int i : d.atoms) // loop over specific atoms
+                    if (i < g.size())
+                        if (spc.geo.collision((g.begin() + i)->pos))
+                            return pc::infty;
+        }
+    }
+    return 0;
+}
+
+// ------------- Isobaric ---------------
+
+Isobaric::Isobaric(const json &j, Space &spc) : spc(spc) {
+    name = "isobaric";
+    citation_information = "Frenkel & Smith 2nd Ed (Eq. 5.4.13)";
+    P = j.value("P/mM", 0.0) * 1.0_millimolar;
+    if (P < 1e-10) {
+        P = j.value("P/Pa", 0.0) * 1.0_Pa;
+        if (P < 1e-10)
+            P = j.at("P/atm").get<double>() * 1.0_atm;
+    }
+}
+
+double Isobaric::energy(Change &change) {
+    if (change.dV || change.all || change.dN) {
+        size_t N = 0;
+        for (auto &g : spc.groups) {
+            if (!g.empty()) {
+                if (g.atomic)
+                    N += g.size();
+                else
+                    N++;
+            }
+        }
+        double V = spc.geo.getVolume();
+        return P * V - (N+1)*std::log(V);
+    } else
+        return 0;
+}
+void Isobaric::to_json(json &j) const {
+    j["P/atm"] = P / 1.0_atm;
+    j["P/mM"] = P / 1.0_millimolar;
+    j["P/Pa"] = P / 1.0_Pa;
+    _roundjson(j, 5);
+}
+
+Constrain::Constrain(const json &j, Space &spc) {
+    using namespace Faunus::ReactionCoordinate;
     name = "constrain";
     type = j.at("type").get<std::string>();
     rc = ReactionCoordinate::createReactionCoordinate({{type, j}}, spc);
@@ -668,6 +1452,171 @@ void Constrain::to_json(json &j) const {
     j.erase("resolution");
     j["type"] = type;
 }
+
+// ------------- FrozenGrid ---------------
+
+/**
+ * Grids are sampled only for atom types found in the mobile molecules. The pair potential
+ * is given as for `nonbonded`, i.e. by a `default` list of potentials and optional atom pairs.
+ */
+FrozenGrid::FrozenGrid(const json &j, Space &spc) : spc(spc) {
+    name = "frozengrid";
+    spacing = j.value("spacing", 1.0);
+    u_max = j.value("u_max", 100.0);
+    names = j.at("molecules").get<decltype(names)>();
+    is_frozen.assign(Faunus::molecules.size(), false);
+    for (auto id : names2ids(Faunus::molecules, names)) {
+        is_frozen.at(id) = true;
+    }
+    Potential::FunctorPotential pair_potential;
+    pair_potential.from_json(j);
+    if (!pair_potential.isotropic) {
+        throw ConfigurationError("{}: anisotropic pair potentials cannot be sampled on a grid", name);
+    }
+
+    std::vector<Particle> frozen_particles;
+    for (const auto &group : spc.groups) {
+        if (is_frozen.at(group.id)) {
+            frozen_particles.insert(frozen_particles.end(), group.begin(), group.end());
+        }
+    }
+    if (frozen_particles.empty()) {
+        faunus_logger->warn("{}: no frozen particles found", name);
+    }
+
+    box = spc.geo.getLength();
+    std::array<size_t, 3> nodes;
+    for (size_t i = 0; i < 3; i++) {
+        nodes[i] = static_cast<size_t>(std::ceil(box[i] / spacing)) + 1;
+    }
+    const Grid::Point low = {-0.5 * box.x(), -0.5 * box.y(), -0.5 * box.z()};
+    const Grid::Point high = {0.5 * box.x(), 0.5 * box.y(), 0.5 * box.z()};
+    potentials.resize(Faunus::atoms.size());
+    for (const auto &molecule : Faunus::molecules) {
+        if (is_frozen.at(molecule.id())) {
+            continue;
+        }
+        for (auto atom_id : molecule.atoms) {
+            if (!potentials.at(atom_id).empty() || Faunus::atoms.at(atom_id).implicit) {
+                continue;
+            }
+            Particle mobile = Faunus::atoms.at(atom_id);
+            auto node_energy = [&](const Grid::Point &node) {
+                mobile.pos = {node[0], node[1], node[2]};
+                double u = 0.0;
+                for (const auto &frozen : frozen_particles) {
+                    const Point r = spc.geo.vdist(mobile.pos, frozen.pos);
+                    u += pair_potential(mobile, frozen, r.squaredNorm(), r);
+                }
+                return std::clamp(u, -u_max, u_max);
+            };
+            potentials[atom_id] = grid.sample(node_energy, low, high, nodes);
+            faunus_logger->debug("{}: sampled {}x{}x{} grid for {}", name, nodes[0], nodes[1], nodes[2],
+                                 Faunus::atoms[atom_id].name);
+        }
+    }
+}
+
+double FrozenGrid::particleEnergy(const Particle &particle) const {
+    const auto &potential = potentials[particle.id];
+    if (potential.empty()) {
+        throw std::runtime_error(name + ": no grid for atom type " + Faunus::atoms.at(particle.id).name);
+    }
+    return grid.eval(potential, {particle.pos.x(), particle.pos.y(), particle.pos.z()});
+}
+
+double FrozenGrid::energy(Change &change) {
+    double u = 0.0;
+    auto group_energy = [&](const Space::Tgroup &group) {
+        if (is_frozen[group.id]) {
+            return 0.0;
+        }
+        return std::accumulate(group.begin(), group.end(), 0.0,
+                               [&](double sum, const Particle &particle) { return sum + particleEnergy(particle); });
+    };
+    if (change.all || change.dV) {
+        if (!spc.geo.getLength().isApprox(box)) {
+            throw std::runtime_error(name + ": the volume must be constant");
+        }
+        for (const auto &group : spc.groups) {
+            u += group_energy(group);
+        }
+    } else {
+        for (const auto &group_change : change.groups) {
+            const auto &group = spc.groups.at(group_change.index);
+            if (is_frozen[group.id]) {
+                throw std::runtime_error(name + ": frozen molecules cannot change");
+            }
+            if (group_change.all || change.dN) {
+                u += group_energy(group);
+            } else {
+                for (const int i : group_change.atoms) {
+                    u += particleEnergy(*(group.begin() + i));
+                }
+            }
+        }
+    }
+    return u;
+}
+
+void FrozenGrid::to_json(json &j) const {
+    j = {{"molecules", names}, {"spacing", spacing}, {"u_max", u_max}};
+    size_t total_bytes = 0;
+    for (const auto &potential : potentials) {
+        total_bytes += potential.bytes();
+    }
+    j["grid bytes"] = total_bytes;
+}
+
+TEST_CASE("[Faunus] FrozenGrid") {
+    using doctest::Approx;
+    atoms = R"([{ "A": { "q": -1.0 } }, { "B": { "q": 1.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "protein": { "atoms": ["A", "A"], "atomic": true } },
+                    { "ions": { "atoms": ["B", "B"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    Space spc;
+    spc.geo = R"( {"type": "cuboid", "length": 10} )"_json;
+    spc.p.resize(4);
+    spc.p[0] = atoms[0];
+    spc.p[1] = atoms[0];
+    spc.p[2] = atoms[1];
+    spc.p[3] = atoms[1];
+    spc.p[0].pos = {0.23, 1.1, -2.7};
+    spc.p[1].pos = {3.3, -1.9, 0.4};
+    spc.p[2].pos = {1.0, 1.0, 1.0}; // mobile particles on grid nodes
+    spc.p[3].pos = {-2.5, 0.0, 4.5};
+    for (int id : {0, 1}) {
+        Group<Particle> group(spc.p.begin() + 2 * id, spc.p.begin() + 2 * id + 2);
+        group.id = id;
+        group.atomic = true;
+        spc.groups.push_back(group);
+    }
+    typedef PairEnergy<Potential::FunctorPotential, true> TPairEnergy;
+    json j = R"({"default": [{"coulomb": {"epsr": 80, "type": "plain"}}], "molecules": ["protein"],
+                 "spacing": 0.1})"_json;
+    BasePointerVector<Energybase> potentials;
+    FrozenGrid frozen_grid(j, spc);
+    Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>> all_pairs(j, spc, potentials);
+    j["frozen"] = {"protein"};
+    Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>> mobile_pairs(j, spc, potentials);
+
+    Change change;
+    change.all = true;
+    CHECK(frozen_grid.energy(change) != 0.0);
+    CHECK(frozen_grid.energy(change) + mobile_pairs.energy(change) == Approx(all_pairs.energy(change)));
+
+    change.clear();
+    change.groups.resize(1);
+    change.groups[0].index = 1;
+    change.groups[0].atoms = {0};
+    auto approximate_energy = [&] { return frozen_grid.energy(change) + mobile_pairs.energy(change); };
+    const double u_exact = all_pairs.energy(change);
+    const double u_approximate = approximate_energy();
+    spc.p[2].pos = {0.26, 0.1, -1.3}; // in between nodes
+    CHECK(std::fabs((approximate_energy() - u_approximate) - (all_pairs.energy(change) - u_exact)) < 0.01);
+
+    change.groups[0].index = 0; // frozen molecules must not move
+    CHECK_THROWS(frozen_grid.energy(change));
+}
 void Bonded::update_intra() {
     using namespace Potential;
     intra.clear();
@@ -680,15 +1629,77 @@ void Bonded::update_intra() {
         }
     }
 }
-double Bonded::sum_energy(const Bonded::BondVector &bonds) const {
+/**
+ * The bonds are found through the index of each touched particle. A bond between several touched particles is
+ * counted only once, i.e., for its touched particle with the lowest index.
+ */
+double Bonded::sum_energy(const BondIndex &bond_index) const {
+    assert(std::is_sorted(touched.begin(), touched.end()));
+    const auto distance_function = spc.geo.getDistanceFunc();
+    auto is_touched = [&](int particle_index) {
+        return std::binary_search(touched.begin(), touched.end(), particle_index);
+    };
     double energy = 0;
-    for (const auto &bond : bonds) {
-        assert(bond->hasEnergyFunction());
-        energy += bond->energyFunc(spc.geo.getDistanceFunc());
+    for (auto it = touched.begin(); it != touched.end(); ++it) {
+        if (it != touched.begin() && *it == *std::prev(it)) {
+            continue; // particle listed twice
+        }
+        for (const auto *bond : bond_index[*it]) {
+            assert(bond->hasEnergyFunction());
+            const bool is_counted = std::any_of(bond->index.begin(), bond->index.end(),
+                                                [&](int i) { return i < *it && is_touched(i); });
+            if (!is_counted) {
+                energy += bond->energyFunc(distance_function);
+            }
+        }
     }
     return energy;
 }
 
+void Bonded::BondIndex::build(const std::vector<const BondVector *> &bond_vectors, size_t number_of_particles) {
+    offsets.assign(number_of_particles + 1, 0);
+    for (const auto *bond_vector : bond_vectors) { // count bonds of each particle
+        for (const auto &bond : *bond_vector) {
+            for (auto i : bond->index) {
+                offsets.at(i + 1)++;
+            }
+        }
+    }
+    std::partial_sum(offsets.begin(), offsets.end(), offsets.begin());
+    bonds.resize(offsets.back());
+    auto position = offsets; // next free slot of each particle
+    for (const auto *bond_vector : bond_vectors) {
+        for (const auto &bond : *bond_vector) {
+            for (auto i : bond->index) {
+                bonds[position[i]++] = bond.get();
+            }
+        }
+    }
+}
+
+void Bonded::updateBondTables() {
+    inter_tables.clear();
+    for (const auto &bond : inter) {
+        inter_tables.add(*bond);
+    }
+    intra_tables.clear();
+    for (const auto &[group_index, bonds] : intra) {
+        auto &tables = intra_tables[group_index];
+        for (const auto &bond : bonds) {
+            tables.add(*bond);
+        }
+    }
+}
+
+void Bonded::updateBondIndex() {
+    std::vector<const BondVector *> intra_bonds;
+    for (const auto &group_bonds : intra) {
+        intra_bonds.push_back(&group_bonds.second);
+    }
+    intra_index.build(intra_bonds, spc.p.size());
+    inter_index.build({&inter}, spc.p.size());
+}
+
 Bonded::Bonded(const json &j, Space &spc) : spc(spc) {
     name = "bonded";
     update_intra();
@@ -697,6 +1708,8 @@ Bonded::Bonded(const json &j, Space &spc) : spc(spc) {
             inter = j["bondlist"].get<BondVector>();
     for (auto &i : inter) // set all energy functions
         Potential::setBondEnergyFunction(i, spc.p);
+    updateBondIndex();
+    updateBondTables();
 }
 void Bonded::to_json(json &j) const {
     if (!inter.empty())
@@ -709,75 +1722,168 @@ void Bonded::to_json(json &j) const {
                 _j.push_back(b);
     }
 }
+
+/**
+ * Upon changes of single groups or particles, only the bonds of the changed particles are evaluated:
+ * inter-molecular bonds whenever one of their particles moved, and intra-molecular bonds if the
+ * internal configuration of the group changed. The particle-to-bond index is rebuilt if the number
+ * of particles has changed.
+ */
 double Bonded::energy(Change &change) {
+    auto distance = [&geometry = spc.geo](const Point &a, const Point &b) { return geometry.vdist(a, b); };
     double energy = 0;
     if (change) {
-        energy += sum_energy(inter); // energy of inter-molecular bonds
-
-        if (change.all || change.dV) {              // compute all active groups
-            for (const auto &i : intra) {           // energies of intra-molecular bonds
-                if (!spc.groups[i.first].empty()) { // add only if group is active
-                    energy += sum_energy(i.second);
+        if (change.all || change.dV) {                    // compute all active groups
+            energy += inter_tables.energy(spc.p, distance); // energy of inter-molecular bonds
+            for (const auto &[group_index, tables] : intra_tables) { // energies of intra-molecular bonds
+                if (!spc.groups[group_index].empty()) {              // add only if group is active
+                    energy += tables.energy(spc.p, distance);
                 }
             }
         } else { // compute only the affected groups
+            if (change.dN && inter_index.size() != spc.p.size()) {
+                updateBondIndex();
+            }
+            if (!inter.empty()) { // inter-molecular bonds of all changed particles
+                touched.clear();
+                for (const auto &changed : change.groups) {
+                    const auto &group = spc.groups[changed.index];
+                    // an offset is the index of the first particle in the group
+                    const int offset = std::distance(spc.p.begin(), group.begin());
+                    if (changed.all || changed.atoms.empty()) { // includes inactive particles as for `change.all`
+                        const int size = std::distance(group.begin(), group.trueend());
+                        for (int i = 0; i < size; i++) {
+                            touched.push_back(offset + i);
+                        }
+                    } else {
+                        for (auto i : changed.atoms) {
+                            touched.push_back(offset + i);
+                        }
+                    }
+                }
+                std::sort(touched.begin(), touched.end());
+                energy += sum_energy(inter_index);
+            }
+            touched.clear(); // intra-molecular bonds of internally changed groups
             for (const auto &changed : change.groups) {
-                const auto &intra_group = intra[changed.index];
                 if (changed.internal) {
+                    const auto &group = spc.groups[changed.index];
                     if (changed.all) { // all internal positions updated
-                        if (not spc.groups[changed.index].empty())
-                            energy += sum_energy(intra_group);
+                        if (auto tables = intra_tables.find(changed.index);
+                            tables != intra_tables.end() && !group.empty()) {
+                            energy += tables->second.energy(spc.p, distance);
+                        }
                     } else { // only partial update of affected atoms
-                        // an offset is the index of the first particle in the group
-                        const int offset = std::distance(spc.p.begin(), spc.groups[changed.index].begin());
-                        // add an offset to the group atom indices to get the absolute indices
-                        auto particle_indices =
-                            changed.atoms | ranges::cpp20::views::transform([offset](auto i) { return i + offset; });
-                        energy += sum_energy(intra_group, particle_indices);
+                        const int offset = std::distance(spc.p.begin(), group.begin());
+                        for (auto i : changed.atoms) {
+                            touched.push_back(offset + i);
+                        }
                     }
                 }
             }
-        } // for-loop over groups
+            if (!touched.empty()) {
+                std::sort(touched.begin(), touched.end());
+                energy += sum_energy(intra_index);
+            }
+        }
     }
     return energy;
 }
 
+Energybase::Locality Bonded::locality() const { return inter.empty() ? Locality::GROUP : Locality::NONLOCAL; }
+
 /**
  * @param forces Target force vector for *all* particles in the system
  *
  * Each element in `force` represent the force on a particle and this
- * updates (add) the bonded force.
- *
- * - loop over groups and their internal bonds and _add_ force
- * - loop over inter-molecular bonds and _add_ force
+ * updates (add) the bonded force of inter-molecular bonds and of the
+ * intra-molecular bonds of active groups.
  *
  * Force unit: kT/Å
- *
- * @warning Untested
  */
 void Bonded::force(std::vector<Point> &forces) {
-    auto distance_function = spc.geo.getDistanceFunc();
-    for (const auto &[group_index, bonds] : intra) {                     // loop over all intra-molecular bonds
-        const auto &group = spc.groups[group_index];                     // this is the group we're currently working on
-        for (const auto &bond : bonds) {                                 // loop over all bonds in group
-            assert(bond->forceFunc != nullptr);                          // the force function must be implemented
-            const auto bond_forces = bond->forceFunc(distance_function); // get forces on each atom in bond
-            assert(bond->index.size() == bond_forces.size());
-            for (size_t i = 0; i < bond->index.size(); i++) { // loop over atom index in bond (relative to group begin)
-                const auto absolute_index = std::distance(spc.p.begin(), group.begin()) + bond->index[i];
-                assert(absolute_index < forces.size());
-                forces[absolute_index] += bond_forces[i]; // add to overall force
+    auto distance = [&geometry = spc.geo](const Point &a, const Point &b) { return geometry.vdist(a, b); };
+    for (const auto &[group_index, tables] : intra_tables) { // loop over all intra-molecular bonds
+        if (!spc.groups[group_index].empty()) {
+            tables.force(spc.p, distance, forces);
+        }
+    }
+    inter_tables.force(spc.p, distance, forces); // inter-molecular bonds
+}
+
+TEST_CASE("[Faunus] Bonded") {
+    using doctest::Approx;
+    atoms = R"([{ "A": { "sigma": 2.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "chain": {
+                        "structure": [{"A": [0.0, 0.0, 0.0]}, {"A": [1.5, 0.0, 0.0]}, {"A": [3.0, 0.0, 0.0]}],
+                        "bondlist": [{"harmonic": {"index": [0, 1], "k": 1.0, "req": 1.5}},
+                                     {"harmonic": {"index": [1, 2], "k": 1.0, "req": 1.5}}] } }])"_json
+                    .get<decltype(molecules)>();
+    Space spc;
+    spc.geo = R"( {"type": "cuboid", "length": 20} )"_json;
+    for (int i = 0; i < 2; i++) { // two chains with distorted bonds
+        ParticleVector particles;
+        for (int j = 0; j < 3; j++) {
+            particles.emplace_back(atoms.front(), Point(1.3 * j + 0.1 * i, 0.2 * j, 2.0 * i));
+        }
+        spc.push_back(molecules.front().id(), particles);
+    }
+    const json inter = R"([{"harmonic": {"index": [2, 3], "k": 2.0, "req": 1.0}},
+                           {"harmonic": {"index": [0, 4], "k": 0.5, "req": 3.0}}])"_json;
+    Bonded bonded(json{{"bondlist", inter}}, spc);
+
+    // brute force: sum the bonds with at least one moved particle, each bond once
+    const json intra = R"([{"harmonic": {"index": [0, 1], "k": 1.0, "req": 1.5}},
+                           {"harmonic": {"index": [1, 2], "k": 1.0, "req": 1.5}},
+                           {"harmonic": {"index": [3, 4], "k": 1.0, "req": 1.5}},
+                           {"harmonic": {"index": [4, 5], "k": 1.0, "req": 1.5}}])"_json;
+    std::vector<std::pair<std::shared_ptr<Potential::BondData>, bool>> all_bonds; // (bond, is intra-molecular)
+    for (const auto &[bonds, is_intra] : {std::pair{intra, true}, std::pair{inter, false}}) {
+        for (const auto &bond : bonds) {
+            all_bonds.emplace_back(bond.get<std::shared_ptr<Potential::BondData>>(), is_intra);
+            Potential::setBondEnergyFunction(all_bonds.back().first, spc.p);
+        }
+    }
+    auto brute_force = [&](const std::vector<int> &moved, bool internal) {
+        const auto distance_function = spc.geo.getDistanceFunc();
+        double energy = 0.0;
+        for (const auto &[bond, is_intra] : all_bonds) {
+            const bool is_moved = std::any_of(bond->index.begin(), bond->index.end(), [&](int i) {
+                return std::find(moved.begin(), moved.end(), i) != moved.end();
+            });
+            if (is_moved && (internal || !is_intra)) {
+                energy += bond->energyFunc(distance_function);
             }
         }
+        return energy;
+    };
+
+    Change change;
+    change.all = true;
+    CHECK(bonded.energy(change) == Approx(brute_force({0, 1, 2, 3, 4, 5}, true)));
+
+    SUBCASE("Intra-molecular bond between two moved particles") {
+        change.clear();
+        change.groups.resize(1);
+        change.groups[0].index = 0;
+        change.groups[0].internal = true;
+        change.groups[0].atoms = {1, 2}; // bond 1-2 is counted once; 2-3 is inter-molecular
+        CHECK(bonded.energy(change) == Approx(brute_force({1, 2}, true)));
+        change.groups[0].internal = false; // rigid body move: only inter-molecular bonds
+        CHECK(bonded.energy(change) == Approx(brute_force({1, 2}, false)));
     }
 
-    for (const auto &bond : inter) {                                 // loop over inter-molecular bonds
-        assert(bond->forceFunc != nullptr);                          // the force function must be implemented
-        const auto bond_forces = bond->forceFunc(distance_function); // get forces on each atom in bond
-        assert(bond_forces.size() == bond->index.size());
-        for (size_t i = 0; i < bond->index.size(); i++) { // loop over atom index in bond (absolute index)
-            forces[bond->index[i]] += bond_forces[i];     // add to overall force
+    SUBCASE("Inter-molecular bond between two moved particles") {
+        change.clear();
+        change.groups.resize(2);
+        change.groups[0].index = 0;
+        change.groups[0].atoms = {2};
+        change.groups[1].index = 1;
+        change.groups[1].atoms = {0, 1}; // bond 2-3 is counted once
+        for (auto &changed : change.groups) {
+            changed.internal = true;
         }
+        CHECK(bonded.energy(change) == Approx(brute_force({2, 3, 4}, true)));
     }
 }
 
@@ -786,6 +1892,11 @@ void Bonded::force(std::vector<Point> &forces) {
 void Hamiltonian::to_json(json &j) const {
     for (auto i : this->vec)
         j.push_back(*i);
+    if (ledger) {
+        json _j;
+        ledger->to_json(_j["ledger"]);
+        j.push_back(_j);
+    }
 }
 
 void Hamiltonian::addEwald(const json &j, Space &spc) {
@@ -806,8 +1917,13 @@ void Hamiltonian::addEwald(const json &j, Space &spc) {
 
     if (_j.count("type")) {
         if (_j.at("type") == "ewald") {
-            faunus_logger->debug("adding Ewald reciprocal and surface energy terms");
-            emplace_back<Energy::Ewald>(_j, spc);
+            if (_j.value("ewaldscheme", EwaldData::PBC) == EwaldData::SPME) {
+                faunus_logger->debug("adding particle-mesh Ewald reciprocal and surface energy terms");
+                emplace_back<Energy::ParticleMeshEwald>(_j, spc);
+            } else {
+                faunus_logger->debug("adding Ewald reciprocal and surface energy terms");
+                emplace_back<Energy::Ewald>(_j, spc);
+            }
         }
     }
 }
@@ -818,6 +1934,317 @@ void Hamiltonian::force(PointVector &forces) {
     }
 }
 
+/**
+ * @brief Determines if the input contains a custom pair potential
+ *
+ * The custom pair potential binds the expression variables to a shared storage which is overwritten upon
+ * each evaluation. It is therefore not safe to use in parallel pairing policies.
+ */
+static bool hasCustomPairPotential(const json &j) {
+    if (j.is_object()) {
+        for (auto &it : j.items()) {
+            if (it.key() == "custom" && it.value().is_object() && it.value().count("function") == 1) {
+                return true;
+            }
+            if (hasCustomPairPotential(it.value())) {
+                return true;
+            }
+        }
+    } else if (j.is_array()) {
+        return std::any_of(j.begin(), j.end(), hasCustomPairPotential);
+    }
+    return false;
+}
+
+/**
+ * @brief Names of all molecules in `frozengrid` terms of the Hamiltonian input
+ */
+static json frozenMolecules(const json &j) {
+    json frozen = json::array();
+    for (const auto &m : j) {
+        for (const auto &it : m.items()) {
+            if (it.key() == "frozengrid") {
+                for (const auto &name : it.value().at("molecules")) {
+                    frozen.push_back(name);
+                }
+            }
+        }
+    }
+    return frozen;
+}
+
+/**
+ * @brief Input for `FrozenGrid`; the pair potential is taken from the first `nonbonded` term if not given
+ */
+static json frozenGridInput(const json &hamiltonian, const json &input) {
+    if (input.contains("default")) {
+        return input;
+    }
+    for (const auto &m : hamiltonian) {
+        for (const auto &it : m.items()) {
+            if (it.key() == "nonbonded" || it.key() == "nonbonded_exact" || it.key() == "nonbonded_splined" ||
+                it.key() == "nonbonded_cached" || it.key() == "nonbonded_celllist") {
+                json merged = it.value();
+                merged.update(input);
+                return merged;
+            }
+        }
+    }
+    throw ConfigurationError("pair potential missing; give `default` or add a nonbonded term");
+}
+
+TEST_CASE("[Faunus] hasCustomPairPotential") {
+    CHECK(hasCustomPairPotential(R"({"default": [{"custom": {"function": "q1*q2/r"}}]})"_json));
+    CHECK(hasCustomPairPotential(R"({"default": [{"wca": {}}], "A B": [{"custom": {"function": "1"}}]})"_json));
+    CHECK_FALSE(hasCustomPairPotential(R"({"default": [{"coulomb": {"type": "plain", "epsr": 80}}]})"_json));
+    // custom mixing of sigma and epsilon is not a custom pair potential
+    CHECK_FALSE(hasCustomPairPotential(
+        R"({"default": [{"lennardjones": {"mixing": "LB", "custom": {"A B": {"eps": 1, "sigma": 2}}}}]})"_json));
+}
+
+TEST_CASE("[Faunus] CellListPairingPolicy") {
+    using doctest::Approx;
+    atoms = R"([{ "A": { "q": 1.0, "sigma": 0.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "salt": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    Space spc;
+    spc.geo = R"( {"type": "cuboid", "length": 40} )"_json;
+    spc.p.resize(200);
+    for (auto &p : spc.p) {
+        p.charge = (&p - spc.p.data()) % 2 == 0 ? 1.0 : -1.0;
+        p.pos = (random() - 0.5) * spc.geo.getLength();
+    }
+    Group<Particle> group(spc.p.begin(), spc.p.end());
+    group.atomic = true;
+    spc.groups.push_back(group);
+
+    typedef PairEnergy<Potential::CombinedPairPotential<Potential::Coulomb, Potential::HardSphere>, false> TPairEnergy;
+    const json j = R"({"coulomb": {"epsr": 80}, "cutoff": 8})"_json;
+    BasePointerVector<Energybase> potentials;
+    CellListPairingPolicy<TPairEnergy, GroupCutoff> celllist(spc, potentials);
+    PairingBasePolicy<PairEnergyWithCutoff<TPairEnergy>, GroupCutoff> exact(spc, potentials);
+    celllist.from_json(j);
+    exact.from_json(j);
+
+    Change change;
+    change.all = true;
+    celllist.update(change);
+
+    const std::vector<int> index = {1, 5, 50, 199};
+    CHECK(celllist.groupInternal(spc.groups[0], 5) == Approx(exact.groupInternal(spc.groups[0], 5)));
+    CHECK(celllist.groupInternal(spc.groups[0], index) == Approx(exact.groupInternal(spc.groups[0], index)));
+
+    SUBCASE("Move across periodic boundary and roll back") {
+        celllist.commit();
+        const Point old_position = spc.p[5].pos;
+        spc.p[5].pos = {19.9, -19.9, 0.0};
+        Change::data change_data;
+        change_data.index = 0;
+        change_data.atoms = {5};
+        change.clear();
+        change.groups.push_back(change_data);
+        celllist.update(change);
+        CHECK(celllist.groupInternal(spc.groups[0], 5) == Approx(exact.groupInternal(spc.groups[0], 5)));
+        CHECK(celllist.groupInternal(spc.groups[0], index) == Approx(exact.groupInternal(spc.groups[0], index)));
+        spc.p[5].pos = old_position;
+        celllist.rollback(celllist);
+        CHECK(celllist.groupInternal(spc.groups[0], 5) == Approx(exact.groupInternal(spc.groups[0], 5)));
+    }
+
+    SUBCASE("Volume change") {
+        celllist.commit();
+        change.clear();
+        change.dV = true;
+        spc.scaleVolume(1.2 * spc.geo.getVolume());
+        celllist.update(change);
+        CHECK(celllist.groupInternal(spc.groups[0], index) == Approx(exact.groupInternal(spc.groups[0], index)));
+        spc.scaleVolume(0.3 * spc.geo.getVolume()); // cells become too small; rebuild
+        celllist.update(change);
+        CHECK(celllist.groupInternal(spc.groups[0], index) == Approx(exact.groupInternal(spc.groups[0], index)));
+    }
+
+    SUBCASE("Several groups compared with PairingPolicy") {
+        spc.groups.clear();
+        for (int first = 0; first < 200; first += 50) { // four atomic groups
+            Group<Particle> group(spc.p.begin() + first, spc.p.begin() + first + 50);
+            group.atomic = true;
+            spc.groups.push_back(group);
+        }
+        PairingPolicy<PairEnergyWithCutoff<TPairEnergy>, GroupCutoff> plain(spc, potentials);
+        plain.from_json(j);
+        celllist.update(change); // rebuild for the new groups
+        celllist.commit();
+        auto check_groups = [&] {
+            for (const auto &group : spc.groups) {
+                CHECK(celllist.group2all(group) == Approx(plain.group2all(group)));
+                CHECK(celllist.group2all(group, 7) == Approx(plain.group2all(group, 7)));
+                CHECK(celllist.group2all(group, std::vector<int>{0, 7, 49}) ==
+                      Approx(plain.group2all(group, std::vector<int>{0, 7, 49})));
+            }
+            CHECK(celllist.group2group(spc.groups[0], spc.groups[3]) ==
+                  Approx(plain.group2group(spc.groups[0], spc.groups[3])));
+            CHECK(celllist.group2group(spc.groups[1], spc.groups[2], std::vector<int>{7}) ==
+                  Approx(plain.group2group(spc.groups[1], spc.groups[2], std::vector<int>{7})));
+        };
+        check_groups();
+
+        spc.p[57].pos = {19.9, -19.9, 0.0}; // move atom 7 of group 1 across the periodic boundary
+        Change::data change_data;
+        change_data.index = 1;
+        change_data.atoms = {7};
+        Change move;
+        move.groups.push_back(change_data);
+        celllist.update(move);
+        check_groups();
+    }
+}
+
+TEST_CASE("[Faunus] PairingPolicy in parallel") {
+    using doctest::Approx;
+    atoms = R"([{ "A": { "q": 1.0, "sigma": 0.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "salt": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    Space spc;
+    spc.geo = R"( {"type": "cuboid", "length": 40} )"_json;
+    spc.p.resize(200);
+    for (auto &p : spc.p) {
+        p.charge = (&p - spc.p.data()) % 2 == 0 ? 1.0 : -1.0;
+        p.pos = (random() - 0.5) * spc.geo.getLength();
+    }
+    for (int first = 0; first < 200; first += 2) { // more group pairs than are evaluated serially
+        Group<Particle> group(spc.p.begin() + first, spc.p.begin() + first + 2);
+        group.atomic = true;
+        spc.groups.push_back(group);
+    }
+
+    typedef PairEnergy<Potential::CombinedPairPotential<Potential::Coulomb, Potential::HardSphere>, false> TPairEnergy;
+    const json j = R"({"coulomb": {"epsr": 80}})"_json;
+    BasePointerVector<Energybase> potentials;
+    PairingPolicy<TPairEnergy, GroupCutoff, false> serial(spc, potentials);
+    PairingPolicy<TPairEnergy, GroupCutoff, true> parallel(spc, potentials);
+    serial.from_json(j);
+    parallel.from_json(j);
+
+    const auto &group = spc.groups[10];
+    const std::vector<int> moved = {3, 10, 50}; // sorted group indices
+    const std::vector<int> fixed = indexComplement(spc.groups.size(), moved) | ranges::to<std::vector>;
+    const std::vector<int> whole_group = {0, 1}, single_particle = {1};
+    auto energies = [&](auto &pairing) {
+        return std::vector<double>{pairing.group2all(group), pairing.group2all(group, whole_group),
+                                   pairing.groups2all(moved), pairing.group2groups(group, spc.groups),
+                                   pairing.group2groups(group, fixed, single_particle)};
+    };
+    const auto serial_energies = energies(serial);
+    const auto default_threads_energies = energies(parallel); // with the default number of threads
+#ifdef _OPENMP
+    const int max_threads = omp_get_max_threads();
+    const std::vector<int> thread_counts = {1, 2, 3, 4};
+#else
+    const std::vector<int> thread_counts = {1};
+#endif
+    for (const int num_threads : thread_counts) {
+        CAPTURE(num_threads);
+#ifdef _OPENMP
+        omp_set_num_threads(num_threads);
+#endif
+        const auto parallel_energies = energies(parallel);
+        REQUIRE(parallel_energies.size() == serial_energies.size());
+        for (size_t i = 0; i < serial_energies.size(); i++) {
+            CHECK(parallel_energies[i] == Approx(serial_energies[i]));
+        }
+        CHECK(parallel_energies == default_threads_energies); // summed in the same order by any number of threads
+    }
+#ifdef _OPENMP
+    omp_set_num_threads(max_threads);
+#endif
+}
+
+TEST_CASE("[Faunus] NonbondedCached") {
+    using doctest::Approx;
+    atoms = R"([{ "A": { "q": 1.0, "sigma": 0.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "salt": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    Space spc;
+    spc.geo = R"( {"type": "cuboid", "length": 40} )"_json;
+    spc.p.resize(30);
+    for (auto &p : spc.p) {
+        p.charge = (&p - spc.p.data()) % 2 == 0 ? 1.0 : -1.0;
+        p.pos = (random() - 0.5) * spc.geo.getLength();
+    }
+    for (auto first : {0, 10, 20}) { // three atomic groups
+        Group<Particle> group(spc.p.begin() + first, spc.p.begin() + first + 10);
+        group.atomic = true;
+        spc.groups.push_back(group);
+    }
+
+    typedef PairEnergy<Potential::CombinedPairPotential<Potential::Coulomb, Potential::HardSphere>, false> TPairEnergy;
+    const json j = R"({"coulomb": {"epsr": 80, "type": "plain"}})"_json;
+    BasePointerVector<Energybase> potentials;
+    NonbondedCached<TPairEnergy> accepted(j, spc, potentials), trial(j, spc, potentials);
+    Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>> exact(j, spc, potentials);
+    accepted.key = Energybase::ACCEPTED_MONTE_CARLO_STATE;
+    trial.key = Energybase::TRIAL_MONTE_CARLO_STATE;
+
+    Change change_all;
+    change_all.all = true;
+    spc.updateParticleArrays(change_all);
+    CHECK(accepted.energy(change_all) == Approx(exact.energy(change_all)));
+
+    Change change;
+    change.groups.resize(1);
+    change.groups[0].index = 1;
+    change.groups[0].internal = true;
+
+    SUBCASE("Incremental update of atomic group") {
+        change.groups[0].atoms = {5};
+        const double u_total = exact.energy(change_all);
+        const double u_old = accepted.energy(change);
+        spc.p[15].pos = {1.0, 2.0, 3.0};
+        spc.updateParticleArrays(change);
+        const double u_new = trial.energy(change);
+        CHECK(u_new - u_old == Approx(exact.energy(change_all) - u_total));
+        accepted.sync(&trial, change);
+        CHECK(accepted.energy(change_all) == Approx(exact.energy(change_all)));
+        CHECK(trial.energy(change_all) == Approx(exact.energy(change_all)));
+    }
+
+    SUBCASE("Rejected move of whole group") {
+        change.groups[0].all = true;
+        const double u_accepted = accepted.energy(change_all);
+        const Point old_position = spc.p[15].pos;
+        spc.p[15].pos = {1.0, 2.0, 3.0};
+        spc.updateParticleArrays(change);
+        trial.energy(change);
+        spc.p[15].pos = old_position;
+        spc.updateParticleArrays(change);
+        trial.sync(&accepted, change);
+        CHECK(trial.energy(change_all) == Approx(u_accepted));
+    }
+
+    SUBCASE("Deletion of a particle (dN)") {
+        change.dN = true;
+        change.groups[0].atoms = {9};
+        const double u_total = exact.energy(change_all);
+        const double u_old = accepted.energy(change);
+        auto &group = spc.groups[1];
+        group.deactivate(group.end() - 1, group.end());
+        const double u_new = trial.energy(change);
+        CHECK(u_new == Approx(0.0)); // the deleted particle is inactive in the trial state
+        CHECK(u_new - u_old == Approx(exact.energy(change_all) - u_total));
+        accepted.sync(&trial, change);
+        CHECK(accepted.energy(change_all) == Approx(exact.energy(change_all)));
+    }
+}
+
+/**
+ * The group-to-group energies are cached (`NonbondedCached`) if the input contains `cached: true`.
+ * Only a single cutoff scheme is available so far.
+ */
+template <typename TPairEnergy, bool parallel> void Hamiltonian::addNonbonded(const json &j, Space &spc) {
+    if (j.value("cached", false)) {
+        emplace_back<Energy::NonbondedCached<TPairEnergy>>(j, spc, *this);
+    } else {
+        emplace_back<Energy::Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff, parallel>>>(j, spc, *this);
+    }
+}
+
 Hamiltonian::Hamiltonian(Space &spc, const json &j) {
     using namespace Potential;
 
@@ -835,42 +2262,56 @@ Hamiltonian::Hamiltonian(Space &spc, const json &j) {
     if (spc.geo.type not_eq Geometry::CUBOID)
         emplace_back<Energy::ContainerOverlap>(spc);
 
-    // only a single cutoff scheme so far
-    typedef GroupCutoff TCutoff;
 #ifdef _OPENMP
-    // ready for OMP enabled policies
-    constexpr bool parallel = false;
+    // split outer group loops among threads; see PairingPolicy<..., true>
+    constexpr bool parallel = true;
 #else
     constexpr bool parallel = false;
 #endif
+    bool use_ledger = false;
+    const json frozen = frozenMolecules(j); // excluded from nonbonded terms; see FrozenGrid
     for (auto &m : j) { // loop over energy list
         size_t oldsize = vec.size();
         for (auto it : m.items()) {
             try {
+                json input = it.value();
+                if (!frozen.empty() && it.key().rfind("nonbonded", 0) == 0)
+                    input["frozen"] = frozen;
+
                 if (it.key() == "nonbonded_coulomblj" || it.key() == "nonbonded_newcoulomblj")
-                    emplace_back<Energy::Nonbonded<PairingPolicy<PairEnergy<CoulombLJ, false>, TCutoff, parallel>>>(it.value(), spc, *this);
+                    addNonbonded<PairEnergy<CoulombLJ, false>, parallel>(input, spc);
                 else if (it.key() == "nonbonded_coulomblj_EM")
-                    emplace_back<Energy::NonbondedCached<CoulombLJ>>(it.value(), spc, *this);
+                    emplace_back<Energy::NonbondedCached<PairEnergy<CoulombLJ, false>>>(input, spc, *this);
+
+                // custom pair potentials are not thread-safe and hence always evaluated serially
+                else if (it.key() == "nonbonded_splined") {
+                    if (parallel && !hasCustomPairPotential(input))
+                        addNonbonded<PairEnergy<SplinedPotential, false>, parallel>(input, spc);
+                    else
+                        addNonbonded<PairEnergy<SplinedPotential, false>, false>(input, spc);
+                }
 
-                else if (it.key() == "nonbonded_splined")
-                    emplace_back<
-                        Energy::Nonbonded<PairingPolicy<PairEnergy<SplinedPotential, false>, TCutoff, parallel>>>(
-                        it.value(), spc, *this);
+                else if (it.key() == "nonbonded" or it.key() == "nonbonded_exact") {
+                    if (parallel && !hasCustomPairPotential(input))
+                        addNonbonded<PairEnergy<FunctorPotential, true>, parallel>(input, spc);
+                    else
+                        addNonbonded<PairEnergy<FunctorPotential, true>, false>(input, spc);
+                }
 
-                else if (it.key() == "nonbonded" or it.key() == "nonbonded_exact")
-                    emplace_back<Energy::Nonbonded<PairingPolicy<PairEnergy<FunctorPotential, true>, TCutoff, parallel>>>(it.value(), spc, *this);
+                else if (it.key() == "nonbonded_celllist")
+                    emplace_back<Energy::NonbondedCellList<PairEnergy<SplinedPotential, false>>>(input, spc, *this);
 
                 else if (it.key() == "nonbonded_cached")
-                    emplace_back<Energy::NonbondedCached<SplinedPotential>>(it.value(), spc, *this);
+                    emplace_back<Energy::NonbondedCached<PairEnergy<SplinedPotential, false>>>(input, spc, *this);
 
                 else if (it.key() == "nonbonded_coulombwca")
-                    emplace_back<Energy::Nonbonded<PairingPolicy<PairEnergy<CoulombWCA, false>, TCutoff, parallel>>>(it.value(), spc, *this);
+                    addNonbonded<PairEnergy<CoulombWCA, false>, parallel>(input, spc);
 
                 else if (it.key() == "nonbonded_pm" or it.key() == "nonbonded_coulombhs")
-                    emplace_back<Energy::Nonbonded<PairingPolicy<PairEnergy<PrimitiveModel, false>, TCutoff, parallel>>>(it.value(), spc, *this);
+                    addNonbonded<PairEnergy<PrimitiveModel, false>, parallel>(input, spc);
 
                 else if (it.key() == "nonbonded_pmwca")
-                    emplace_back<Energy::Nonbonded<PairingPolicy<PairEnergy<PrimitiveModelWCA, false>, TCutoff, parallel>>>(it.value(), spc, *this);
+                    addNonbonded<PairEnergy<PrimitiveModelWCA, false>, parallel>(input, spc);
 
                 // this should be moved into `Nonbonded` and added when appropriate
                 // Nonbonded now has access to Hamiltonian (*this) and can therefore
@@ -892,6 +2333,9 @@ Hamiltonian::Hamiltonian(Space &spc, const json &j) {
                 else if (it.key() == "constrain")
                     emplace_back<Energy::Constrain>(it.value(), spc);
 
+                else if (it.key() == "frozengrid")
+                    emplace_back<Energy::FrozenGrid>(frozenGridInput(j, it.value()), spc);
+
                 else if (it.key() == "example2d")
                     emplace_back<Energy::Example2D>(it.value(), spc);
 
@@ -915,6 +2359,11 @@ Hamiltonian::Hamiltonian(Space &spc, const json &j) {
                     continue;
                 }
 
+                else if (it.key() == "ledger") {
+                    use_ledger = it.value().get<bool>();
+                    continue;
+                }
+
                 if (vec.size() == oldsize)
                     throw std::runtime_error("unknown term");
 
@@ -928,14 +2377,20 @@ Hamiltonian::Hamiltonian(Space &spc, const json &j) {
     for (auto &a : Faunus::molecules)
         if (not a.bonds.empty() and this->find<Energy::Bonded>().empty())
             faunus_logger->warn(a.name + " bonds specified in topology but missing in energy");
+
+    if (use_ledger) {
+        ledger.emplace(*this, spc.groups.size());
+    }
 }
 double Hamiltonian::energy(Change &change) {
+    const int moved_group = ledger ? EnergyLedger::movedGroup(change) : -1;
     double du = 0;
-    for (auto i : this->vec) { // loop over terms in Hamiltonian
-        i->key = key;
-        i->timer.start(); // time each term
-        du += i->energy(change);
-        i->timer.stop();
+    for (size_t i = 0; i < vec.size(); i++) { // loop over terms in Hamiltonian
+        auto &term = *vec[i];
+        term.key = key;
+        term.timer.start(); // time each term
+        du += (moved_group >= 0) ? ledger->energy(i, term, change, moved_group) : term.energy(change);
+        term.timer.stop();
         if (du >= maxenergy)
             break; // stop summing energies
     }
@@ -944,6 +2399,9 @@ double Hamiltonian::energy(Change &change) {
 void Hamiltonian::init() {
     for (auto i : this->vec)
         i->init();
+    if (ledger) {
+        ledger->invalidate();
+    }
 }
 void Hamiltonian::sync(Energybase *basePtr, Change &change) {
     auto other = dynamic_cast<decltype(this)>(basePtr);
@@ -951,11 +2409,353 @@ void Hamiltonian::sync(Energybase *basePtr, Change &change) {
         if (other->size() == size()) {
             for (size_t i = 0; i < size(); i++)
                 this->vec[i]->sync(other->vec[i].get(), change);
+            if (ledger and other->ledger) {
+                ledger->sync(*other->ledger, change, key);
+            }
             return;
         }
     throw std::runtime_error("hamiltonian mismatch");
 }
 
+//----------------- Energy ledger -------------------
+
+EnergyLedger::EnergyLedger(const BasePointerVector<Energybase> &terms, size_t number_of_groups) {
+    records.resize(terms.size());
+    for (size_t i = 0; i < terms.size(); i++) {
+        auto &record = records[i];
+        record.locality = terms.vec[i]->locality();
+        if (record.locality == Energybase::Locality::GROUP) {
+            record.group_energy.resize(number_of_groups, 0.0);
+        } else if (record.locality == Energybase::Locality::GROUP_PAIR) {
+            record.pair_energy = PairMatrix<double, true>(number_of_groups, 0.0);
+            record.row_energy.resize(number_of_groups, 0.0);
+            record.row_evaluated.resize(number_of_groups, 0);
+            record.row_changed.resize(number_of_groups, 0);
+        }
+    }
+    invalidate();
+}
+
+int EnergyLedger::movedGroup(const Change &change) {
+    if (change.all or change.dV or change.dN or change.groups.size() != 1) {
+        return -1;
+    }
+    const auto &changed_group = change.groups.front();
+    return (changed_group.all and not changed_group.internal) ? changed_group.index : -1;
+}
+
+void EnergyLedger::invalidate() {
+    for (auto &record : records) {
+        record.group_is_valid.assign(record.group_energy.size(), false);
+        record.stale_rows.resize(record.pair_energy.size());
+        std::iota(record.stale_rows.begin(), record.stale_rows.end(), 0);
+        for (auto group_index : record.stale_rows) {
+            record.row_changed[group_index] = ++generation;
+        }
+    }
+}
+
+/**
+ * The row sums of the other groups are updated by the difference to the old entries. Non-finite
+ * sums, e.g. due to overlapping groups, are summed anew when looked up.
+ */
+void EnergyLedger::setRow(Record &record, size_t group_index, const std::vector<double> &energies) {
+    assert(energies.size() == record.pair_energy.size());
+    double energy = 0.0;
+    for (size_t j = 0; j < energies.size(); j++) {
+        if (j != group_index) {
+            record.row_energy[j] += energies[j] - record.pair_energy(group_index, j);
+            record.pair_energy.set(group_index, j, energies[j]);
+            energy += energies[j];
+        }
+    }
+    record.row_energy[group_index] = energy;
+    record.row_evaluated[group_index] = ++generation;
+    if (auto it = std::find(record.stale_rows.begin(), record.stale_rows.end(), group_index);
+        it != record.stale_rows.end()) {
+        record.stale_rows.erase(it);
+    }
+}
+
+/**
+ * Stale rows are kept in the order of invalidation, see `rowIsValid()`.
+ */
+void EnergyLedger::invalidateRow(Record &record, size_t group_index) {
+    record.row_changed.at(group_index) = ++generation;
+    if (auto it = std::find(record.stale_rows.begin(), record.stale_rows.end(), group_index);
+        it != record.stale_rows.end()) {
+        record.stale_rows.erase(it);
+    }
+    record.stale_rows.push_back(group_index);
+}
+
+/**
+ * The entry of groups `i` and `j` is valid if the row of `i` or `j` was evaluated after both were
+ * invalidated. Hence all entries of a group are valid if it was evaluated after the most recent
+ * invalidation of a group that has not been evaluated since.
+ */
+bool EnergyLedger::rowIsValid(const Record &record, size_t group_index) const {
+    return record.stale_rows.empty() or
+           record.row_changed[record.stale_rows.back()] < record.row_evaluated[group_index];
+}
+
+void EnergyLedger::refreshRow(Energybase &term, Record &record, size_t group_index) {
+    Change::data changed_group; // without atom indices, i.e. nothing to allocate
+    changed_group.index = group_index;
+    changed_group.all = true;
+    row_change.clear();
+    row_change.addGroup(changed_group);
+    term.groupPairEnergies(row_change, record.trial_energy);
+    setRow(record, group_index, record.trial_energy);
+}
+
+/**
+ * @param index Index of the term in the Hamiltonian
+ * @param term Energy term
+ * @param change Ledger move
+ * @param group_index Index of the moved group; see `movedGroup()`
+ * @return Energy of the term due to the change
+ */
+double EnergyLedger::energy(size_t index, Energybase &term, Change &change, int group_index) {
+    auto &record = records.at(index);
+    const bool is_trial = term.key == Energybase::TRIAL_MONTE_CARLO_STATE;
+    const bool is_accepted = term.key == Energybase::ACCEPTED_MONTE_CARLO_STATE;
+    switch (record.locality) {
+    case Energybase::Locality::GROUP:
+        if (is_trial) {
+            record.trial_energy.assign(1, term.energy(change));
+            record.has_trial_energy = true;
+            return record.trial_energy.front();
+        } else if (is_accepted) {
+            if (record.group_is_valid[group_index]) {
+                lookups++;
+            } else {
+                record.group_energy[group_index] = term.energy(change);
+                record.group_is_valid[group_index] = true;
+            }
+            return record.group_energy[group_index];
+        }
+        break;
+    case Energybase::Locality::GROUP_PAIR:
+        if (is_trial) {
+            term.groupPairEnergies(change, record.trial_energy);
+            record.has_trial_energy = true;
+            return std::accumulate(record.trial_energy.begin(), record.trial_energy.end(), 0.0);
+        } else if (is_accepted) {
+            if (rowIsValid(record, group_index)) {
+                lookups++;
+            } else {
+                refreshRow(term, record, group_index);
+            }
+            auto &energy = record.row_energy[group_index];
+            if (not std::isfinite(energy)) { // the sum may have lost track of entries added or removed
+                energy = 0.0;
+                for (size_t j = 0; j < record.pair_energy.size(); j++) {
+                    if (j != static_cast<size_t>(group_index)) {
+                        energy += record.pair_energy(group_index, j);
+                    }
+                }
+            }
+            return energy;
+        }
+        break;
+    case Energybase::Locality::NONLOCAL:
+        break;
+    }
+    return term.energy(change);
+}
+
+/**
+ * Called after the terms of the Hamiltonian have been synchronised
+ *
+ * @param other Ledger of the state to synchronise with
+ * @param change Change of the current move
+ * @param key State of this ledger; the accepted state takes over the trial records of an accepted move
+ */
+void EnergyLedger::sync(EnergyLedger &other, Change &change, Energybase::keys key) {
+    assert(other.records.size() == records.size());
+    if (key == Energybase::ACCEPTED_MONTE_CARLO_STATE) { // move accepted
+        if (change.all or change.dV) {
+            invalidate();
+        } else {
+            const int moved_group = movedGroup(change);
+            for (size_t i = 0; i < records.size(); i++) {
+                auto &record = records[i];
+                auto &trial = other.records[i];
+                if (moved_group >= 0 and trial.has_trial_energy) {
+                    if (record.locality == Energybase::Locality::GROUP) {
+                        record.group_energy[moved_group] = trial.trial_energy.front();
+                        record.group_is_valid[moved_group] = true;
+                    } else if (record.locality == Energybase::Locality::GROUP_PAIR) {
+                        setRow(record, moved_group, trial.trial_energy);
+                    }
+                } else { // only the touched groups are affected
+                    for (const auto &changed_group : change.groups) {
+                        if (record.locality == Energybase::Locality::GROUP) {
+                            record.group_is_valid.at(changed_group.index) = false;
+                        } else if (record.locality == Energybase::Locality::GROUP_PAIR) {
+                            invalidateRow(record, changed_group.index);
+                        }
+                    }
+                }
+            }
+        }
+    }
+    for (auto ledger : {this, &other}) {
+        for (auto &record : ledger->records) {
+            record.has_trial_energy = false;
+        }
+    }
+}
+
+void EnergyLedger::to_json(json &j) const { j["lookups"] = lookups; }
+
+TEST_CASE("[Faunus] EnergyLedger") {
+    // energy of each group is stored in `values`; `evaluations` counts calls to energy()
+    struct GroupTerm : public Energybase {
+        std::vector<double> values = {1.0, 2.0, 3.0};
+        int evaluations = 0;
+        Locality locality() const override { return Locality::GROUP; }
+        double energy(Change &change) override {
+            evaluations++;
+            return values.at(change.groups.front().index);
+        }
+    };
+    // pair energy between groups i and j is stored in `values(i, j)`
+    struct PairTerm : public Energybase {
+        PairMatrix<double, true> values = PairMatrix<double, true>(3, 1.0);
+        int evaluations = 0;
+        Locality locality() const override { return Locality::GROUP_PAIR; }
+        double energy(Change &) override { return pc::infty; }
+        void groupPairEnergies(Change &change, std::vector<double> &energies) override {
+            evaluations++;
+            const size_t i = change.groups.front().index;
+            energies.resize(3);
+            for (size_t j = 0; j < 3; j++) {
+                energies[j] = (i == j) ? 0.0 : values(i, j);
+            }
+        }
+    };
+    GroupTerm accepted_group, trial_group;
+    PairTerm accepted_pair, trial_pair;
+    accepted_group.key = accepted_pair.key = Energybase::ACCEPTED_MONTE_CARLO_STATE;
+    trial_group.key = trial_pair.key = Energybase::TRIAL_MONTE_CARLO_STATE;
+    BasePointerVector<Energybase> accepted_terms, trial_terms;
+    accepted_terms.vec = {std::make_shared<GroupTerm>(), std::make_shared<PairTerm>()}; // defines the localities
+    trial_terms.vec = accepted_terms.vec;
+    EnergyLedger accepted(accepted_terms, 3), trial(trial_terms, 3);
+
+    Change change;
+    change.groups.resize(1);
+    change.groups[0].index = 1;
+    change.groups[0].all = true;
+    CHECK(EnergyLedger::movedGroup(change) == 1);
+
+    // move group 1
+    trial_group.values[1] = 5.0;
+    trial_pair.values.set(1, 0, 2.0);
+    CHECK(trial.energy(0, trial_group, change, 1) == doctest::Approx(5.0));
+    CHECK(trial.energy(1, trial_pair, change, 1) == doctest::Approx(3.0));
+    CHECK(accepted.energy(0, accepted_group, change, 1) == doctest::Approx(2.0));
+    CHECK(accepted.energy(1, accepted_pair, change, 1) == doctest::Approx(2.0));
+    CHECK(accepted_group.evaluations == 1);
+    CHECK(accepted_pair.evaluations == 1); // only the moved group is evaluated with all others
+
+    // accept and move group 1 again: the accepted state evaluates nothing
+    accepted.sync(trial, change, Energybase::ACCEPTED_MONTE_CARLO_STATE);
+    accepted_pair.values = trial_pair.values;
+    CHECK(accepted.energy(0, accepted_group, change, 1) == doctest::Approx(5.0));
+    CHECK(accepted.energy(1, accepted_pair, change, 1) == doctest::Approx(3.0));
+    CHECK(accepted_group.evaluations == 1);
+    CHECK(accepted_pair.evaluations == 1);
+
+    // group 0 is evaluated once and feels the accepted move of group 1
+    change.groups[0].index = 0;
+    CHECK(accepted.energy(1, accepted_pair, change, 0) == doctest::Approx(3.0));
+    CHECK(accepted.energy(1, accepted_pair, change, 0) == doctest::Approx(3.0));
+    CHECK(accepted_pair.evaluations == 2);
+
+    // an internal move of group 0 is not a ledger move and invalidates only pairs with group 0
+    change.groups[0].internal = true;
+    CHECK(EnergyLedger::movedGroup(change) == -1);
+    accepted.sync(trial, change, Energybase::ACCEPTED_MONTE_CARLO_STATE);
+    change.groups[0].internal = false;
+    accepted_pair.values.set(0, 1, 4.0);
+    CHECK(accepted.energy(1, accepted_pair, change, 0) == doctest::Approx(5.0));
+    CHECK(accepted_pair.evaluations == 3);
+    change.groups[0].index = 1; // the row of group 1 holds the re-evaluated pair with group 0
+    CHECK(accepted.energy(1, accepted_pair, change, 1) == doctest::Approx(5.0));
+    CHECK(accepted_pair.evaluations == 3);
+    change.groups[0].index = 2; // never evaluated
+    CHECK(accepted.energy(1, accepted_pair, change, 2) == doctest::Approx(2.0));
+    CHECK(accepted_pair.evaluations == 4);
+
+    change.dV = true;
+    CHECK(EnergyLedger::movedGroup(change) == -1);
+}
+
+TEST_CASE("[Faunus] EnergyLedger in Hamiltonian") {
+    using doctest::Approx;
+    atoms = R"([{ "A": { "q": 1.0, "sigma": 2.0, "eps": 0.5 } },
+                { "B": { "q": -1.0, "sigma": 3.0, "eps": 0.5 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "dimer": { "structure": [{"A": [0.0, 0.0, 0.0]}, {"B": [2.5, 0.0, 0.0]}] } }])"_json
+                    .get<decltype(molecules)>();
+    const json energy = R"([
+        {"nonbonded": {"default": [{"coulomb": {"epsr": 80, "type": "plain"}}, {"wca": {"mixing": "LB"}}]}},
+        {"customexternal": {"molecules": ["dimer"], "function": "0.01 * (x^2 + y^2)"}}])"_json;
+    json energy_with_ledger = energy;
+    energy_with_ledger.push_back(R"({"ledger": true})"_json);
+
+    Space accepted_spc, trial_spc; // both Hamiltonians of a state act on the same Space
+    for (auto spc : {&accepted_spc, &trial_spc}) {
+        spc->geo = R"( {"type": "cuboid", "length": 30} )"_json;
+        for (int i = 0; i < 8; i++) { // dimers on the corners of a cube
+            const Point position = 6.0 * Point(i % 2, (i / 2) % 2, i / 4);
+            const ParticleVector particles = {Particle(atoms[0], position),
+                                              Particle(atoms[1], position + Point(2.5, 0.0, 0.0))};
+            spc->push_back(molecules.front().id(), particles);
+        }
+        Change change_all;
+        change_all.all = true;
+        spc->updateParticleArrays(change_all);
+    }
+    Hamiltonian accepted(accepted_spc, energy), trial(trial_spc, energy);
+    Hamiltonian accepted_ledger(accepted_spc, energy_with_ledger), trial_ledger(trial_spc, energy_with_ledger);
+    accepted.key = accepted_ledger.key = Energybase::ACCEPTED_MONTE_CARLO_STATE;
+    trial.key = trial_ledger.key = Energybase::TRIAL_MONTE_CARLO_STATE;
+    for (auto pot : {&accepted, &trial, &accepted_ledger, &trial_ledger}) {
+        pot->init();
+    }
+
+    // translate a random dimer; every third move is rejected so that groups are moved again after rejection
+    Random slump;
+    slump.engine.seed(5);
+    Change change;
+    change.groups.resize(1);
+    change.groups[0].all = true;
+    for (int step = 0; step < 60; step++) {
+        change.groups[0].index = slump.range<int>(0, trial_spc.groups.size() - 1);
+        const Point displacement = 4.0 * Point(slump() - 0.5, slump() - 0.5, slump() - 0.5);
+        trial_spc.groups[change.groups[0].index].translate(displacement, trial_spc.geo.getBoundaryFunc());
+        trial_spc.updateParticleArrays(change);
+        const double energy_change = trial.energy(change) - accepted.energy(change);
+        const double ledger_energy_change = trial_ledger.energy(change) - accepted_ledger.energy(change);
+        CHECK(ledger_energy_change == Approx(energy_change));
+        if (step % 3 == 0) { // reject
+            trial_spc.sync(accepted_spc, change);
+            trial.sync(&accepted, change);
+            trial_ledger.sync(&accepted_ledger, change);
+        } else { // accept
+            accepted_spc.sync(trial_spc, change);
+            accepted.sync(&trial, change);
+            accepted_ledger.sync(&trial_ledger, change);
+        }
+    }
+    Change change_all;
+    change_all.all = true;
+    CHECK(accepted_ledger.energy(change_all) == Approx(accepted.energy(change_all)));
+}
+
 #ifdef ENABLE_FREESASA
 
 SASAEnergy::SASAEnergy(Space &spc, double cosolute_concentration, double probe_radius)
@@ -1143,6 +2943,18 @@ void from_json(const json &j, GroupCutoff &cutoff) {
             }
         }
     }
+
+    // frozen molecules interact with the mobile molecules through FrozenGrid only
+    if (auto frozen = j.find("frozen"); frozen != j.end()) {
+        const auto frozen_ids = names2ids(Faunus::molecules, frozen->get<std::vector<std::string>>());
+        for (auto &molecule : Faunus::molecules) {
+            if (std::find(frozen_ids.begin(), frozen_ids.end(), molecule.id()) == frozen_ids.end()) {
+                for (auto frozen_id : frozen_ids) {
+                    cutoff.cutoff_squared.set(frozen_id, molecule.id(), GroupCutoff::excluded);
+                }
+            }
+        }
+    }
 }
 
 void to_json(json &j, const GroupCutoff &cutoff) {
@@ -1152,7 +2964,7 @@ void to_json(json &j, const GroupCutoff &cutoff) {
             if (a.id() >= b.id()) {
                 if (not a.atomic && not b.atomic) {
                     auto cutoff_squared = cutoff.cutoff_squared(a.id(), b.id());
-                    if (cutoff_squared < pc::max_value) {
+                    if (cutoff_squared != GroupCutoff::excluded && cutoff_squared < pc::max_value) {
                         _j[a.name + " " + b.name] = std::sqrt(cutoff_squared);
                     }
                 }
@@ -1164,5 +2976,154 @@ void to_json(json &j, const GroupCutoff &cutoff) {
     }
 }
 
+//==================== MultipoleFarField ====================
+
+MultipoleFarField::MultipoleFarField(Space::Tgeometry &geometry) : geometry(geometry) {}
+
+void MultipoleFarField::resize(size_t number_of_groups) {
+    if (moments.size() != number_of_groups) {
+        moments.resize(number_of_groups);
+        is_valid.resize(number_of_groups, false);
+    }
+}
+
+void MultipoleFarField::invalidate(const Change &change) {
+    if (change.all || change.dV) {
+        invalidate();
+    } else {
+        for (const auto &group_change : change.groups) {
+            if (static_cast<size_t>(group_change.index) < is_valid.size()) {
+                is_valid[group_change.index] = false;
+            }
+        }
+    }
+}
+
+double MultipoleFarField::energy(const Moments &a, const Moments &b, const Point &r) const {
+    const double u_ion_ion = a.charge * b.charge / r.norm();
+    const double u_ion_dipole = q2mu(a.charge, b.dipole, b.charge, a.dipole, r);
+    const double u_dipole_dipole = mu2mu(a.dipole, b.dipole, 1.0, r);
+    const double u_ion_quadrupole = q2quad(a.charge, b.quadrupole, b.charge, a.quadrupole, r);
+    return bjerrum_length * (u_ion_ion + u_ion_dipole + u_dipole_dipole + u_ion_quadrupole);
+}
+
+void from_json(const json &j, MultipoleFarField &far_field) {
+    auto it = j.find("multipole_g2g");
+    if (it == j.end()) {
+        return;
+    }
+    far_field.bjerrum_length = pc::bjerrumLength(it->at("epsr").get<double>());
+    const auto is_rigid_molecule = [](const MoleculeData &molecule) { return molecule.rigid && !molecule.atomic; };
+    const double default_switching_squared = std::pow(it->value("default", pc::infty), 2);
+    for (auto &a : Faunus::molecules) {
+        for (auto &b : Faunus::molecules) {
+            far_field.switching_squared.set(a.id(), b.id(),
+                                            is_rigid_molecule(a) && is_rigid_molecule(b) ? default_switching_squared
+                                                                                         : pc::infty);
+        }
+    }
+    // loop for space separated molecule pairs in keys
+    for (auto &[key, value] : it->items()) {
+        if (key == "default" || key == "epsr") {
+            continue;
+        }
+        const auto molecule_names = words2vec<std::string>(key);
+        if (molecule_names.size() != 2) {
+            throw ConfigurationError("multipole_g2g: invalid molecule pair '{}'", key);
+        }
+        const auto &molecule1 = *obtainName(Faunus::molecules, molecule_names[0]);
+        const auto &molecule2 = *obtainName(Faunus::molecules, molecule_names[1]);
+        if (!is_rigid_molecule(molecule1) || !is_rigid_molecule(molecule2)) {
+            throw ConfigurationError("multipole_g2g: '{}' must be rigid molecules", key);
+        }
+        far_field.switching_squared.set(molecule1.id(), molecule2.id(), std::pow(value.get<double>(), 2));
+    }
+}
+
+void to_json(json &j, const MultipoleFarField &far_field) {
+    if (!far_field.enabled()) {
+        return;
+    }
+    auto _j = json::object();
+    _j["epsr"] = pc::relativeDielectricFromBjerrumLength(far_field.bjerrum_length);
+    for (auto &a : Faunus::molecules) {
+        for (auto &b : Faunus::molecules) {
+            if (a.id() >= b.id()) {
+                const double switching_squared = far_field.switching_squared(a.id(), b.id());
+                if (switching_squared < pc::infty) {
+                    _j[a.name + " " + b.name] = std::sqrt(switching_squared);
+                }
+            }
+        }
+    }
+    j["multipole_g2g"] = _j;
+}
+
+TEST_CASE("[Faunus] MultipoleFarField") {
+    using doctest::Approx;
+    atoms = R"([{ "A": { "q": -1.3 } }, { "B": { "q": 0.8 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "M": { "rigid": true, "structure": [{"A": [0.0, 0.0, 0.0]}, {"B": [2.0, 1.0, 0.0]},
+                                                         {"B": [-1.0, 1.5, 0.5]}] } },
+                    { "salt": { "atoms": ["B"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    const std::vector<Point> structure = {{0.0, 0.0, 0.0}, {2.0, 1.0, 0.0}, {-1.0, 1.5, 0.5}};
+    const Point mass_center = {0.3, 0.8, 0.2};
+    Space spc;
+    spc.geo = R"( {"type": "cuboid", "length": 1000} )"_json;
+    spc.p.resize(6);
+    for (int id : {0, 1}) {
+        Group<Particle> group(spc.p.begin() + 3 * id, spc.p.begin() + 3 * id + 3);
+        group.id = 0;
+        spc.groups.push_back(group);
+    }
+    auto place = [&](int group_index, const Point &shift, double angle) { // rigid body placement
+        const Eigen::Matrix3d rotation = Eigen::AngleAxisd(angle, Point(1.0, 2.0, 3.0).normalized()).toRotationMatrix();
+        auto &group = spc.groups[group_index];
+        for (size_t i = 0; i < structure.size(); ++i) {
+            group[i] = atoms[i == 0 ? 0 : 1];
+            group[i].pos = rotation * structure[i] + shift;
+        }
+        group.cm = rotation * mass_center + shift;
+    };
+    place(0, {0.0, 0.0, 0.0}, 0.0);
+
+    typedef PairEnergy<Potential::FunctorPotential, true> TPairEnergy;
+    json j = R"({"default": [{"coulomb": {"epsr": 80, "type": "plain"}}]})"_json;
+    BasePointerVector<Energybase> potentials;
+    Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>> exact(j, spc, potentials);
+    j["multipole_g2g"] = {{"epsr", 80.0}, {"default", 30.0}};
+    Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>> multipole(j, spc, potentials);
+
+    Change change;
+    change.all = true;
+    place(1, {6.0, 8.0, 0.0}, 1.1); // closer than the switching distance
+    CHECK(multipole.energy(change) == Approx(exact.energy(change)));
+    place(1, {48.0, 64.0, 0.0}, 1.1);
+    CHECK(multipole.energy(change) != exact.energy(change));
+    CHECK(multipole.energy(change) == Approx(exact.energy(change)).epsilon(1e-3));
+
+    // the cached moments follow a rigid body rotation of the changed group
+    change.clear();
+    change.groups.resize(1);
+    change.groups[0].index = 1;
+    change.groups[0].all = true;
+    place(1, {48.0, 64.0, 0.0}, 2.3);
+    CHECK(multipole.energy(change) == Approx(exact.energy(change)).epsilon(1e-3));
+
+    j["multipole_g2g"]["M salt"] = 20.0; // only rigid molecules
+    CHECK_THROWS(Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>>(j, spc, potentials));
+    j["multipole_g2g"].erase("M salt");
+
+    // the far field assumes plain Coulomb with the same dielectric constant as the pair potential
+    j["multipole_g2g"]["epsr"] = 40.0;
+    CHECK_THROWS_AS(Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>>(j, spc, potentials), ConfigurationError);
+    j["multipole_g2g"]["epsr"] = 80.0;
+    j["default"] = R"([{"coulomb": {"epsr": 80, "type": "yukawa", "debyelength": 100}}])"_json;
+    CHECK_THROWS_AS(Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>>(j, spc, potentials), ConfigurationError);
+    j["default"] = R"([{"coulomb": {"epsr": 80, "type": "qpotential", "cutoff": 50, "order": 4}}])"_json;
+    CHECK_THROWS_AS(Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>>(j, spc, potentials), ConfigurationError);
+    j["default"] = R"([{"coulomb": {"epsr": 80, "type": "plain"}}, {"wca": {"mixing": "LB"}}])"_json;
+    CHECK_NOTHROW(Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>>(j, spc, potentials));
+}
+
 } // end of namespace Energy
 } // end of namespace Faunus
@@ -5,11 +5,14 @@
 #include "space.h"
 #include "aux/iteratorsupport.h"
 #include "aux/pairmatrix.h"
+#include "celllist.h"
+#include "multipole.h"
 #include <range/v3/view.hpp>
 #include <Eigen/Dense>
 #include <spdlog/spdlog.h>
 #include <numeric>
 #include <algorithm>
+#include <optional>
 
 #ifdef ENABLE_FREESASA
 #include <freesasa.h>
@@ -27,6 +30,7 @@ struct ReactionCoordinateBase;
 
 namespace Potential {
 struct PairPotentialBase;
+class SplinedPotential;
 }
 
 /**
@@ -62,13 +66,15 @@ struct ContainerOverlap : public Energybase {
     const Space &spc;
     ContainerOverlap(const Space &spc) : spc(spc) { name = "ContainerOverlap"; }
     double energy(Change &change) override;
+    Locality locality() const override { return Locality::GROUP; }
 };
 
 /**
  * @brief Data class for Ewald k-space calculations
  *
  * Currently, the Eigen policies map to the non-eigen
- * variants, e.g. `PBCEigen == PBC`.
+ * variants, e.g. `PBCEigen == PBC`. `SPME` is not a k-space policy
+ * but selects the `ParticleMeshEwald` energy term.
  *
  * Related reading:
  * - PBC Ewald (DOI:10.1063/1.481216)
@@ -92,7 +98,7 @@ struct EwaldData {
     bool use_spherical_sum = true;
     int num_kvectors = 0;
     Point box_length = {0.0, 0.0, 0.0};                        //!< Box dimensions
-    enum Policies { PBC, PBCEigen, IPBC, IPBCEigen, INVALID }; //!< Possible k-space updating schemes
+    enum Policies { PBC, PBCEigen, PBCRecurrence, IPBC, IPBCEigen, SPME, INVALID }; //!< Possible k-space updating schemes
     Policies policy = PBC;                                     //!< Policy for updating k-space
     EwaldData(const json &);                                   //!< Initialize from json
 };
@@ -101,8 +107,10 @@ NLOHMANN_JSON_SERIALIZE_ENUM(EwaldData::Policies, {
                                                       {EwaldData::INVALID, nullptr},
                                                       {EwaldData::PBC, "PBC"},
                                                       {EwaldData::PBCEigen, "PBCEigen"},
+                                                      {EwaldData::PBCRecurrence, "PBCRecurrence"},
                                                       {EwaldData::IPBC, "IPBC"},
                                                       {EwaldData::IPBCEigen, "IPBCEigen"},
+                                                      {EwaldData::SPME, "SPME"},
                                                   })
 
 void to_json(json &, const EwaldData &);
@@ -110,6 +118,8 @@ void to_json(json &, const EwaldData &);
 /**
  * @brief Base class for Ewald k-space updates policies
  */
+struct EwaldSources; // signed charges and their positions, see energy.cpp
+
 class EwaldPolicyBase {
   public:
     std::string cite; //!< Optional reference, preferably DOI, to further information
@@ -119,6 +129,7 @@ class EwaldPolicyBase {
                                Space::Tgvec &) const = 0; //!< Update all k vectors
     virtual void updateComplex(EwaldData &, Change &, Space::Tgvec &,
                                Space::Tgvec &) const = 0; //!< Update subset of k vectors. Require `old` pointer
+    virtual void addSources(EwaldData &, const EwaldSources &) const = 0; //!< Add charges to the k vectors
     virtual double selfEnergy(const EwaldData &, Change &,
                               Space::Tgvec &) = 0; //!< Self energy contribution due to a change
     virtual double surfaceEnergy(const EwaldData &, Change &,
@@ -128,21 +139,25 @@ class EwaldPolicyBase {
     /**
      * @brief Represent charges and positions using an Eigen facade (Map)
      *
-     * Requires that all groups are fully active, i.e. does not work for GCMC.
+     * Positions are mapped for all particles including the inactive ones at the end of
+     * each group. Charges are copied and inactive particles are given zero charge
+     * such that they do not contribute, i.e. this works also for GCMC.
      *
      * @param groups Vector of groups to represent
-     * @return tuple with positions, charges
+     * @return tuple with positions (N x 3 map), charges (N x 1 array)
      */
     auto mapGroupsToEigen(Space::Tgvec &groups) const {
-        for (auto &g : groups)
-            if (g.size() != g.capacity())
-                throw std::runtime_error("Eigen optimized Ewald not available with inactive groups");
         auto first_particle = groups.front().begin();
-        auto last_particle = groups.back().end();
+        auto last_particle = groups.back().trueend();
         auto pos = asEigenMatrix(first_particle, last_particle,
                                  &Space::Tparticle::pos); // N x 3
-        auto charge = asEigenVector(first_particle, last_particle,
-                                    &Space::Tparticle::charge); // N x 1
+        Eigen::ArrayXd charge = asEigenVector(first_particle, last_particle,
+                                              &Space::Tparticle::charge); // N x 1
+        for (auto &group : groups) {
+            if (group.size() != group.capacity()) { // mask inactive particles
+                charge.segment(std::distance(first_particle, group.end()), group.capacity() - group.size()).setZero();
+            }
+        }
         return std::make_tuple(pos, charge);
     }
 
@@ -157,6 +172,7 @@ struct PolicyIonIon : public EwaldPolicyBase {
     void updateBox(EwaldData &, const Point &) const override;
     void updateComplex(EwaldData &, Space::Tgvec &) const override;
     void updateComplex(EwaldData &, Change &, Space::Tgvec &, Space::Tgvec &) const override;
+    void addSources(EwaldData &, const EwaldSources &) const override;
     double selfEnergy(const EwaldData &, Change &, Space::Tgvec &) override;
     double surfaceEnergy(const EwaldData &, Change &, Space::Tgvec &) override;
     double reciprocalEnergy(const EwaldData &) override;
@@ -165,8 +181,9 @@ struct PolicyIonIon : public EwaldPolicyBase {
 /**
  * @brief Ion-Ion Ewald with periodic boundary conditions (PBC) using Eigen
  * operations
- * @warning Will not work with Space with inactive particles (GCMC, for example)
  *
+ * Inactive particles are masked by zero charge and partial updates are done
+ * for the changed particles only.
  * For compilers that offer good vectorization (gcc on linux) this brings a 4-5
  * fold speed increase.
  * Status on February, 2020:
@@ -174,11 +191,24 @@ struct PolicyIonIon : public EwaldPolicyBase {
  * - GCC9: Eigen is 4-5 times faster on x86 linux; ~1.5 times *lower on macos.
  */
 struct PolicyIonIonEigen : public PolicyIonIon {
-    using PolicyIonIon::updateComplex;
     void updateComplex(EwaldData &, Space::Tgvec &) const override;
+    void updateComplex(EwaldData &, Change &, Space::Tgvec &, Space::Tgvec &) const override;
+    void addSources(EwaldData &, const EwaldSources &) const override;
     double reciprocalEnergy(const EwaldData &) override;
 };
 
+/**
+ * @brief Ion-Ion Ewald with periodic boundary conditions (PBC) using trigonometric recurrences
+ *
+ * The phase factors `exp(i k·r)` are assembled from per-axis powers of `exp(i 2π r_a / L_a)` rather
+ * than from a `sin`/`cos` pair for every particle and k-vector. Works also with inactive particles.
+ */
+struct PolicyIonIonRecurrence : public PolicyIonIon {
+    void updateComplex(EwaldData &, Space::Tgvec &) const override;
+    void updateComplex(EwaldData &, Change &, Space::Tgvec &, Space::Tgvec &) const override;
+    void addSources(EwaldData &, const EwaldSources &) const override;
+};
+
 /**
  * @brief Ion-Ion Ewald with isotropic periodic boundary conditions (IPBC)
  */
@@ -188,15 +218,16 @@ struct PolicyIonIonIPBC : public PolicyIonIon {
     void updateBox(EwaldData &, const Point &) const override;
     void updateComplex(EwaldData &, Space::Tgvec &) const override;
     void updateComplex(EwaldData &, Change &, Space::Tgvec &, Space::Tgvec &) const override;
+    void addSources(EwaldData &, const EwaldSources &) const override;
 };
 
 /**
  * @brief Ion-Ion Ewald with isotropic periodic boundary conditions (IPBC) using Eigen operations
- * @warning Incomplete and under construction
  */
 struct PolicyIonIonIPBCEigen : public PolicyIonIonIPBC {
-    using PolicyIonIonIPBC::updateComplex;
     void updateComplex(EwaldData &, Space::Tgvec &) const override;
+    void updateComplex(EwaldData &, Change &, Space::Tgvec &, Space::Tgvec &) const override;
+    void addSources(EwaldData &, const EwaldSources &) const override;
 };
 
 /** @brief Ewald summation reciprocal energy */
@@ -206,6 +237,7 @@ class Ewald : public Energybase {
     std::shared_ptr<EwaldPolicyBase> policy; //!< Policy for updating k-space
     Space &spc;
     Space::Tgvec *old_groups = nullptr;
+    std::vector<std::pair<size_t, const Particle *>> committed_particles; //!< Journal records if `spc` is shared
 
   public:
     Ewald(const json &, Space &);
@@ -218,6 +250,62 @@ class Ewald : public Energybase {
     void force(std::vector<Point> &) override; // update forces on all particles
 };
 
+/**
+ * @brief Smooth particle-mesh Ewald (SPME) reciprocal and surface energy
+ *
+ * Charges are spread onto a periodic mesh, Q, using cardinal B-splines and the
+ * reciprocal energy is obtained by fast Fourier transforms in O(M log M) operations,
+ * M being the number of mesh points. For moves that touch only a few particles, the
+ * energy change is instead evaluated from the sparse change in mesh charge, dQ, and the
+ * mesh potential, phi = theta * Q, where theta is the influence function in real space:
+ *
+ *     dU = sum_a dQ_a ( 2 phi_a + sum_b theta_(a-b) dQ_b )
+ *
+ * Accepted mesh charge changes are not transformed right away but added to the mesh potential
+ * on the fly, phi_a = (theta * Q_old)_a + sum_b theta_(a-b) dQ_b, until this becomes more expensive
+ * than a full transform. The mesh size must be a power of two in each dimension.
+ * Forces are currently not implemented.
+ *
+ * Related reading:
+ * - SPME (doi:10.1063/1.470117)
+ */
+class ParticleMeshEwald : public Energybase {
+  private:
+    static constexpr int max_spline_order = 12;
+    EwaldData data;
+    PolicyIonIon surface_policy; //!< The surface energy is the same as for ordinary Ewald
+    Space &spc;
+    Space::Tgvec *old_groups = nullptr;
+    std::vector<std::pair<size_t, const Particle *>> committed_particles; //!< Journal records if `spc` is shared
+    int spline_order = 6;                          //!< B-spline order, i.e. mesh points per dimension for each charge
+    Eigen::Vector3i mesh_size = {0, 0, 0};         //!< Number of mesh points in each dimension
+    std::vector<double> influence;                 //!< Influence function in reciprocal space
+    std::vector<double> kernel;                    //!< Influence function in real space, theta
+    std::vector<double> charge_mesh;               //!< Spread charges, Q
+    std::vector<double> potential_mesh;            //!< Mesh potential, theta * Q, excluding `pending` and `unapplied`
+    std::vector<std::pair<int, double>> pending;   //!< Mesh charge changes of current trial move
+    std::vector<std::pair<int, double>> unapplied; //!< Accepted mesh charge changes missing in `potential_mesh`
+    double reciprocal_energy = 0;                  //!< Reciprocal energy of `charge_mesh` (kT)
+    bool potential_is_stale = true;                //!< True if `potential_mesh` must be recomputed from `charge_mesh`
+    bool mesh_is_rebuilt = false;                  //!< True if the current trial move spread all charges
+
+    int meshIndex(int i, int j, int k) const { return (i * mesh_size[1] + j) * mesh_size[2] + k; }
+    template <typename Tfunction> void spread(const Particle &, double sign, Tfunction) const;
+    void updateMesh(const Point &);           //!< Influence function and kernel for given box
+    void updatePotential();                   //!< Energy and mesh potential from `charge_mesh`
+    void rebuild();                           //!< Spread all charges and update energy and mesh potential
+    double energyChange() const;              //!< Energy change due to `pending`
+    double kernelBetween(int a, int b) const; //!< Real-space kernel between two mesh points
+    double transformCost() const;             //!< Estimated number of operations of a full mesh transform
+
+  public:
+    ParticleMeshEwald(const json &, Space &);
+    void init() override;
+    double energy(Change &) override;
+    void sync(Energybase *, Change &) override;
+    void to_json(json &) const override;
+};
+
 class Isobaric : public Energybase {
   private:
     Space &spc;
@@ -244,6 +332,38 @@ class Constrain : public Energybase {
     void to_json(json &) const override;
 };
 
+/**
+ * @brief Pair interactions with frozen molecules from precomputed potential grids
+ *
+ * For each atom type, the pair potential from all particles in the frozen molecules is
+ * sampled on a regular grid spanning the simulation container. The energy of the remaining,
+ * mobile particles is then obtained by trilinear interpolation, i.e. at a cost independent
+ * of the number of frozen particles. Node energies are clamped to `[-u_max, u_max]`.
+ *
+ * Frozen molecules must not be moved or changed and the volume must be constant. The pairs
+ * between frozen and mobile molecules are excluded from all nonbonded terms in the Hamiltonian,
+ * see `GroupCutoff`.
+ */
+class FrozenGrid : public Energybase {
+  private:
+    typedef Tabulate::Grid3D<double> Grid;
+    Space &spc;
+    Grid grid;
+    std::vector<Grid::data> potentials;   //!< potential grid for each atom type; empty if not needed
+    std::vector<bool> is_frozen;          //!< true for frozen molecule ids
+    std::vector<std::string> names;       //!< names of frozen molecules
+    Point box;                            //!< container side lengths when sampling the grids
+    double spacing;                       //!< maximum distance between nodes
+    double u_max;                         //!< maximum absolute energy at a node
+    double particleEnergy(const Particle &particle) const;
+
+  public:
+    FrozenGrid(const json &, Space &);
+    double energy(Change &) override;
+    void to_json(json &) const override;
+    Locality locality() const override { return Locality::GROUP; }
+};
+
 /*
  * The keys of the `intra` map are group index and the values
  * is a vector of `BondData`. For bonds between groups, fill
@@ -259,51 +379,41 @@ class Bonded : public Energybase {
     BondVector inter;                // inter-molecular bonds
     std::map<int, BondVector> intra; // intra-molecular bonds; key is group index
 
-  private:
-    void update_intra();                              // finds and adds all intra-molecular bonds of active molecules
-    double sum_energy(const BondVector &) const;      // sum energy in vector of BondData
-
     /**
-     * @brief Sum energy in vector of BondData for matching particle indices
-     * @param bonds List of bonds
-     * @param indices_of_particles Particle index
+     * @brief Compressed sparse row (CSR) index of the bonds of each particle
      *
-     * To speed up the bond search, the given indices must be ordered which allows
-     * for binary search which on large systems provides superior performance compared
-     * to simplistic search which scales as number_of_bonds x number_of_moved_particles
+     * The bonds of particle `i` are stored contiguously in `bonds[offsets[i]]...bonds[offsets[i+1]-1]`
+     * such that the bonds of a moved particle are found without scanning all bonds.
      */
-    template <class RangeOfIndex>
-    double sum_energy(const Bonded::BondVector &bonds, const RangeOfIndex &indices_of_particles) const {
-        assert(std::is_sorted(indices_of_particles.begin(), indices_of_particles.end()));
-
-        auto bond_filter = [&](const auto &bond_ptr) { // determine if bond is part of indices of particles
-            for (auto index : bond_ptr->index) {
-                if (std::binary_search(indices_of_particles.begin(), indices_of_particles.end(), index)) {
-                    return true;
-                }
-            }
-            return false;
-        };
-        auto affected_bonds = bonds | ranges::cpp20::views::filter(bond_filter);
+    struct BondIndex {
+        std::vector<size_t> offsets;                    //!< first bond of each particle; size is particles + 1
+        std::vector<const Potential::BondData *> bonds; //!< bonds ordered by particle index
+        void build(const std::vector<const BondVector *> &, size_t); //!< Index all bonds for given particle count
+        size_t size() const { return offsets.empty() ? 0 : offsets.size() - 1; } //!< Number of indexed particles
+        auto operator[](size_t particle_index) const {
+            assert(particle_index + 1 < offsets.size());
+            return ranges::make_subrange(bonds.begin() + offsets[particle_index],
+                                         bonds.begin() + offsets[particle_index + 1]);
+        } //!< Bonds of the given particle
+    };
+    BondIndex inter_index;    // bonds in `inter` of each particle
+    BondIndex intra_index;    // bonds in `intra` of each particle
+    std::vector<int> touched; // sorted, absolute index of changed particles; reused between calls
+    Potential::BondTables inter_tables;                // `inter` sorted by bond type
+    std::map<int, Potential::BondTables> intra_tables; // `intra` sorted by bond type; key is group index
 
-        auto bond_energy = [&](const auto &bond_ptr) { return bond_ptr->energyFunc(spc.geo.getDistanceFunc()); };
-
-#if (defined(__clang__) && __clang_major__ >= 10) || (defined(__GNUC__) && __GNUC__ >= 10)
-        return std::transform_reduce(affected_bonds.begin(), affected_bonds.end(), 0.0, std::plus<>(), bond_energy);
-#else
-        double energy = 0.0;
-        for (const auto &bond_ptr : affected_bonds) {
-            energy += bond_energy(bond_ptr);
-        }
-        return energy;
-#endif
-    }
+  private:
+    void update_intra();                              // finds and adds all intra-molecular bonds of active molecules
+    void updateBondIndex();                           // rebuilds the particle-to-bond index
+    void updateBondTables();                          // rebuilds the bond tables from `inter` and `intra`
+    double sum_energy(const BondIndex &) const;       // sum energy of the bonds of touched particles
 
   public:
     Bonded(const json &, Space &);
     void to_json(json &) const override;
-    double energy(Change &) override;          //!< brute force -- refine this!
+    double energy(Change &) override;          //!< Energy of the bonds of changed particles
     void force(std::vector<Point> &) override; //!< Calculates the forces on all particles
+    Locality locality() const override;        //!< `GROUP` unless there are inter-molecular bonds
 };
 
 /**
@@ -327,11 +437,13 @@ template <typename TSize, typename TSet> inline auto indexComplement(const TSize
  * @brief Determines if two groups are separated beyond the cutoff distance.
  *
  * The distance between centers of mass is considered. The cutoff distance can be specified independently for each
- * group pair to override the default value.
+ * group pair to override the default value. Molecules listed in `frozen` are never paired with other molecules
+ * as these interactions are handled by `FrozenGrid`.
  *
  * @see PairEnergy
  */
 class GroupCutoff {
+    static constexpr double excluded = -1.0; //!< cutoff squared for group pairs that are never paired
     double default_cutoff_squared = pc::max_value;
     PairMatrix<double> cutoff_squared;  //!< matrix with group-to-group cutoff distances squared in angstrom squared
     double total_cnt = 0, skip_cnt = 0; //!< statistics
@@ -345,16 +457,35 @@ class GroupCutoff {
      * @return true if the group-to-group distance is beyond the cutoff distance, false otherwise
      */
     template <typename TGroup> inline bool cut(const TGroup &group1, const TGroup &group2) {
-        bool result = false;
         ++total_cnt;
-        if (!group1.atomic && !group2.atomic // atomic groups have no meaningful cm
-            && geometry.sqdist(group1.cm, group2.cm) >= cutoff_squared(group1.id, group2.id)) {
-            result = true;
+        const bool result = isBeyond(group1, group2);
+        if (result) {
             ++skip_cnt;
         }
         return result;
     }
 
+    /**
+     * @brief Same as cut() but without touching the statistics, hence safe to call from concurrent threads.
+     * @return true if the group-to-group distance is beyond the cutoff distance, false otherwise
+     * @see addStatistics()
+     */
+    template <typename TGroup> inline bool isBeyond(const TGroup &group1, const TGroup &group2) const {
+        const double cutoff2 = cutoff_squared(group1.id, group2.id);
+        return cutoff2 == excluded || (!group1.atomic && !group2.atomic // atomic groups have no meaningful cm
+                                       && geometry.sqdist(group1.cm, group2.cm) >= cutoff2);
+    }
+
+    /**
+     * @brief Adds externally collected statistics, e.g., from a parallel region using isBeyond().
+     * @param total  number of tested group pairs
+     * @param skipped  number of group pairs beyond the cutoff distance
+     */
+    inline void addStatistics(double total, double skipped) {
+        total_cnt += total;
+        skip_cnt += skipped;
+    }
+
     /**
      * @brief A functor alias for cut().
      * @see cut()
@@ -371,6 +502,133 @@ class GroupCutoff {
 void from_json(const json&, GroupCutoff &);
 void to_json(json&, const GroupCutoff &);
 
+/**
+ * @brief Far-field multipole approximation of the interaction between two rigid molecules.
+ *
+ * If the distance between the mass centers is greater or equal to the switching distance, the sum over all
+ * particle pairs is replaced by the electrostatic interaction between the monopole, dipole and quadrupole
+ * moments of the two molecules, i.e., by the ion-ion, ion-dipole, dipole-dipole and ion-quadrupole terms. The
+ * omitted terms decay as r^-4 or faster, and so does any short-ranged pair potential which is ignored altogether.
+ * Hence the pair potential has to be plain Coulomb at the switching distance with the given dielectric constant,
+ * see PairingBasePolicy::checkFarField().
+ *
+ * The switching distance can be specified independently for each pair of rigid molecules to override the default
+ * value. Moments of a group are computed with respect to its mass center when first needed and kept until the
+ * group is touched by a change, i.e., they are cached per conformation and orientation of the rigid body.
+ *
+ * @see GroupCutoff, PairingBasePolicy
+ */
+class MultipoleFarField {
+  public:
+    struct Moments {
+        double charge = 0.0;                   //!< monopole moment
+        Point dipole = {0.0, 0.0, 0.0};        //!< dipole moment
+        Tensor quadrupole;                     //!< quadrupole moment (with trace)
+    };
+
+  private:
+    double bjerrum_length = 0.0;         //!< zero if disabled
+    PairMatrix<double> switching_squared; //!< switching distance squared between molecule ids in angstrom squared
+    std::vector<Moments> moments;         //!< cached moments for each group in space
+    std::vector<bool> is_valid;           //!< true if the cached moments of the group are up to date
+    Space::Tgeometry &geometry;           //!< geometry to compute the inter group distance with
+    friend void from_json(const json &, MultipoleFarField &);
+    friend void to_json(json &, const MultipoleFarField &);
+
+  public:
+    MultipoleFarField(Space::Tgeometry &geometry);
+
+    inline bool enabled() const { return bjerrum_length > 0.0; }
+
+    //! Switching distance between two molecule types; infinite if the far field does not apply
+    inline double switchingDistance(int molid1, int molid2) const {
+        return std::sqrt(switching_squared(molid1, molid2));
+    }
+
+    /**
+     * @brief Determines if the groups are separated beyond the switching distance.
+     */
+    template <typename TGroup> inline bool isFar(const TGroup &group1, const TGroup &group2) const {
+        return enabled() && !group1.atomic && !group2.atomic // atomic groups have no meaningful cm
+               && geometry.sqdist(group1.cm, group2.cm) >= switching_squared(group1.id, group2.id);
+    }
+
+    /**
+     * @brief Moments of a group with respect to its mass center
+     */
+    template <typename TGroup> Moments groupMoments(const TGroup &group) const {
+        const auto boundary = [&](Point &position) { geometry.boundary(position); };
+        return {monopoleMoment(group.begin(), group.end()),
+                dipoleMoment(group.begin(), group.end(), boundary, group.cm),
+                quadrupoleMoment(group.begin(), group.end(), boundary, group.cm)};
+    }
+
+    /**
+     * @brief Calculates the moments of all groups with outdated moments; to be called before concurrent energy().
+     */
+    template <typename TGroups> void update(const TGroups &groups) {
+        if (enabled()) {
+            resize(groups.size());
+            for (size_t i = 0; i < groups.size(); ++i) {
+                if (!is_valid[i]) {
+                    moments[i] = groupMoments(groups[i]);
+                    is_valid[i] = true;
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Marks moments of groups touched by the change as outdated.
+     */
+    void invalidate(const Change &change);
+
+    void invalidate() { std::fill(is_valid.begin(), is_valid.end(), false); } //!< Marks all moments as outdated
+
+    /**
+     * @brief Multipole interaction energy between two groups given by their index in space
+     *
+     * Outdated moments are calculated and stored, hence not safe to call from concurrent threads unless update()
+     * has been called.
+     *
+     * @return energy in kT
+     */
+    template <typename TGroups> double energy(const TGroups &groups, const size_t index1, const size_t index2) {
+        resize(groups.size());
+        for (auto index : {index1, index2}) {
+            if (!is_valid[index]) {
+                moments[index] = groupMoments(groups[index]);
+                is_valid[index] = true;
+            }
+        }
+        return energy(moments[index1], moments[index2], geometry.vdist(groups[index1].cm, groups[index2].cm));
+    }
+
+    /**
+     * @brief Same as energy() above but the moments have to be up to date; safe to call from concurrent threads.
+     * @see update()
+     */
+    template <typename TGroups>
+    double cachedEnergy(const TGroups &groups, const size_t index1, const size_t index2) const {
+        assert(is_valid.at(index1) && is_valid.at(index2));
+        return energy(moments[index1], moments[index2], geometry.vdist(groups[index1].cm, groups[index2].cm));
+    }
+
+    /**
+     * @brief Multipole interaction energy
+     * @param a  moments of the first group
+     * @param b  moments of the second group
+     * @param r  distance vector between the mass centers, a - b
+     * @return energy in kT
+     */
+    double energy(const Moments &a, const Moments &b, const Point &r) const;
+
+    void resize(size_t number_of_groups);
+};
+
+void from_json(const json &, MultipoleFarField &);
+void to_json(json &, const MultipoleFarField &);
+
 /**
  * @brief Provides a fast inlineable interface for non-bonded pair potential energy computation.
  *
@@ -389,6 +647,12 @@ template <typename TPairPotential, bool allow_anisotropic_pair_potential = true>
      */
     PairEnergy(Space &spc, BasePointerVector<Energybase> &potentials) : geometry(spc.geo), spc(spc), potentials(potentials) {}
 
+    //! True if the energy depends only on the particle distance, see potential(a, b, squared_distance)
+    static constexpr bool isotropic = !allow_anisotropic_pair_potential;
+
+    //! True if the pair potential can sum up energies over many partners at once, see potential(a, partners, ...)
+    static constexpr bool batch = isotropic && std::is_base_of_v<Potential::SplinedPotential, TPairPotential>;
+
     /**
      * @brief Computes pair potential energy.
      *
@@ -406,6 +670,48 @@ template <typename TPairPotential, bool allow_anisotropic_pair_potential = true>
         }
     }
 
+    /**
+     * @brief Computes isotropic pair potential energy from a precomputed distance.
+     *
+     * @param a  particle
+     * @param b  particle
+     * @param squared_distance  squared minimum image distance between a and b
+     * @return pair potential energy between particles a and b
+     */
+    template <typename T> inline double potential(const T &a, const T &b, const double squared_distance) const {
+        static_assert(isotropic, "a distance vector is required for anisotropic pair potentials");
+        return pair_potential(a, b, squared_distance, {0, 0, 0});
+    }
+
+    /**
+     * @brief Computes the summed pair potential energy between a particle and a range of partners.
+     *
+     * @param a  particle
+     * @param partners  random access range of partner particles
+     * @param squared_distances  squared minimum image distances between a and the partners
+     * @param ids  atom ids of the partners
+     * @param size  number of partners
+     * @return pair potential energy sum
+     */
+    template <typename T, typename TPartners>
+    inline double potential(const T &a, const TPartners &partners, const double *squared_distances, const int *ids,
+                            const size_t size) const {
+        static_assert(batch, "the pair potential has no batch evaluation");
+        return pair_potential(a, partners, squared_distances, ids, size);
+    }
+
+    /**
+     * @brief Computes pair potential energy at a given separation, ignoring the geometry.
+     *
+     * @param a  particle
+     * @param b  particle
+     * @param r  distance vector between a and b
+     * @return pair potential energy between particles a and b
+     */
+    template <typename T> inline double separationPotential(const T &a, const T &b, const Point &r) const {
+        return pair_potential(a, b, r.squaredNorm(), r);
+    }
+
     // just a temporary placement until PairForce class template will be implemented
     template <typename T> inline Point force(const T &a, const T &b) const {
         assert(&a != &b); // a and b cannot be the same particle
@@ -460,6 +766,52 @@ template <typename TPairEnergy, typename TCutoff> class PairingBasePolicy {
     Space &spc;              //!< a space to operate on
     TPairEnergy pair_energy; //!< a functor to compute non-bonded energy between two particles @see PairEnergy
     GroupCutoff cut;         //!< a cutoff functor that determines if energy between two groups can be ignored
+    MultipoleFarField far_field; //!< optional multipole approximation between distant rigid molecules
+
+    template <typename TGroup> inline size_t groupIndex(const TGroup &group) const {
+        return &group - spc.groups.data();
+    } //!< index of a group in space
+
+    /**
+     * @brief Pairing between a particle and all particles in a group.
+     *
+     * For isotropic pair potentials the distances are first calculated in a single, vectorizable pass over
+     * the structure-of-arrays mirror of the particles (Space::particle_arrays), which hence has to be up to date;
+     * it is refreshed by the code modifying the particles, see Space::updateParticleArrays(), which is
+     * asserted in debug builds. Pair potentials with a batch evaluation (PairEnergy::batch) then sum up all
+     * partners in a single call. Otherwise the potential is evaluated pair by pair; the partners are then read
+     * from the particle vector as pair potentials take whole particles, e.g. for their charges.
+     *
+     * @param particle
+     * @param group  group which must not contain the particle
+     * @return energy sum between particle pairs
+     */
+    template <typename TParticle, typename TGroup> double particle2group(const TParticle &particle, const TGroup &group) {
+        double u = 0;
+        if constexpr (TPairEnergy::isotropic) {
+            const auto &arrays = spc.particle_arrays;
+            const auto offset = std::distance(spc.p.begin(), group.begin());
+            const size_t size = group.size();
+            assert(arrays.size() == spc.p.size());
+            assert(arrays.matches(group.begin(), group.end(), offset)); // stale mirror?
+            static thread_local std::vector<double> squared_distances; // reentrant and thread-safe buffer
+            squared_distances.resize(std::max(squared_distances.size(), size));
+            spc.geo.sqdist(particle.pos, arrays.x.data() + offset, arrays.y.data() + offset,
+                           arrays.z.data() + offset, size, squared_distances.data());
+            if constexpr (TPairEnergy::batch) {
+                u = pair_energy.potential(particle, group, squared_distances.data(), arrays.id.data() + offset, size);
+            } else {
+                for (size_t i = 0; i < size; ++i) {
+                    u += pair_energy.potential(particle, group[i], squared_distances[i]);
+                }
+            }
+        } else {
+            for (auto &other_particle : group) {
+                u += particle2particle(particle, other_particle);
+            }
+        }
+        return u;
+    }
 
   public:
     /**
@@ -467,16 +819,94 @@ template <typename TPairEnergy, typename TCutoff> class PairingBasePolicy {
      * @param potentials  registered non-bonded potentials
      */
     PairingBasePolicy(Space &spc, BasePointerVector<Energybase> &potentials)
-        : spc(spc), pair_energy(spc, potentials), cut(spc.geo) {}
+        : spc(spc), pair_energy(spc, potentials), cut(spc.geo), far_field(spc.geo) {}
 
     void from_json(const json &j) {
         Energy::from_json(j, cut);
+        Energy::from_json(j, far_field);
         pair_energy.from_json(j);
+        checkFarField();
+    }
+
+    /**
+     * @brief Throws unless the pair potential is plain Coulomb wherever the multipole far field applies
+     *
+     * Every pair of charged atoms in rigid molecules is probed at one, two and four times the switching distance
+     * of the molecules and compared with the ion-ion energy of the far field. This rejects screened, truncated
+     * or damped Coulomb potentials and a different dielectric constant. Short-ranged contributions are tolerated
+     * as these are ignored by the far field anyway.
+     */
+    void checkFarField() const {
+        if (!far_field.enabled()) {
+            return;
+        }
+        constexpr double tolerance = 1e-3; // relative
+        for (const auto &molecule_a : Faunus::molecules) {
+            for (const auto &molecule_b : Faunus::molecules) {
+                const double switching_distance = far_field.switchingDistance(molecule_a.id(), molecule_b.id());
+                if (std::isinf(switching_distance)) {
+                    continue;
+                }
+                for (const auto id_a : molecule_a.atoms) {
+                    for (const auto id_b : molecule_b.atoms) {
+                        const Particle particle_a(Faunus::atoms.at(id_a)), particle_b(Faunus::atoms.at(id_b));
+                        MultipoleFarField::Moments ion_a, ion_b;
+                        ion_a.charge = particle_a.charge;
+                        ion_b.charge = particle_b.charge;
+                        for (const double factor : {1.0, 2.0, 4.0}) {
+                            const Point r(factor * switching_distance, 0.0, 0.0);
+                            const double u_far = far_field.energy(ion_a, ion_b, r);
+                            const double u = pair_energy.separationPotential(particle_a, particle_b, r);
+                            if (std::fabs(u - u_far) > tolerance * std::fabs(u_far)) {
+                                throw ConfigurationError("multipole_g2g: pair potential between {} and {} is not "
+                                                         "plain Coulomb with the given epsr at {} Å",
+                                                         Faunus::atoms.at(id_a).name, Faunus::atoms.at(id_b).name,
+                                                         r.x());
+                            }
+                        }
+                    }
+                }
+            }
+        }
     }
 
     void to_json(json &j) const {
         pair_energy.to_json(j);
         Energy::to_json(j, cut);
+        Energy::to_json(j, far_field);
+    }
+
+    /**
+     * @brief Marks the cached far-field moments of groups touched by the change as outdated.
+     *
+     * Has to be called whenever particles of the space are modified, i.e., before energy calculation and upon
+     * synchronisation.
+     */
+    void invalidateMoments(const Change &change) { far_field.invalidate(change); }
+
+    void invalidateMoments() { far_field.invalidate(); } //!< Marks all cached far-field moments as outdated
+
+    /**
+     * @brief Tests if all pair energies are zero beyond a distance
+     *
+     * Every pair of atom types is probed at a few separations between one and four times
+     * the distance. This cannot prove that a pair potential vanishes but catches the
+     * common mistake of a too short distance.
+     */
+    bool vanishesBeyond(double distance) const {
+        for (const auto &atom_a : Faunus::atoms) {
+            const Particle particle_a(atom_a);
+            for (const auto &atom_b : Faunus::atoms) {
+                const Particle particle_b(atom_b);
+                for (const double factor : {1.0, 1.01, 1.1, 1.5, 2.0, 4.0}) {
+                    if (pair_energy.separationPotential(particle_a, particle_b, Point(factor * distance, 0, 0)) !=
+                        0.0) {
+                        return false;
+                    }
+                }
+            }
+        }
+        return true;
     }
 
     template <typename T> inline double particle2particle(const T &a, const T &b) const {
@@ -595,6 +1025,7 @@ template <typename TPairEnergy, typename TCutoff> class PairingBasePolicy {
      * group1 × group2
      *
      * If the distance between the groups is greater or equal to the group cutoff distance, no calculation is performed.
+     * Beyond the far-field switching distance, the multipole approximation is used instead of the particle pairs.
      * The group intersection must be an empty set, i.e., no particle is included in both groups. This is not verified
      * for performance reason.
      *
@@ -605,6 +1036,9 @@ template <typename TPairEnergy, typename TCutoff> class PairingBasePolicy {
     template <typename TGroup> double group2group(const TGroup &group1, const TGroup &group2) {
         double u = 0;
         if (!cut(group1, group2)) {
+            if (far_field.isFar(group1, group2)) {
+                return far_field.energy(spc.groups, groupIndex(group1), groupIndex(group2));
+            }
             for (auto &particle1 : group1) {
                 for (auto &particle2 : group2) {
                     u += particle2particle(particle1, particle2);
@@ -632,6 +1066,9 @@ template <typename TPairEnergy, typename TCutoff> class PairingBasePolicy {
      */
     template <typename TGroup>
     double group2group(const TGroup &group1, const TGroup &group2, const std::vector<int> &index1) {
+        if (index1.size() == group1.size() && far_field.enabled()) {
+            return group2group(group1, group2); // all particles in the index; the far field may apply
+        }
         double u = 0;
         if (!cut(group1, group2)) {
             for (auto particle1_ndx : index1) {
@@ -776,11 +1213,9 @@ template <typename TPairEnergy, typename TCutoff> class PairingBasePolicy {
         double u = 0;
         const auto &particle = group[index];
         for (auto &other_group : spc.groups) {
-            if (&other_group != &group) {                      // avoid self-interaction
-                if (!cut(other_group, group)) {                // check g2g cut-off
-                    for (auto &other_particle : other_group) { // loop over particles in other group
-                        u += particle2particle(particle, other_particle);
-                    }
+            if (&other_group != &group) {       // avoid self-interaction
+                if (!cut(other_group, group)) { // check g2g cut-off
+                    u += particle2group(particle, other_group);
                 }
             }
         }
@@ -909,6 +1344,16 @@ template <typename TPairEnergy, typename TCutoff> class PairingBasePolicy {
     }
 };
 
+/**
+ * @brief Particle pairing to calculate non-bonded pair potential energies.
+ *
+ * The serial implementation is fully inherited from PairingBasePolicy. A specialization exists for
+ * `parallel = true`.
+ *
+ * @tparam TPairEnergy  a functor to compute non-bonded energy between two particles
+ * @tparam TCutoff  a cutoff scheme between groups
+ * @tparam parallel  split the outer group loops of the per-move methods among OpenMP threads
+ */
 template <typename TPairEnergy, typename TCutoff, bool parallel = false>
 class PairingPolicy : public PairingBasePolicy<TPairEnergy, TCutoff> {
   public:
@@ -916,73 +1361,630 @@ class PairingPolicy : public PairingBasePolicy<TPairEnergy, TCutoff> {
 };
 
 /**
- * @brief Computes change in the non-bonded energy, assuming pair-wise additive energy terms.
+ * @brief Particle pairing with the outer group loop split among OpenMP threads.
  *
- * @tparam TPairingPolicy  pairing policy to effectively sum up the pair-wise additive non-bonded energy
+ * Only the methods used in per-move energy evaluations are overridden: group2all(), group2groups() and
+ * groups2all(). Energies of individual group pairs are stored into a buffer indexed by the position of the
+ * group pair in the serial loop. The buffer is summed up sequentially afterwards, hence the result does not
+ * depend on the number of threads or the scheduling. It may differ from the serial policy only by the rounding
+ * error given by a different association of the floating point additions.
+ *
+ * The pair potential must be safe to call from concurrent threads, i.e., `TPairEnergy::potential` must not
+ * modify any shared state. Without OpenMP the class falls back to the serial behaviour.
+ *
+ * @see PairingBasePolicy
  */
-template <typename TPairingPolicy> class Nonbonded : public Energybase {
-  protected:
-    Space &spc;             //!< space to operate on
-    TPairingPolicy pairing; //!< pairing policy to effectively sum up the pair-wise additive non-bonded energy
+template <typename TPairEnergy, typename TCutoff>
+class PairingPolicy<TPairEnergy, TCutoff, true> : public PairingBasePolicy<TPairEnergy, TCutoff> {
+    typedef PairingBasePolicy<TPairEnergy, TCutoff> Base;
+    using Base::cut;
+    using Base::far_field;
+    using Base::groupIndex;
+    using Base::spc;
+    std::vector<double> partial_energies; //!< energies of individual group pairs summed up in a deterministic order
+    std::vector<int> other_groups;        //!< group indices of group2groups(), kept to avoid reallocations
+    std::vector<std::pair<int, int>> group_pairs; //!< group index pairs of groups2all(), kept likewise
 
     /**
-     * @brief Computes non-bonded energy contribution if only a single group has changed.
-     *
-     * @param change
-     * @return energy sum between particle pairs
+     * @brief Multipole energy if the groups are beyond the far-field switching distance, otherwise std::nullopt.
+     * The cached moments have to be up to date, see reduce().
      */
-    double energyGroup(Change &change) {
+    template <typename TGroup>
+    inline std::optional<double> farField(const TGroup &group1, const TGroup &group2) const {
+        if (far_field.isFar(group1, group2)) {
+            return far_field.cachedEnergy(spc.groups, groupIndex(group1), groupIndex(group2));
+        }
+        return std::nullopt;
+    }
+
+    /**
+     * @brief Complete cartesian pairing of particles in two groups without any cutoff check.
+     */
+    template <typename TGroup> inline double groupPairs(const TGroup &group1, const TGroup &group2) const {
         double u = 0;
-        const auto &change_data = change.groups[0];
-        const auto &group = spc.groups.at(change_data.index);
-        if (change_data.atoms.size() == 1) {
-            // faster algorithm if only a single particle moves
-            u = pairing.group2all(group, change_data.atoms[0]);
-            if (change_data.internal) {
-                u += pairing.groupInternal(group, change_data.atoms[0]);
+        for (auto &particle1 : group1) {
+            for (auto &particle2 : group2) {
+                u += this->particle2particle(particle1, particle2);
             }
-        } else {
-            const bool change_all = change_data.atoms.empty(); // all particles or only their subset?
-            u = change_all ? pairing.group2all(group) : pairing.group2all(group, change_data.atoms);
-            if (change_data.internal) {
-                u += change_all ? pairing.groupInternal(group) : pairing.groupInternal(group, change_data.atoms);
+        }
+        return u;
+    }
+
+    /**
+     * @brief Cross pairing of indexed particles in the first group and all particles in the second group without
+     * any cutoff check.
+     */
+    template <typename TGroup>
+    inline double groupPairs(const TGroup &group1, const TGroup &group2, const std::vector<int> &index1) const {
+        double u = 0;
+        for (auto particle1_ndx : index1) {
+            const auto &particle1 = *(group1.begin() + particle1_ndx);
+            for (auto &particle2 : group2) {
+                u += this->particle2particle(particle1, particle2);
             }
         }
         return u;
     }
 
     /**
-     * @brief Computes non-bonded energy difference if the number of particles have changed.
+     * @brief Evaluates `pair_energy(n)` for n in [0, size) concurrently and sums the results in ascending order of n.
      *
-     * Particles have to be explicitly enumerated in the atom indices of the changed group. Implicit addition of atoms
-     * with a group is not supported yet. Note that we do not have to care about missing (removed) particles at all.
-     * They are taken into account in the original (old) space where they are present.
+     * Outdated far-field moments are calculated beforehand such that farField() can be called concurrently.
+     * A few group pairs are evaluated by the calling thread only as waking the threads would cost more.
      *
-     * @param change
-     * @return energy sum between particle pairs
+     * @param size  number of group pairs
+     * @param pair_energy  function returning energy of the n-th group pair or std::nullopt if the pair is beyond
+     *                     the cutoff
+     * @return energy sum
      */
-    double energySpeciation(Change &change) {
-        assert(change.dN);
-        double u = 0;
-        const auto &moved = change.touchedGroupIndex(); // index of moved groups
-        const auto &fixed = indexComplement(int(spc.groups.size()), moved) | ranges::to<std::vector>; // index of static groups
-        auto filter_active = [](int size){return ranges::views::filter([size](const auto i) { return i < size; }); };
-
-        // loop over all changed groups
-        for (auto change_group1_it = change.groups.begin(); change_group1_it < change.groups.end(); ++change_group1_it) {
-            auto &group1 = spc.groups.at(change_group1_it->index);
-            // filter only active particles
-            const std::vector<int> index1 = change_group1_it->atoms | filter_active(group1.size()) | ranges::to<std::vector>;
-            if (!index1.empty()) {
-                // particles added into the group: compute (changed group) <-> (static group)
-                u += pairing.group2groups(group1, fixed, index1);
+    template <typename TFunction> double reduce(const int size, TFunction &&pair_energy) {
+        constexpr int min_parallel_size = 64; // smaller problems are not worth waking threads
+        partial_energies.resize(size);
+        far_field.update(spc.groups);
+        int skipped = 0;
+#pragma omp parallel for schedule(dynamic) reduction(+ : skipped) if (size > min_parallel_size)
+        for (int n = 0; n < size; ++n) {
+            const std::optional<double> u = pair_energy(n);
+            if (u) {
+                partial_energies[n] = *u;
+            } else {
+                partial_energies[n] = 0.0;
+                ++skipped;
             }
-            // loop over successor changed groups (hence avoid double counting group1×group2 and group2×group1)
-            for (auto change_group2_it = std::next(change_group1_it); change_group2_it < change.groups.end(); ++change_group2_it) {
-                auto &group2 = spc.groups.at(change_group2_it->index);
-                const std::vector<int> index2 = change_group2_it->atoms | filter_active(group2.size()) | ranges::to<std::vector>;
-                if (!index1.empty() || !index2.empty()) {
-                    // particles added into one or other group: compute (changed group) <-> (changed group)
+        }
+        cut.addStatistics(size, skipped);
+        return std::accumulate(partial_energies.begin(), partial_energies.end(), 0.0);
+    }
+
+  public:
+    using Base::Base;
+    using Base::group2all;
+    using Base::group2groups;
+
+    /**
+     * @brief Complete cartesian pairing between particles in a group and particles in other groups in space.
+     * @see PairingBasePolicy::group2all
+     */
+    template <typename TGroup> double group2all(const TGroup &group) {
+        return reduce(spc.groups.size(), [&](int n) -> std::optional<double> {
+            const auto &other_group = spc.groups[n];
+            if (&other_group == &group) {
+                return 0.0;
+            }
+            if (cut.isBeyond(group, other_group)) {
+                return std::nullopt;
+            }
+            if (auto u = farField(group, other_group)) {
+                return u;
+            }
+            return groupPairs(group, other_group);
+        });
+    }
+
+    /**
+     * @brief Complete cartesian pairing between selected particles in a group and particles in other groups in space.
+     * @see PairingBasePolicy::group2all
+     */
+    template <typename TGroup> double group2all(const TGroup &group, const std::vector<int> &index) {
+        if (index.size() == group.size() && far_field.enabled()) {
+            return group2all(group); // all particles in the index; the far field may apply
+        }
+        if (index.size() == 1) {
+            return Base::group2all(group, index[0]);
+        }
+        return reduce(spc.groups.size(), [&](int n) -> std::optional<double> {
+            const auto &other_group = spc.groups[n];
+            if (&other_group == &group) {
+                return 0.0;
+            }
+            if (cut.isBeyond(group, other_group)) {
+                return std::nullopt;
+            }
+            return groupPairs(group, other_group, index);
+        });
+    }
+
+    /**
+     * @brief Complete cartesian pairing between particles in a group and a union of groups.
+     * @see PairingBasePolicy::group2groups
+     */
+    template <typename TGroup, typename TGroups> double group2groups(const TGroup &group, const TGroups &groups) {
+        other_groups.clear();
+        for (auto &other_group : groups) {
+            if (&other_group != &group) {
+                other_groups.push_back(groupIndex(other_group));
+            }
+        }
+        return reduce(other_groups.size(), [&](int n) -> std::optional<double> {
+            const auto &other_group = spc.groups[other_groups[n]];
+            if (cut.isBeyond(group, other_group)) {
+                return std::nullopt;
+            }
+            if (auto u = farField(group, other_group)) {
+                return u;
+            }
+            return groupPairs(group, other_group);
+        });
+    }
+
+    /**
+     * @brief Cross pairing of indexed particles in a group and a union of groups.
+     * @see PairingBasePolicy::group2groups
+     */
+    template <typename TGroup, typename TGroups>
+    double group2groups(const TGroup &group, const TGroups &group_index, const std::vector<int> &index) {
+        other_groups.assign(group_index.begin(), group_index.end());
+        const bool whole_group = index.size() == group.size(); // the far field may apply
+        return reduce(other_groups.size(), [&](int n) -> std::optional<double> {
+            const auto &other_group = spc.groups[other_groups[n]];
+            if (&other_group == &group) {
+                return 0.0;
+            }
+            if (cut.isBeyond(group, other_group)) {
+                return std::nullopt;
+            }
+            if (whole_group) {
+                if (auto u = farField(group, other_group)) {
+                    return u;
+                }
+            }
+            return groupPairs(group, other_group, index);
+        });
+    }
+
+    /**
+     * @brief Cross pairing of particles between a union of groups and its complement in space.
+     *
+     * Both the pairs among the union and pairs between the union and its complement are distributed
+     * among threads as a single flat list of group pairs.
+     *
+     * @see PairingBasePolicy::groups2all
+     */
+    template <typename T> double groups2all(const T &group_index) {
+        group_pairs.clear();
+        for (auto group1_ndx_it = group_index.begin(); group1_ndx_it < group_index.end(); ++group1_ndx_it) {
+            for (auto group2_ndx_it = std::next(group1_ndx_it); group2_ndx_it < group_index.end(); group2_ndx_it++) {
+                group_pairs.emplace_back(*group1_ndx_it, *group2_ndx_it);
+            }
+        }
+        for (auto group1_ndx : group_index) {
+            for (auto group2_ndx : indexComplement(spc.groups.size(), group_index)) {
+                group_pairs.emplace_back(group1_ndx, group2_ndx);
+            }
+        }
+        return reduce(group_pairs.size(), [&](int n) -> std::optional<double> {
+            const auto &group1 = spc.groups[group_pairs[n].first];
+            const auto &group2 = spc.groups[group_pairs[n].second];
+            if (cut.isBeyond(group1, group2)) {
+                return std::nullopt;
+            }
+            if (auto u = farField(group1, group2)) {
+                return u;
+            }
+            return groupPairs(group1, group2);
+        });
+    }
+};
+
+/**
+ * @brief Pair energy functor with a spherical cutoff distance between particles.
+ *
+ * Beyond the cutoff, zero energy is returned regardless of the underlying pair potential. The cutoff is read
+ * from the `cutoff` keyword.
+ *
+ * @tparam TPairEnergy  a functor to compute non-bonded energy between two particles
+ * @see PairEnergy
+ */
+template <typename TPairEnergy> class PairEnergyWithCutoff : public TPairEnergy {
+    Space::Tgeometry &geometry;        //!< geometry to compute the particle distance with
+    double cutoff_squared = pc::infty; //!< squared cutoff distance in angstrom squared
+
+  public:
+    PairEnergyWithCutoff(Space &spc, BasePointerVector<Energybase> &potentials)
+        : TPairEnergy(spc, potentials), geometry(spc.geo) {}
+
+    template <typename T> inline double potential(const T &a, const T &b) const {
+        return geometry.sqdist(a.pos, b.pos) < cutoff_squared ? TPairEnergy::potential(a, b) : 0.0;
+    }
+
+    template <typename T> inline double potential(const T &a, const T &b, const double squared_distance) const {
+        return squared_distance < cutoff_squared ? TPairEnergy::potential(a, b, squared_distance) : 0.0;
+    }
+
+    template <typename T> inline double separationPotential(const T &a, const T &b, const Point &r) const {
+        return r.squaredNorm() < cutoff_squared ? TPairEnergy::separationPotential(a, b, r) : 0.0;
+    }
+
+    static constexpr bool batch = false; //!< the batch evaluation does not honour the cutoff
+
+    template <typename... Args> inline auto operator()(Args &&... args) {
+        return potential(std::forward<Args>(args)...);
+    }
+
+    double getCutoff() const { return std::sqrt(cutoff_squared); }
+
+    void from_json(const json &j) {
+        cutoff_squared = std::pow(j.at("cutoff").get<double>(), 2);
+        TPairEnergy::from_json(j);
+    }
+
+    void to_json(json &j) const {
+        TPairEnergy::to_json(j);
+        j["cutoff"] = getCutoff();
+    }
+};
+
+/**
+ * @brief Particle pairing using a cell list for short-ranged pair potentials.
+ *
+ * All particle pairs beyond the spherical cutoff are ignored (see PairEnergyWithCutoff), hence only particles in
+ * the neighbouring cells need to be visited when pairing a few particles with the rest of the system. This is used
+ * for group2all() and for the partial internal energy of atomic groups. Thus a displacement of a single atom costs
+ * O(neighbours) rather than O(N). All other methods are inherited from PairingBasePolicy and give the same energy
+ * as they honour the same spherical cutoff.
+ *
+ * The cell list has to be kept in sync with the particle positions by calling update() with the
+ * Change object before any energy is calculated. The update is incremental and can be reverted
+ * with rollback() if the move is rejected. Only cuboidal geometries periodic in all directions
+ * are supported.
+ *
+ * @tparam TPairEnergy  a functor to compute non-bonded energy between two particles
+ * @tparam TCutoff  a cutoff scheme between groups
+ * @see NonbondedCellList, CellList
+ */
+template <typename TPairEnergy, typename TCutoff>
+class CellListPairingPolicy : public PairingBasePolicy<PairEnergyWithCutoff<TPairEnergy>, TCutoff> {
+    typedef PairingBasePolicy<PairEnergyWithCutoff<TPairEnergy>, TCutoff> Base;
+    typedef Eigen::Vector3i CellPoint;
+    using Base::cut;
+    using Base::pair_energy;
+    using Base::spc;
+    CellList<CellPoint> cell_list;
+    std::vector<int> particle_groups; //!< group index of each particle incl. inactive ones; index as in Space::p
+    std::vector<size_t> neighbours;   //!< buffer for neighbour particle indices
+    std::vector<size_t> moved;        //!< buffer for sorted particle indices
+    using Base::groupIndex;
+
+    template <typename TGroup> inline size_t particleIndex(const TGroup &group, int index) const {
+        return std::distance(spc.p.begin(), group.begin()) + index;
+    }
+
+    /**
+     * @brief Energy between a particle in a group and neighbouring particles in other groups.
+     */
+    template <typename TGroup> double particle2neighbours(const TGroup &group, const Particle &particle) {
+        double u = 0;
+        const int group_ndx = groupIndex(group);
+        cell_list.neighbors(cell_list.p2c(particle.pos), neighbours);
+        for (auto j : neighbours) {
+            const int other_group_ndx = particle_groups[j];
+            if (other_group_ndx != group_ndx && !cut.isBeyond(group, spc.groups[other_group_ndx])) {
+                u += this->particle2particle(particle, spc.p[j]);
+            }
+        }
+        return u;
+    }
+
+    /**
+     * @brief Inserts active and removes inactive particles of a group, including its inactive part.
+     */
+    template <typename TGroup> void updateGroup(const TGroup &group) {
+        const auto first = particleIndex(group, 0);
+        for (size_t i = first; i < first + group.size(); ++i) {
+            cell_list.update(i, spc.p[i].pos);
+        }
+        for (size_t i = first + group.size(); i < first + group.capacity(); ++i) {
+            cell_list.erase(i);
+        }
+    }
+
+  public:
+    using Base::group2all;
+    using Base::groupInternal;
+
+    CellListPairingPolicy(Space &spc, BasePointerVector<Energybase> &potentials) : Base(spc, potentials) {}
+
+    void from_json(const json &j) {
+        Base::from_json(j);
+        const auto &direction = spc.geo.boundaryConditions().direction;
+        const bool periodic = std::all_of(direction.data(), direction.data() + direction.size(),
+                                          [](auto boundary) { return boundary == Geometry::PERIODIC; });
+        if (spc.geo.type != Geometry::CUBOID || !periodic) {
+            throw ConfigurationError("cell list requires a cuboid with periodic boundaries");
+        }
+        if (Base::far_field.enabled()) {
+            throw ConfigurationError("cell list cannot be combined with a multipole far field");
+        }
+    }
+
+    /**
+     * @brief True if the cell list has been built for the current number of particles.
+     */
+    bool isBuilt() const { return particle_groups.size() == spc.p.size(); }
+
+    /**
+     * @brief Rebuilds the cell list from scratch using the current box and active particles.
+     */
+    void rebuild() {
+        cell_list.resize(spc.geo.getLength(), pair_energy.getCutoff());
+        particle_groups.assign(spc.p.size(), -1);
+        for (auto &group : spc.groups) {
+            const auto first = particleIndex(group, 0);
+            std::fill_n(particle_groups.begin() + first, group.capacity(), groupIndex(group));
+            for (size_t i = first; i < first + group.size(); ++i) {
+                cell_list.insert(i, spc.p[i].pos);
+            }
+        }
+    }
+
+    /**
+     * @brief Updates the cell list with respect to changed particles.
+     *
+     * Only the changed particles are visited, except for volume changes where the cells are rescaled and all
+     * particles checked. If the cells become smaller than the cutoff distance, the list is rebuilt. Upon particle
+     * number changes, all particles in the changed groups are visited, as (de)activation may shuffle particles
+     * within a group. All modifications can be reverted with rollback().
+     */
+    void update(const Change &change) {
+        if (change.all || !isBuilt()) {
+            rebuild();
+        } else if (change.dV) {
+            if (cell_list.rescale(spc.geo.getLength(), pair_energy.getCutoff())) {
+                for (auto &group : spc.groups) {
+                    updateGroup(group);
+                }
+            } else {
+                rebuild();
+            }
+        } else {
+            for (const auto &change_data : change.groups) {
+                const auto &group = spc.groups[change_data.index];
+                if (change.dN) {
+                    updateGroup(group);
+                } else if (change_data.atoms.empty()) {
+                    for (int n = 0; n < group.size(); ++n) {
+                        cell_list.update(particleIndex(group, n), group[n].pos);
+                    }
+                } else {
+                    for (int n : change_data.atoms) {
+                        if (n < group.size()) {
+                            cell_list.update(particleIndex(group, n), group[n].pos);
+                        }
+                    }
+                }
+            }
+        }
+    }
+
+    /**
+     * @brief Accepts the current state as the reference for subsequent rollbacks.
+     */
+    void commit() { cell_list.commit(); }
+
+    /**
+     * @brief Reverts all changes since the last commit.
+     *
+     * If the cell list was rebuilt in the meantime, the cell list of the other (synchronised) policy is copied.
+     *
+     * @param other  policy operating on a space in the state to return to
+     */
+    void rollback(const CellListPairingPolicy &other) {
+        if (!cell_list.rollback()) {
+            cell_list = other.cell_list;
+            particle_groups = other.particle_groups;
+            cell_list.commit();
+        }
+    }
+
+    /**
+     * @brief Synchronises with the other policy after the space has been synchronised.
+     *
+     * Large changes are copied from the other policy, otherwise changed particles are updated.
+     *
+     * @param other  policy operating on a space in the state to synchronise with
+     * @param change
+     */
+    void sync(const CellListPairingPolicy &other, const Change &change) {
+        if (change.all || change.dV || !isBuilt()) {
+            cell_list = other.cell_list;
+            particle_groups = other.particle_groups;
+        } else {
+            update(change);
+        }
+        cell_list.commit();
+    }
+
+    /**
+     * @brief Pairing between all particles in a group and neighbouring particles in other groups.
+     * @see PairingBasePolicy::group2all
+     */
+    template <typename TGroup> double group2all(const TGroup &group) {
+        double u = 0;
+        for (auto &particle : group) {
+            u += particle2neighbours(group, particle);
+        }
+        return u;
+    }
+
+    /**
+     * @brief Pairing between a single particle in a group and neighbouring particles in other groups.
+     * @see PairingBasePolicy::group2all
+     */
+    template <typename TGroup> double group2all(const TGroup &group, const int index) {
+        return particle2neighbours(group, group[index]);
+    }
+
+    /**
+     * @brief Pairing between selected particles in a group and neighbouring particles in other groups.
+     * @see PairingBasePolicy::group2all
+     */
+    template <typename TGroup> double group2all(const TGroup &group, const std::vector<int> &index) {
+        double u = 0;
+        for (auto n : index) {
+            u += particle2neighbours(group, group[n]);
+        }
+        return u;
+    }
+
+    /**
+     * @brief Partial internal energy of a group limited to interactions of a single particle within the group.
+     *
+     * Neighbouring cells are visited only for atomic groups as these have no pair exclusions and may be
+     * large. Molecular groups are handled by PairingBasePolicy.
+     *
+     * @see PairingBasePolicy::groupInternal
+     */
+    template <typename TGroup> double groupInternal(const TGroup &group, const int index) {
+        if (!group.atomic) {
+            return Base::groupInternal(group, index);
+        }
+        double u = 0;
+        if (!group.traits().rigid) {
+            const int group_ndx = groupIndex(group);
+            const auto i = particleIndex(group, index);
+            cell_list.neighbors(cell_list.p2c(spc.p[i].pos), neighbours);
+            for (auto j : neighbours) {
+                if (j != i && particle_groups[j] == group_ndx) {
+                    u += this->particle2particle(spc.p[i], spc.p[j]);
+                }
+            }
+        }
+        return u;
+    }
+
+    /**
+     * @brief Partial internal energy of the group limited to the particles present in the index.
+     * @see PairingBasePolicy::groupInternal
+     */
+    template <typename TGroup, typename TIndex> double groupInternal(const TGroup &group, const TIndex &index) {
+        if (!group.atomic) {
+            return Base::groupInternal(group, index);
+        }
+        if (index.size() == 1) {
+            return groupInternal(group, index[0]);
+        }
+        double u = 0;
+        if (!group.traits().rigid) {
+            const int group_ndx = groupIndex(group);
+            moved.clear();
+            for (int n : index) {
+                moved.push_back(particleIndex(group, n));
+            }
+            std::sort(moved.begin(), moved.end());
+            for (auto i : moved) {
+                cell_list.neighbors(cell_list.p2c(spc.p[i].pos), neighbours);
+                for (auto j : neighbours) {
+                    if (j != i && particle_groups[j] == group_ndx) {
+                        // moved <-> moved pairs are counted only once
+                        if (j > i || !std::binary_search(moved.begin(), moved.end(), j)) {
+                            u += this->particle2particle(spc.p[i], spc.p[j]);
+                        }
+                    }
+                }
+            }
+        }
+        return u;
+    }
+};
+
+/**
+ * @brief Computes change in the non-bonded energy, assuming pair-wise additive energy terms.
+ *
+ * @tparam TPairingPolicy  pairing policy to effectively sum up the pair-wise additive non-bonded energy
+ */
+template <typename TPairingPolicy> class Nonbonded : public Energybase {
+  protected:
+    Space &spc;             //!< space to operate on
+    TPairingPolicy pairing; //!< pairing policy to effectively sum up the pair-wise additive non-bonded energy
+    std::vector<int> fixed_groups;  //!< indices of static groups in energySpeciation(), kept to avoid reallocations
+    std::vector<int> active_index1; //!< active particles of the first changed group in energySpeciation()
+    std::vector<int> active_index2; //!< active particles of the second changed group in energySpeciation()
+
+    /**
+     * @brief Computes non-bonded energy contribution if only a single group has changed.
+     *
+     * @param change
+     * @return energy sum between particle pairs
+     */
+    double energyGroup(Change &change) {
+        double u = 0;
+        const auto &change_data = change.groups[0];
+        const auto &group = spc.groups.at(change_data.index);
+        if (change_data.atoms.size() == 1) {
+            // faster algorithm if only a single particle moves
+            u = pairing.group2all(group, change_data.atoms[0]);
+            if (change_data.internal) {
+                u += pairing.groupInternal(group, change_data.atoms[0]);
+            }
+        } else {
+            const bool change_all = change_data.atoms.empty(); // all particles or only their subset?
+            u = change_all ? pairing.group2all(group) : pairing.group2all(group, change_data.atoms);
+            if (change_data.internal) {
+                u += change_all ? pairing.groupInternal(group) : pairing.groupInternal(group, change_data.atoms);
+            }
+        }
+        return u;
+    }
+
+    /**
+     * @brief Computes non-bonded energy difference if the number of particles have changed.
+     *
+     * Particles have to be explicitly enumerated in the atom indices of the changed group. Implicit addition of atoms
+     * with a group is not supported yet. Note that we do not have to care about missing (removed) particles at all.
+     * They are taken into account in the original (old) space where they are present.
+     *
+     * @param change
+     * @return energy sum between particle pairs
+     */
+    double energySpeciation(Change &change) {
+        assert(change.dN);
+        double u = 0;
+        const auto &moved = change.touchedGroupIndex(); // index of moved groups
+        fixed_groups.clear();                           // index of static groups
+        for (auto group_ndx : indexComplement(int(spc.groups.size()), moved)) {
+            fixed_groups.push_back(group_ndx);
+        }
+        auto filter_active = [](const auto &atoms, int size, std::vector<int> &active) -> const std::vector<int> & {
+            active.clear();
+            std::copy_if(atoms.begin(), atoms.end(), std::back_inserter(active), [size](int i) { return i < size; });
+            return active;
+        };
+
+        // loop over all changed groups
+        for (auto change_group1_it = change.groups.begin(); change_group1_it < change.groups.end(); ++change_group1_it) {
+            auto &group1 = spc.groups.at(change_group1_it->index);
+            // filter only active particles
+            const std::vector<int> &index1 = filter_active(change_group1_it->atoms, group1.size(), active_index1);
+            if (!index1.empty()) {
+                // particles added into the group: compute (changed group) <-> (static group)
+                u += pairing.group2groups(group1, fixed_groups, index1);
+            }
+            // loop over successor changed groups (hence avoid double counting group1×group2 and group2×group1)
+            for (auto change_group2_it = std::next(change_group1_it); change_group2_it < change.groups.end(); ++change_group2_it) {
+                auto &group2 = spc.groups.at(change_group2_it->index);
+                const std::vector<int> &index2 = filter_active(change_group2_it->atoms, group2.size(), active_index2);
+                if (!index1.empty() || !index2.empty()) {
+                    // particles added into one or other group: compute (changed group) <-> (changed group)
                     u += pairing.group2group(group1, group2, index1, index2);
                 }
             }
@@ -1009,6 +2011,32 @@ template <typename TPairingPolicy> class Nonbonded : public Energybase {
      */
     void force(std::vector<Point> &forces) override { pairing.force(forces); }
 
+    Locality locality() const override { return Locality::GROUP_PAIR; }
+
+    bool vanishesBeyond(double distance) const override { return pairing.vanishesBeyond(distance); }
+
+    /**
+     * @brief The synchronised space is modified by the change, hence the cached far-field moments are outdated
+     */
+    void sync(Energybase *, Change &change) override { pairing.invalidateMoments(change); }
+
+    void init() override { pairing.invalidateMoments(); }
+
+    /**
+     * @brief Energy between a single, changed group and each of the other groups
+     *
+     * The pairs are summed group by group and hence without any neighbour lists of the pairing policy.
+     */
+    void groupPairEnergies(Change &change, std::vector<double> &energies) override {
+        assert(change.groups.size() == 1);
+        pairing.invalidateMoments(change);
+        const auto &group = spc.groups.at(change.groups.front().index);
+        energies.resize(spc.groups.size());
+        for (size_t i = 0; i < spc.groups.size(); i++) {
+            energies[i] = (&spc.groups[i] == &group) ? 0.0 : pairing.group2group(group, spc.groups[i]);
+        }
+    }
+
     /**
      * @brief Computes non-bonded energy contribution from changed particles.
      *
@@ -1020,6 +2048,7 @@ template <typename TPairingPolicy> class Nonbonded : public Energybase {
      */
     double energy(Change &change) override {
         assert(std::is_sorted(change.groups.begin(), change.groups.end()));
+        pairing.invalidateMoments(change);
         double u = 0;
         if (change.all) {
             u = pairing.all();
@@ -1043,137 +2072,279 @@ template <typename TPairingPolicy> class Nonbonded : public Energybase {
 };
 
 
+/**
+ * @brief Computes non-bonded energy contribution from changed particles using a cell list.
+ *
+ * In the trial state, the cell list of the pairing policy is updated with the Change object before the energy
+ * is calculated. Upon acceptance, the accepted state applies the same change; upon rejection, the trial state
+ * rolls back its cell list.
+ *
+ * @tparam TPairEnergy  a functor to compute non-bonded energy between two particles
+ * @see CellListPairingPolicy
+ */
+template <typename TPairEnergy>
+class NonbondedCellList : public Nonbonded<CellListPairingPolicy<TPairEnergy, GroupCutoff>> {
+    typedef Nonbonded<CellListPairingPolicy<TPairEnergy, GroupCutoff>> base;
+
+  public:
+    NonbondedCellList(const json &j, Space &spc, BasePointerVector<Energybase> &pot) : base(j, spc, pot) {
+        base::name += " celllist";
+    }
+
+    Energybase::Locality locality() const override {
+        return Energybase::Locality::NONLOCAL;
+    } //!< The cell list must follow every move
+
+    double energy(Change &change) override {
+        // particles in the accepted state are modified only by sync()
+        if (base::key != Energybase::ACCEPTED_MONTE_CARLO_STATE || change.all || !base::pairing.isBuilt()) {
+            base::pairing.update(change);
+        }
+        return base::energy(change);
+    }
+
+    /**
+     * @brief Updates the cell list to match the already synchronised space
+     */
+    void sync(Energybase *basePtr, Change &change) override {
+        auto other = dynamic_cast<decltype(this)>(basePtr);
+        assert(other);
+        base::sync(basePtr, change);
+        if (base::key == Energybase::TRIAL_MONTE_CARLO_STATE) { // rejected move
+            base::pairing.rollback(other->pairing);
+        } else { // accepted move; the trial state continues from here
+            base::pairing.sync(other->pairing, change);
+            other->pairing.commit();
+        }
+    }
+};
+
 /**
  * @brief Computes non-bonded energy contribution from changed particles. Cache group2group energy once calculated,
- * until a new trial configuration is provided. Not for general use as only partially implemented!
+ * until a new trial configuration is provided.
+ *
+ * The energies between all pairs of groups and the internal energy of each group (on the diagonal) are stored
+ * in a symmetric matrix. Upon a move, the trial state recalculates and stores the matrix rows of changed groups,
+ * whereas the accepted state merely sums up the same, cached elements. Rows of atomic groups where only some
+ * particles change, e.g., in single particle translations or in grand canonical insertions and deletions (`dN`),
+ * are instead updated incrementally: both states compute the (partial) energies involving the changed particles only
+ * and the difference is added to the cache upon acceptance. This is exact as the group cutoff never applies to
+ * atomic groups.
  *
- * Original implementation, only refurbished. Generally suboptimal as only PairingPolicy::group2group method
- * may be called.
- * No internal energy is ever computed. Cannot deal with particle count changes. And other unmentioned constrains.
+ * Only the rows of changed groups are synchronised after a move; the whole matrix is copied only if
+ * everything or the volume changes.
  *
- * @tparam Tpairpot
+ * @tparam TPairEnergy  a functor to compute non-bonded energy between two particles
  */
-template <typename Tpairpot> class NonbondedCached : public Nonbonded<PairingPolicy<PairEnergy<Tpairpot>, GroupCutoff>> {
-    typedef Nonbonded<PairingPolicy<PairEnergy<Tpairpot>, GroupCutoff>> base;
+template <typename TPairEnergy> class NonbondedCached : public Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>> {
+    typedef Nonbonded<PairingPolicy<TPairEnergy, GroupCutoff>> base;
     typedef typename Space::Tgroup Tgroup;
-    Eigen::MatrixXf cache;
     using base::spc;
 
-    double g2g(const Tgroup &g1, const Tgroup &g2) {
-        int i = &g1 - spc.groups.data();
-        int j = &g2 - spc.groups.data();
-        if (j < i) {
-            std::swap(i, j);
+    struct PartialEnergy {
+        int group1;
+        int group2;
+        double energy;
+    }; //!< Energy between changed particles and a group (or internal if group1 == group2)
+
+    PairMatrix<double, true> cache;        //!< energy between all pairs of groups; internal energies on the diagonal
+    std::vector<PartialEnergy> partials;   //!< incremental energies of the current move
+    std::vector<int> changed_position;     //!< position of each group in `Change::groups` or -1 if unchanged
+    std::vector<std::vector<int>> indexes; //!< active, changed particles of incremental groups (as in `Change::groups`)
+
+    bool isIncremental(const Change::data &data) const {
+        return spc.groups[data.index].atomic && !data.all && !data.atoms.empty();
+    } //!< True if only some particles in an atomic group change
+
+    bool isIncremental(const Change &change, int group_index) const {
+        const int position = changed_position[group_index];
+        return position >= 0 && isIncremental(change.groups[position]);
+    } //!< True if the group is changed and updated incrementally (only valid inside `energy()`)
+
+    double groupInternal(int group_index) {
+        const auto &group = spc.groups[group_index];
+        if (base::key == Energybase::TRIAL_MONTE_CARLO_STATE) {
+            cache.set(group_index, group_index, base::pairing.groupInternal(group));
+        }
+        return cache(group_index, group_index);
+    } //!< Internal energy; calculated in the trial state, cached in the accepted state
+
+    double group2group(int group_index1, int group_index2) {
+        if (base::key == Energybase::TRIAL_MONTE_CARLO_STATE) {
+            cache.set(group_index1, group_index2,
+                      base::pairing.group2group(spc.groups[group_index1], spc.groups[group_index2]));
+        }
+        return cache(group_index1, group_index2);
+    } //!< Group-to-group energy; calculated in the trial state, cached in the accepted state
+
+    double partial(int group_index1, int group_index2, double energy) {
+        partials.push_back({group_index1, group_index2, energy});
+        return energy;
+    } //!< Record an incremental energy
+
+    /**
+     * @brief Energy of the row of a changed group whose group-to-group energies are recalculated entirely
+     *
+     * Pairs with a preceding changed group of the same kind are skipped as they are included in its row.
+     */
+    double fullRow(Change &change, const Change::data &data) {
+        double u = 0;
+        for (int other = 0; other < int(spc.groups.size()); ++other) {
+            const bool other_is_changed = changed_position[other] >= 0;
+            if (other == data.index || (other_is_changed && !change.moved2moved) ||
+                (other_is_changed && other < data.index && !isIncremental(change, other))) {
+                continue;
+            }
+            u += group2group(data.index, other);
         }
-        if (base::key == Energybase::TRIAL_MONTE_CARLO_STATE) { // if this is from the trial system,
-            cache(i, j) = base::pairing.group2group(g1, g2); // update the cache
+        if (data.internal || change.dN) {
+            u += groupInternal(data.index);
         }
-        return cache(i, j); // return (cached) value
+        return u;
     }
 
-    double g2g(const Tgroup &g1, const Tgroup &g2, [[maybe_unused]] const std::vector<int> &index) {
-        // index not implemented
-        return g2g(g1, g2);
+    /**
+     * @brief Energy involving only the changed particles of an atomic group
+     *
+     * Rows of other changed groups, which are recalculated entirely, already include the pair with this group.
+     */
+    double incrementalRow(Change &change, const Change::data &data, const std::vector<int> &index) {
+        double u = 0;
+        const auto &group = spc.groups[data.index];
+        for (int other = 0; other < int(spc.groups.size()); ++other) {
+            const int position = changed_position[other];
+            if (other == data.index || (position >= 0 && (!change.moved2moved || !isIncremental(change, other)))) {
+                continue;
+            }
+            if (position >= 0) { // both groups change incrementally; count the pair only once
+                if (other > data.index || indexes[position].empty()) {
+                    u += partial(data.index, other,
+                                 base::pairing.group2group(group, spc.groups[other], index, indexes[position]));
+                }
+            } else {
+                u += partial(data.index, other, base::pairing.group2group(group, spc.groups[other], index));
+            }
+        }
+        if (data.internal || change.dN) {
+            u += partial(data.index, data.index, base::pairing.groupInternal(group, index));
+        }
+        return u;
     }
 
+    double energyAll(Change &change) {
+        double u = 0;
+        for (int i = 0; i < int(spc.groups.size()); ++i) {
+            const auto &group = spc.groups[i];
+            if (change.all || group.atomic || group.compressible) {
+                u += groupInternal(i);
+            }
+            for (int j = i + 1; j < int(spc.groups.size()); ++j) {
+                u += group2group(i, j);
+            }
+        }
+        return u;
+    } //!< Energy of all pairs; internal energies of incompressible molecules are skipped upon volume changes
+
+    void copyRows(const NonbondedCached &other, Change &change) {
+        for (auto &data : change.groups) {
+            for (int i = 0; i < int(spc.groups.size()); ++i) {
+                cache.set(data.index, i, other.cache(data.index, i));
+            }
+        }
+    } //!< Copy matrix rows of changed groups from other (complexity: changed groups × groups)
+
   public:
     NonbondedCached(const json &j, Space &spc, BasePointerVector<Energybase> &pot) : base(j, spc, pot) {
         base::name += "EM";
         init();
     }
 
-  /**
-   * @brief Cache pair interactions in matrix.
-   */
+    Energybase::Locality locality() const override {
+        return Energybase::Locality::NONLOCAL;
+    } //!< Has its own cache of group energies
+
+    /**
+     * @brief Cache all pair interactions and internal energies in the matrix
+     */
     void init() override {
-        const auto groups_size = spc.groups.size();
-        cache.resize(groups_size, groups_size);
-        cache.setZero();
-        for (auto i = 0; i < groups_size - 1; ++i) {
-            for (auto j = i + 1; j < groups_size; ++j) {
-                cache(i, j) = base::pairing.group2group(spc.groups[i], spc.groups[j]);
+        const int groups_size = spc.groups.size();
+        base::pairing.invalidateMoments();
+        cache = PairMatrix<double, true>(groups_size);
+        changed_position.assign(groups_size, -1);
+        partials.clear();
+        for (int i = 0; i < groups_size; ++i) {
+            cache.set(i, i, base::pairing.groupInternal(spc.groups[i]));
+            for (int j = i + 1; j < groups_size; ++j) {
+                cache.set(i, j, base::pairing.group2group(spc.groups[i], spc.groups[j]));
             }
         }
     }
 
     double energy(Change &change) override {
-        // Only g2g may be called there to compute (and cache) energy!
         double u = 0;
-        if (change) {
-            if (change.all || change.dV) {
-                for (auto i = spc.groups.begin(); i < spc.groups.end(); ++i) {
-                    for (auto j = std::next(i); j < base::spc.groups.end(); ++j) {
-                        u += g2g(*i, *j);
-                    }
+        base::pairing.invalidateMoments(change);
+        partials.clear();
+        if (change.all || change.dV) {
+            u = energyAll(change);
+        } else if (change) {
+            indexes.resize(change.groups.size());
+            for (size_t position = 0; position < change.groups.size(); ++position) {
+                const auto &data = change.groups[position];
+                changed_position[data.index] = position;
+                indexes[position].clear();
+                if (isIncremental(data)) { // only active particles contribute
+                    const int group_size = spc.groups[data.index].size();
+                    std::copy_if(data.atoms.begin(), data.atoms.end(), std::back_inserter(indexes[position]),
+                                 [group_size](int i) { return i < group_size; });
                 }
-            } else {
-                if (change.groups.size() == 1) { // if exactly ONE molecule is changed
-                    auto &d = change.groups[0];
-                    auto &g1 = spc.groups.at(d.index);
-                    for (auto g2_it = spc.groups.begin(); g2_it < spc.groups.end(); ++g2_it) {
-                        if (&g1 != &(*g2_it)) {
-                            u += g2g(g1, *g2_it, d.atoms);
-                        }
-                    }
-                } else {                                     // many molecules are changed
-                    auto moved = change.touchedGroupIndex(); // index of moved groups
-                    // moved<->moved
-                    if (change.moved2moved) {
-                        for (auto i = moved.begin(); i < moved.end(); ++i) {
-                            for (auto j = std::next(i); j < moved.end(); ++j) {
-                                u += g2g(spc.groups[*i], spc.groups[*j]);
-                            }
-                        }
-                    }
-                    // moved<->static
-#if true
-                    // classic version
-                    auto fixed = indexComplement(spc.groups.size(), moved); // index of static groups
-                    for (auto i : moved) {
-                        for (auto j : fixed) {
-                            u += g2g(spc.groups[i], spc.groups[j]);
-                        }
-                    }
-#else
-                    // OMP-ready version
-                    auto fixed =
-                        indexComplement(spc.groups.size(), moved) | ranges::to<std::vector>; // index of static groups
-                    const size_t moved_size = moved.size();
-                    const size_t fixed_size = fixed.size();
-                    for (auto i = 0; i < moved_size; ++i) {
-                        for (auto j = 0; j < fixed_size; ++j) {
-                            u += g2g(spc.groups[moved[i]], spc.groups[fixed[j]]);
-                        }
-                    }
-#endif
+            }
+            for (size_t position = 0; position < change.groups.size(); ++position) {
+                const auto &data = change.groups[position];
+                if (!isIncremental(data)) {
+                    u += fullRow(change, data);
+                } else if (!indexes[position].empty()) {
+                    u += incrementalRow(change, data, indexes[position]);
                 }
             }
-            // more todo!
+            for (auto &data : change.groups) {
+                changed_position[data.index] = -1;
+            }
         }
         return u;
     }
 
     /**
-     * @brief Copy energy matrix from other
-     * @param base_ptr
-     * @param change
+     * @brief Update the energy matrix from other
+     *
+     * Upon acceptance, the incremental energies of both states are applied to the accepted state and the changed
+     * rows are copied back to the trial state. Upon rejection, the trial state restores the changed rows.
      */
     void sync(Energybase *base_ptr, Change &change) override {
         auto other = dynamic_cast<decltype(this)>(base_ptr);
         assert(other);
+        base::sync(base_ptr, change);
         if (change.all || change.dV) {
-            cache.triangularView<Eigen::StrictlyUpper>() =
-                (other->cache).template triangularView<Eigen::StrictlyUpper>();
-        } else {
-            for (auto &d : change.groups) {
-                for (int i = 0; i < d.index; i++) {
-                    cache(i, d.index) = other->cache(i, d.index);
-                }
-                for (size_t i = d.index + 1; i < spc.groups.size(); i++) {
-                    cache(d.index, i) = other->cache(d.index, i);
+            cache = other->cache;
+        } else if (base::key == Energybase::ACCEPTED_MONTE_CARLO_STATE) {
+            for (auto &data : change.groups) {
+                if (!isIncremental(data)) {
+                    for (int i = 0; i < int(spc.groups.size()); ++i) {
+                        cache.set(data.index, i, other->cache(data.index, i));
+                    }
                 }
             }
+            for (auto &trial : other->partials) {
+                cache.set(trial.group1, trial.group2, cache(trial.group1, trial.group2) + trial.energy);
+            }
+            for (auto &accepted : partials) {
+                cache.set(accepted.group1, accepted.group2, cache(accepted.group1, accepted.group2) - accepted.energy);
+            }
+            other->copyRows(*this, change);
+        } else {
+            copyRows(*other, change);
         }
+        partials.clear();
+        other->partials.clear();
     }
 };
 
@@ -1232,11 +2403,58 @@ class Example2D : public Energybase {
     double energy(Change &change) override;
 };
 
+/**
+ * @brief Accepted-state energies of groups, used by `Hamiltonian` to avoid re-evaluating the accepted state
+ *
+ * A change of all particles in exactly one group, without internal changes, is a *ledger move*; typically
+ * a rigid translation or rotation. For such moves, and for energy terms with `GROUP` or `GROUP_PAIR`
+ * locality, the trial state records the energy of the moved group, or its energy with each of the other
+ * groups, while the accepted state looks the energy up instead of calculating it. Upon acceptance, the
+ * trial records replace the entries of the moved group. Other moves invalidate only the entries of the
+ * touched groups, whereas `all` and `dV` changes invalidate everything. Invalid entries are evaluated
+ * on demand by the accepted state, which for pairs of groups evaluates only the moved group with all
+ * others. The pair energies of each group are kept summed such that valid entries cost a single lookup.
+ */
+class EnergyLedger {
+    struct Record {
+        Energybase::Locality locality = Energybase::Locality::NONLOCAL;
+        std::vector<double> group_energy;     //!< GROUP: accepted energy of each group
+        std::vector<bool> group_is_valid;     //!< GROUP: valid entries in `group_energy`
+        PairMatrix<double, true> pair_energy; //!< GROUP_PAIR: accepted energy between groups
+        std::vector<double> row_energy;       //!< GROUP_PAIR: sum of the pair energies of each group
+        std::vector<size_t> row_evaluated;    //!< GROUP_PAIR: generation of the last evaluation of each group
+        std::vector<size_t> row_changed;      //!< GROUP_PAIR: generation of the last invalidation of each group
+        std::vector<size_t> stale_rows;       //!< GROUP_PAIR: groups invalidated since their last evaluation
+        std::vector<double> trial_energy;     //!< Trial state: energy of moved group, or with each group
+        bool has_trial_energy = false;        //!< Trial state: `trial_energy` belongs to the current move
+    };
+    std::vector<Record> records; //!< One record for each energy term
+    size_t lookups = 0;          //!< Number of accepted-state energies taken from the ledger
+    size_t generation = 0;       //!< Counts evaluations and invalidations of pair energies
+    Change row_change;           //!< Change of a single, whole group reused by `refreshRow()`
+
+    void setRow(Record &, size_t, const std::vector<double> &); //!< Store pair energies of a group with all others
+    void invalidateRow(Record &, size_t);                       //!< Mark pair energies of a group as invalid
+    bool rowIsValid(const Record &, size_t) const;              //!< True if all pair energies of a group are valid
+    void refreshRow(Energybase &, Record &, size_t);            //!< Evaluate pair energies of a group with all others
+
+  public:
+    EnergyLedger(const BasePointerVector<Energybase> &, size_t number_of_groups);
+    static int movedGroup(const Change &); //!< Index of the group changed in a ledger move; -1 if not a ledger move
+    double energy(size_t, Energybase &, Change &, int); //!< Energy of term with given index for ledger move
+    void invalidate();                                  //!< Invalidate all entries
+    void sync(EnergyLedger &, Change &, Energybase::keys);
+    void to_json(json &) const;
+};
+
 class Hamiltonian : public Energybase, public BasePointerVector<Energybase> {
   protected:
-    double maxenergy = pc::infty; //!< Maximum allowed energy change
+    double maxenergy = pc::infty;        //!< Maximum allowed energy change
+    std::optional<EnergyLedger> ledger; //!< Optional ledger of accepted-state group energies
     void to_json(json &) const override;
     void addEwald(const json &, Space &); //!< Adds an instance of reciprocal space Ewald energies (if appropriate)
+    template <typename TPairEnergy, bool parallel>
+    void addNonbonded(const json &, Space &); //!< Adds non-bonded energy; cached group energies if requested
     void force(PointVector &) override;
   public:
     Hamiltonian(Space &spc, const json &j);
@@ -16,6 +16,26 @@ void Energybase::sync(Energybase *, Change &) {}
 
 void Energybase::init() {}
 
+Energybase::Locality Energybase::locality() const { return Locality::NONLOCAL; }
+
+/**
+ * Terms with `GROUP` locality do not couple groups and are hence local at any distance whereas
+ * other terms must override this to tell the range of their interactions.
+ */
+bool Energybase::vanishesBeyond(double) const { return locality() == Locality::GROUP; }
+
+/**
+ * @param change Change of a single group
+ * @param energies Destination for the energy of the changed group with each group in the system,
+ *                 indexed as `Space::groups`; the entry of the group itself is zero
+ *
+ * Must be implemented by terms with `GROUP_PAIR` locality such that the sum of `energies`
+ * equals `energy(change)` for changes of all particles in a single group and no internal change.
+ */
+void Energybase::groupPairEnergies(Change &, std::vector<double> &) {
+    throw std::runtime_error(name + ": group pair energies not implemented");
+}
+
 void to_json(json &j, const Energybase &base) {
     assert(not base.name.empty());
     if (base.timer)
@@ -68,28 +88,96 @@ ExternalPotential::ExternalPotential(const json &j, Space &spc) : space(spc) {
         throw std::runtime_error(name + ": molecule list is empty");
     }
 }
+/**
+ * @param group_index Index of group to evaluate
+ * @return Energy of group in kT
+ *
+ * Inactive particles of the group are stored with zero energy.
+ */
+double ExternalPotential::updateGroupEnergy(size_t group_index) {
+    const auto &group = space.groups[group_index];
+    if (molecule_ids.find(group.id) == molecule_ids.end()) {
+        return 0.0;
+    }
+    if (act_on_mass_center and not group.atomic) {
+        return group_energy[group_index] = groupEnergy(group);
+    }
+    const auto offset = std::distance(space.p.begin(), group.begin());
+    const int capacity = std::distance(group.begin(), group.trueend());
+    const int size = group.size();
+    double energy = 0.0;
+    for (int i = 0; i < capacity; i++) {
+        const double u = (i < size) ? externalPotentialFunc(group[i]) : 0.0;
+        particle_energy[offset + i] = u;
+        energy += u;
+    }
+    return energy;
+}
+
+/**
+ * @param change Change object of the current move
+ * @param change_index Index of the changed group in `change.groups`
+ * @return Energy of the changed particles in kT
+ *
+ * The trial state evaluates the energies and stores them in the cache, whereas
+ * the accepted state merely looks them up. If the number of particles changes (`dN`),
+ * both states instead evaluate and cache the whole group: particles may have been
+ * activated or deactivated, and deletions in atomic groups (`SpeciationMove`) swap
+ * particles within the group of both states without listing all of them in the change.
+ */
+double ExternalPotential::changedEnergy(const Change &change, size_t change_index) {
+    const auto &group_change = change.groups[change_index];
+    const auto &group = space.groups.at(group_change.index);
+    if (molecule_ids.find(group.id) == molecule_ids.end()) {
+        return 0.0;
+    }
+    if (change.dN or group_change.dNatomic) {
+        return updateGroupEnergy(group_change.index);
+    }
+    const bool is_accepted = (key == ACCEPTED_MONTE_CARLO_STATE);
+    if (act_on_mass_center and not group.atomic) {
+        if (is_accepted) {
+            return group_energy[group_change.index];
+        }
+        return group_energy[group_change.index] = groupEnergy(group);
+    }
+    const auto offset = std::distance(space.p.begin(), group.begin());
+    const int size = group.size();
+    auto particle_energy_of = [&](int i) { // energy of i'th particle in group
+        if (is_accepted) {
+            return particle_energy[offset + i];
+        }
+        return particle_energy[offset + i] = (i < size) ? externalPotentialFunc(group[i]) : 0.0;
+    };
+    double energy = 0.0;
+    if (group_change.all or group_change.atoms.empty()) {
+        for (int i = 0; i < size; i++) {
+            energy += particle_energy_of(i);
+        }
+    } else {
+        for (int i : group_change.atoms) { // loop over changed atoms in group
+            energy += particle_energy_of(i);
+        }
+    }
+    return energy;
+}
+
 double ExternalPotential::energy(Change &change) {
     assert(externalPotentialFunc != nullptr);
+    if (particle_energy.size() != space.p.size() or group_energy.size() != space.groups.size()) {
+        init();
+    }
     double energy = 0.0;
-    if (change.dV or change.all or change.dN) {
-        for (auto &group : space.groups) { // loop over all groups
-            energy += groupEnergy(group);
+    if (change.dV or change.all) {
+        for (size_t i = 0; i < space.groups.size(); i++) { // loop over all groups
+            energy += updateGroupEnergy(i);
             if (not std::isfinite(energy)) {
                 break; // stop summing if not finite
             }
         }
     } else {
-        for (auto &group_change : change.groups) {             // loop over all changed groups
-            auto &group = space.groups.at(group_change.index); // check specified groups
-            if (group_change.all or act_on_mass_center) {      // check all atoms in group
-                energy += groupEnergy(group);                  // groupEnergy also checks for molecule id
-            } else {                                           // only specified atoms in group
-                if (molecule_ids.find(group.id) != molecule_ids.end()) {
-                    for (int index : group_change.atoms) { // loop over changed atoms in group
-                        energy += externalPotentialFunc(group[index]);
-                    }
-                }
-            }
+        for (size_t i = 0; i < change.groups.size(); i++) { // loop over all changed groups
+            energy += changedEnergy(change, i);
             if (not std::isfinite(energy)) {
                 break; // stop summing if not finite
             }
@@ -97,6 +185,49 @@ double ExternalPotential::energy(Change &change) {
     }
     return energy; // in kT
 }
+
+void ExternalPotential::init() {
+    particle_energy.assign(space.p.size(), 0.0);
+    group_energy.assign(space.groups.size(), 0.0);
+    for (size_t i = 0; i < space.groups.size(); i++) {
+        updateGroupEnergy(i);
+    }
+}
+
+/**
+ * Only the accepted state reads its cache and hence only an accepted move is synchronised. The
+ * energies of the changed groups are copied including inactive particles, which may have been
+ * activated or deactivated; whole groups are copied if the number of particles has changed.
+ */
+void ExternalPotential::sync(Energybase *basePtr, Change &change) {
+    if (key != ACCEPTED_MONTE_CARLO_STATE) {
+        return;
+    }
+    auto other = dynamic_cast<ExternalPotential *>(basePtr);
+    assert(other);
+    if (change.dV or change.all or other->particle_energy.size() != particle_energy.size() or
+        other->group_energy.size() != group_energy.size()) {
+        particle_energy = other->particle_energy;
+        group_energy = other->group_energy;
+        return;
+    }
+    for (const auto &group_change : change.groups) {
+        const auto &group = space.groups.at(group_change.index);
+        const auto offset = std::distance(space.p.begin(), group.begin());
+        group_energy[group_change.index] = other->group_energy[group_change.index];
+        if (group_change.all or group_change.atoms.empty() or change.dN or group_change.dNatomic) {
+            const auto capacity = std::distance(group.begin(), group.trueend());
+            std::copy_n(other->particle_energy.begin() + offset, capacity, particle_energy.begin() + offset);
+        } else {
+            for (int i : group_change.atoms) {
+                particle_energy[offset + i] = other->particle_energy[offset + i];
+            }
+        }
+    }
+}
+
+Energybase::Locality ExternalPotential::locality() const { return Locality::GROUP; }
+
 void ExternalPotential::to_json(json &j) const {
     j["molecules"] = molecule_names;
     j["com"] = act_on_mass_center;
@@ -125,6 +256,82 @@ TEST_CASE("[Faunus] ExternalPotential") {
         change.all = true; // if both particles have changed
         CHECK(pot.energy(change) == Approx(0.5 + 0.5));
     }
+
+    SUBCASE("Cached energies") {
+        Space spc = j;
+        auto height = [](const Particle &particle) { return particle.pos.z(); };
+        ParticleSelfEnergy accepted(spc, height), trial(spc, height);
+        accepted.key = Energybase::ACCEPTED_MONTE_CARLO_STATE;
+        trial.key = Energybase::TRIAL_MONTE_CARLO_STATE;
+        accepted.init();
+        trial.init();
+        Change change;
+        change.groups.resize(1);
+        change.groups[0].index = 0;
+        change.groups[0].atoms = {1};
+        const double old_height = spc.p[1].pos.z();
+        spc.p[1].pos.z() = old_height + 2.0;
+        CHECK(trial.energy(change) == Approx(old_height + 2.0));
+        CHECK(accepted.energy(change) == Approx(old_height)); // looked up in the cache
+        accepted.sync(&trial, change);
+        CHECK(accepted.energy(change) == Approx(old_height + 2.0));
+
+        change.dN = true; // deactivate the second particle
+        spc.groups[0].deactivate(spc.groups[0].end() - 1, spc.groups[0].end());
+        CHECK(trial.energy(change) == Approx(0.0));
+        accepted.sync(&trial, change);
+        CHECK(accepted.energy(change) == Approx(0.0));
+    }
+
+    SUBCASE("Cached energies upon deletion from atomic group") {
+        Space old_spc, spc; // accepted and trial Space
+        for (auto space : {&old_spc, &spc}) {
+            space->geo = R"( {"type": "cuboid", "length": 100} )"_json;
+            space->p.resize(5);
+            for (size_t i = 0; i < space->p.size(); i++) {
+                space->p[i].pos = {0.0, 0.0, 1.0 + i * i};
+            }
+            Group<Particle> group(space->p.begin(), space->p.end());
+            group.atomic = true;
+            space->groups.push_back(group);
+        }
+        auto height = [](const Particle &particle) { return particle.pos.z(); };
+        ParticleSelfEnergy accepted(old_spc, height), trial(spc, height);
+        accepted.key = Energybase::ACCEPTED_MONTE_CARLO_STATE;
+        trial.key = Energybase::TRIAL_MONTE_CARLO_STATE;
+        accepted.init();
+        trial.init();
+        auto uncached_energy = [&](Space &space) { // fresh evaluation of all groups
+            ParticleSelfEnergy uncached(space, height);
+            Change change_all;
+            change_all.all = true;
+            return uncached.energy(change_all);
+        };
+
+        // as SpeciationMove::contractAtomicGroup(): swap the deleted particle to the end in both
+        // states, deactivate it in the trial state and list only the last index in the change
+        std::iter_swap(spc.p.begin() + 1, spc.p.end() - 1);
+        std::iter_swap(old_spc.p.begin() + 1, old_spc.p.end() - 1);
+        spc.groups[0].deactivate(spc.groups[0].end() - 1, spc.groups[0].end());
+        Change change;
+        change.dN = true;
+        auto &change_data = change.groups.emplace_back();
+        change_data.index = 0;
+        change_data.internal = true;
+        change_data.dNatomic = true;
+        change_data.atoms = {4};
+        const double energy_change = trial.energy(change) - accepted.energy(change);
+        CHECK(energy_change == Approx(uncached_energy(spc) - uncached_energy(old_spc)));
+
+        old_spc.sync(spc, change); // accept the deletion
+        accepted.sync(&trial, change);
+        Change move; // displace the particle swapped into the deleted particle's place
+        move.groups.emplace_back().index = 0;
+        move.groups[0].atoms = {1};
+        const double old_energy = uncached_energy(spc);
+        spc.p[1].pos.z() += 3.0;
+        CHECK(trial.energy(move) - accepted.energy(move) == Approx(uncached_energy(spc) - old_energy));
+    }
 }
 
 // ------------ Confine -------------
@@ -220,6 +427,8 @@ double ExternalAkesson::energy(Change &change) {
             }
             if (num_density_updates % nstep * phi_update_interval == 0) {
                 update_phi();
+                init(); // all cached energies refer to the previous potential
+                phi_is_updated = true;
             }
         }
     }
@@ -268,10 +477,17 @@ double ExternalAkesson::phi_ext(double z, double a) const {
            2 * z * (0.5 * pc::pi + std::asin((a2 * a2 - z2 * z2 - 2 * a2 * z2) / std::pow(a2 + z2, 2)));
 }
 
-void ExternalAkesson::sync(Energybase *basePtr, Change &) {
+Energybase::Locality ExternalAkesson::locality() const { return Locality::NONLOCAL; }
+
+void ExternalAkesson::sync(Energybase *basePtr, Change &change) {
+    ExternalPotential::sync(basePtr, change);
     if (not fixed_potential) {
         auto other = dynamic_cast<ExternalAkesson *>(basePtr);
         assert(other);
+        if (phi_is_updated) { // energies copied from the trial state refer to the previous potential
+            init();
+            phi_is_updated = false;
+        }
         if (other->key == ACCEPTED_MONTE_CARLO_STATE) { // only trial energy (new) requires sync
             if (num_density_updates != other->num_density_updates) {
                 assert(num_density_updates < other->num_density_updates);
@@ -405,20 +621,135 @@ CustomExternal::CustomExternal(const json &j, Space &spc) : ExternalPotential(j,
         expr->set(
             j,
             {{"q", &particle_data.charge}, {"x", &particle_data.x}, {"y", &particle_data.y}, {"z", &particle_data.z}});
-        externalPotentialFunc = [&](const Particle &a) {
-            particle_data.x = a.pos.x();
-            particle_data.y = a.pos.y();
-            particle_data.z = a.pos.z();
-            particle_data.charge = a.charge;
-            return expr->operator()();
+        externalPotentialFunc = [&](const Particle &a) { return evaluate(a.pos, a.charge); };
+        if (j.value("tabulate", true)) {
+            if (auto tabulated_function = createTabulatedFunction(j.value("utol", 1e-5), spc.geo)) {
+                externalPotentialFunc = tabulated_function;
+                tabulated = true;
+            }
+        }
+    }
+}
+
+double CustomExternal::evaluate(const Point &position, double charge) {
+    particle_data.x = position.x();
+    particle_data.y = position.y();
+    particle_data.z = position.z();
+    particle_data.charge = charge;
+    return expr->operator()();
+}
+
+/**
+ * The potential is written as u = u₀(r) + q·u₁(r) where u₀ and u₁ are tabulated
+ * in the box spanned by the geometry. Linearity in the charge is verified at all
+ * sampling points by evaluating the expression at two additional charges.
+ *
+ * @param utol Maximum absolute error of the tables (kT)
+ * @returns Function using the tables, or an empty function if tabulation is not possible
+ */
+std::function<double(const Particle &)> CustomExternal::createTabulatedFunction(double utol,
+                                                                                const Geometry::Chameleon &geometry) {
+    const std::array<bool, 3> active = {expr->depends("x"), expr->depends("y"), expr->depends("z")};
+    const auto num_active = std::count(active.begin(), active.end(), true);
+    if (num_active == 0) {
+        return nullptr; // no positional dependence; nothing to gain
+    }
+    const bool charged = expr->depends("q");
+    auto uncharged = [&](const Point &position) { return evaluate(position, 0.0); };
+    auto charge_slope = [&](const Point &position) {
+        const double u0 = evaluate(position, 0.0);
+        const double u1 = evaluate(position, 1.0) - u0;
+        for (const double charge : {-1.0, 2.0}) {
+            if (!(std::fabs(evaluate(position, charge) - (u0 + charge * u1)) <= utol)) {
+                throw std::runtime_error("expression is not linear in the charge");
+            }
+        }
+        return u1;
+    };
+    const Point half_box = 0.5 * geometry.getLength();
+    try {
+        if (num_active == 1) {
+            using Table = Tabulate::TabulatorBase<double>::data;
+            const auto dim = std::distance(active.begin(), std::find(active.begin(), active.end(), true));
+            auto generate = [&](auto function) {
+                auto along_axis = [&](double coordinate) {
+                    Point position = Point::Zero();
+                    position[dim] = coordinate;
+                    return function(position);
+                };
+                return std::make_shared<const Table>(spline.generate(along_axis, -half_box[dim], half_box[dim],
+                                                                     Tabulate::GridSpacing::SQUARED_DISTANCE));
+            };
+            spline.setTolerance(utol);
+            const auto u0 = generate(uncharged);
+            const auto u1 = charged ? generate(charge_slope) : nullptr;
+            faunus_logger->debug("{} splined along {} using {} knots", name, "xyz"[dim], u0->numKnots());
+            return [&, dim, u0, u1](const Particle &particle) {
+                const double coordinate = particle.pos[dim];
+                if (coordinate < u0->rmin2 || coordinate > u0->rmax2) {
+                    return evaluate(particle.pos, particle.charge);
+                }
+                return u1 ? spline.eval(*u0, coordinate) + particle.charge * spline.eval(*u1, coordinate)
+                          : spline.eval(*u0, coordinate);
+            };
+        }
+        using Table = Tabulate::Grid3D<double>::data;
+        auto generate = [&](auto function) {
+            auto at_point = [&](const Tabulate::Grid3D<double>::Point &point) {
+                return function(Point(point[0], point[1], point[2]));
+            };
+            return std::make_shared<const Table>(grid.generate(at_point, {-half_box.x(), -half_box.y(), -half_box.z()},
+                                                               {half_box.x(), half_box.y(), half_box.z()}, active));
+        };
+        grid.setTolerance(utol);
+        const auto u0 = generate(uncharged);
+        const auto u1 = charged ? generate(charge_slope) : nullptr;
+        faunus_logger->debug("{} interpolated on a {}x{}x{} grid", name, u0->nodes[0], u0->nodes[1], u0->nodes[2]);
+        return [&, u0, u1](const Particle &particle) {
+            const Tabulate::Grid3D<double>::Point point = {particle.pos.x(), particle.pos.y(), particle.pos.z()};
+            if (!u0->contains(point)) {
+                return evaluate(particle.pos, particle.charge);
+            }
+            return u1 ? grid.eval(*u0, point) + particle.charge * grid.eval(*u1, point) : grid.eval(*u0, point);
         };
+    } catch (std::exception &e) {
+        faunus_logger->debug("{} is evaluated as an expression: {}", name, e.what());
     }
+    return nullptr;
 }
 void CustomExternal::to_json(json &j) const {
     j = json_input_backup;
     ExternalPotential::to_json(j);
 }
 
+TEST_CASE("[Faunus] CustomExternal") {
+    using doctest::Approx;
+    Faunus::atoms = R"([{ "A": { "sigma": 4.0, "q": 1.0 } }])"_json.get<decltype(atoms)>();
+    Faunus::molecules = R"([{ "M": { "atoms": ["A"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    Space spc = R"({ "geometry": {"type": "cuboid", "length": [40, 50, 60] },
+                     "insertmolecules": [ { "M": { "N": 1 } } ] })"_json;
+    Change change;
+    change.all = true;
+    auto check = [&](const std::string &function, bool is_tabulated, auto exact) {
+        json input = {{"molecules", {"M"}}, {"function", function}};
+        CustomExternal pot(input, spc);
+        CHECK(pot.isTabulated() == is_tabulated);
+        for (const Point &position : {Point(0, 0, 0), Point(-20, 3.3, 29.9), Point(7.1, -25, -13), Point(0, 0, 31)}) {
+            for (const double charge : {-1.0, 0.5}) {
+                spc.p[0].pos = position; // (0,0,31) is outside the box and evaluated as an expression
+                spc.p[0].charge = charge;
+                CHECK(std::fabs(pot.energy(change) - exact(position, charge)) < 1e-4);
+            }
+        }
+    };
+    check("0.2 * q * z + cos(0.1 * z)", true,
+          [](const Point &p, double q) { return 0.2 * q * p.z() + std::cos(0.1 * p.z()); });
+    check("0.01 * x * y - 0.5 * q * z", true,
+          [](const Point &p, double q) { return 0.01 * p.x() * p.y() - 0.5 * q * p.z(); });
+    check("q * q * z", false, [](const Point &p, double q) { return q * q * p.z(); }); // not linear in q
+    check("q", false, [](const Point &, double q) { return q; });                      // no positional dependence
+}
+
 // ------------- ParticleSelfEnergy ---------------
 
 /*
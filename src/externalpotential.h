@@ -3,6 +3,7 @@
 #include "group.h"
 #include "aux/timers.h"
 #include "aux/equidistant_table.h"
+#include "tabulate.h"
 #include <set>
 
 template<typename T> class ExprFunction;
@@ -30,6 +31,19 @@ class Energybase {
     virtual void init();                                  //!< reset and initialize
     virtual inline void force(PointVector &){};           //!< update forces on all particles
     inline virtual ~Energybase() = default;
+
+    /**
+     * @brief Dependence of the energy of a single, entirely changed group on the rest of the system
+     * @see EnergyLedger
+     */
+    enum class Locality {
+        NONLOCAL,  //!< No assumptions; always evaluated
+        GROUP,     //!< Depends only on the group itself, e.g. an external potential
+        GROUP_PAIR //!< Sum of interactions with each of the other groups; see `groupPairEnergies()`
+    };
+    virtual Locality locality() const;                                //!< Defaults to `NONLOCAL`
+    virtual void groupPairEnergies(Change &, std::vector<double> &); //!< Energy of the single changed group with each group
+    virtual bool vanishesBeyond(double distance) const; //!< True if interactions between groups vanish beyond distance
 };
 
 void to_json(json &j, const Energybase &base); //!< Converts any energy class to json object
@@ -41,21 +55,31 @@ void to_json(json &j, const Energybase &base); //!< Converts any energy class to
  * atoms or the mass-center. The specific energy function, `externalPotentialFunc`
  * is defined in derived classes.
  *
- * @todo The `dN` check is inefficient as it calculates the external potential on *all* particles.
+ * The energy of each particle, or of each group when acting on the mass-center, is cached.
+ * Upon changes of groups or particles, including insertions and deletions (`dN`), only the
+ * changed particles are evaluated and stored in the trial state, while the accepted state
+ * looks them up in its cache. Accepted changes are copied to the accepted state by `sync()`.
  */
 class ExternalPotential : public Energybase {
   private:
     bool act_on_mass_center = false;                   //!< apply only on center-of-mass
     std::set<int> molecule_ids;                        //!< ids of molecules to act on
     std::vector<std::string> molecule_names;           //!< corresponding names of molecules to act on
+    std::vector<double> particle_energy;               //!< energy of each particle; zero if inactive or not acted on
+    std::vector<double> group_energy;                  //!< energy of each group acted on at the mass-center
     double groupEnergy(const Group<Particle> &) const; //!< external potential on a single group
+    double updateGroupEnergy(size_t);                  //!< evaluate and cache the energy of a whole group
+    double changedEnergy(const Change &, size_t);      //!< energy of changed particles; cached if accepted state
   protected:
     Space &space;                                                            //!< reference to simulation space
     std::function<double(const Particle &)> externalPotentialFunc = nullptr; //!< energy of single particle
   public:
     ExternalPotential(const json &, Space &);
     double energy(Change &) override;
+    void init() override;                       //!< Evaluate and cache the energies of all particles
+    void sync(Energybase *, Change &) override; //!< Copy the accepted energies of changed particles
     void to_json(json &) const override;
+    Locality locality() const override;
 };
 
 /**
@@ -73,6 +97,11 @@ std::function<double(const Particle &)> createGouyChapmanPotential(const json &j
 
 /**
  * @brief Custom external potential on molecules
+ *
+ * Expressions that depend on positions and at most linearly on the charge are
+ * sampled in the box spanned by the geometry: a single coordinate is splined
+ * while two or three coordinates are interpolated on a regular grid. The expression
+ * is evaluated outside the box or if the tolerance cannot be met.
  */
 class CustomExternal : public ExternalPotential {
   private:
@@ -82,10 +111,16 @@ class CustomExternal : public ExternalPotential {
     };
     ParticleData particle_data;
     json json_input_backup; // initial json input
+    Tabulate::Equidistant<double> spline; //!< Expressions of a single coordinate
+    Tabulate::Grid3D<double> grid;        //!< Expressions of two or three coordinates
+    bool tabulated = false;
+    double evaluate(const Point &position, double charge); //!< Evaluate expression
+    std::function<double(const Particle &)> createTabulatedFunction(double utol, const Geometry::Chameleon &);
 
   public:
     CustomExternal(const json &, Space &);
     void to_json(json &) const override;
+    bool isTabulated() const { return tabulated; } //!< True if the expression is (partly) replaced by a table
 };
 
 /**
@@ -107,6 +142,7 @@ class ExternalAkesson : public ExternalPotential {
     unsigned int phi_update_interval = 0;            //!< Distance between phi updating
     unsigned int num_rho_updates = 0;                //!< Number of time rho has been updated
     unsigned int num_density_updates = 0;            //!< Number of charge density updates
+    bool phi_is_updated = false;                     //!< True if phi has been updated since the last sync
     double dielectric_constant;                      //!< Relative dielectric constant
     double dz;                                       //!< z spacing between slits (A)
     double bjerrum_length;                           //!< Bjerrum length (A)
@@ -126,6 +162,7 @@ class ExternalAkesson : public ExternalPotential {
   public:
     ExternalAkesson(const json &, Space &);
     double energy(Change &) override;
+    Locality locality() const override; //!< The mean field is updated during the simulation
     ~ExternalAkesson();
 };
 
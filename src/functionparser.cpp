@@ -2,6 +2,13 @@
 #include "functionparser.h"
 #include <exprtk.hpp> // https://github.com/ArashPartow/exprtk
 #include <nlohmann/json.hpp>
+#include <algorithm>
+#include <cctype>
+
+static std::string toLower(std::string str) {
+    std::transform(str.begin(), str.end(), str.begin(), [](unsigned char c) { return std::tolower(c); });
+    return str;
+}
 
 template<typename T>
 void ExprFunction<T>::set(const std::string &exprstr, const Tvarvec &vars, const Tconstvec &consts) {
@@ -19,6 +26,9 @@ void ExprFunction<T>::set(const std::string &exprstr, const Tvarvec &vars, const
     expression->register_symbol_table(*symbols);
     if (! parser->compile(exprstr, *expression))
         throw std::runtime_error("error passing function/expression");
+    used_symbols.clear();
+    used_symbols_known = exprtk::collect_variables(exprstr, used_symbols);
+    std::transform(used_symbols.begin(), used_symbols.end(), used_symbols.begin(), toLower);
 }
 
 template<typename T>
@@ -36,6 +46,15 @@ T ExprFunction<T>::operator()() const {
     return expression->value();
 }
 
+/**
+ * Symbols are case insensitive as in ExprTk. Should the expression not be inspectable,
+ * `true` is returned such that callers never assume independence by mistake.
+ */
+template <typename T> bool ExprFunction<T>::depends(const std::string &symbol) const {
+    return !used_symbols_known ||
+           std::find(used_symbols.begin(), used_symbols.end(), toLower(symbol)) != used_symbols.end();
+}
+
 template class ExprFunction<double>;
 
 TEST_CASE("[Faunus] ExprFunction") {
@@ -46,4 +65,7 @@ TEST_CASE("[Faunus] ExprFunction") {
     std::function<double()> f = expr;
     x = 4;
     CHECK(f() == doctest::Approx(4 * 4 + 0.4));
+    CHECK(expr.depends("x"));
+    CHECK(expr.depends("X"));
+    CHECK_FALSE(expr.depends("y"));
 }
@@ -1,6 +1,8 @@
 #pragma once
 
 #include <string>
+#include <vector>
+#include <memory>
 #include <nlohmann/json_fwd.hpp>
 
 namespace exprtk { // exprtk.hpp
@@ -21,11 +23,14 @@ class ExprFunction {
     std::shared_ptr<exprtk::symbol_table<T>> symbols;
     typedef std::vector<std::pair<std::string, T*>> Tvarvec;
     typedef std::vector<std::pair<std::string, T>> Tconstvec;
+    std::vector<std::string> used_symbols; // lower case symbols appearing in the expression
+    bool used_symbols_known = false;       // false if the expression could not be inspected
 
   public:
     void set(const std::string &exprstr, const Tvarvec &vars = {}, const Tconstvec &consts = {});
     void set(const nlohmann::json &, const Tvarvec &vars = {});
     T operator()() const;
+    bool depends(const std::string &symbol) const; //!< True if symbol appears in expression (or if unknown)
 };
 
 extern template class ExprFunction<double>;
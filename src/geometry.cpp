@@ -1046,6 +1046,9 @@ TEST_CASE("[Faunus] Chameleon") {
             CHECK(d_cham.y() == Approx(d_geo.y()));
             CHECK(d_cham.z() == Approx(d_geo.z()));
             CHECK(chameleon.sqdist(a, b) == Approx(d_cham.squaredNorm()));
+            double squared_distance;
+            chameleon.sqdist(a, &b.x(), &b.y(), &b.z(), 1, &squared_distance); // structure-of-arrays version
+            CHECK(squared_distance == Approx(d_cham.squaredNorm()));
         }
     };
 
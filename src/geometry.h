@@ -346,6 +346,8 @@ class Chameleon : public GeometryBase {
     void boundary(Point &) const override;                    //!< Apply boundary conditions
     Point vdist(const Point &, const Point &) const override; //!< (Minimum) distance between two points
     double sqdist(const Point &, const Point &) const;        //!< (Minimum) squared distance between two points
+    void sqdist(const Point &, const double *x, const double *y, const double *z, size_t size,
+                double *squared_distances) const; //!< (Minimum) squared distances between a point and an array
     void randompos(Point &, Random &) const override;
     bool collision(const Point &) const override;
     void from_json(const json &) override;
@@ -449,6 +451,40 @@ inline double Chameleon::sqdist(const Point &a, const Point &b) const {
     }
 }
 
+/**
+ * @param a Point to measure from
+ * @param x Array of x coordinates
+ * @param y Array of y coordinates
+ * @param z Array of z coordinates
+ * @param size Number of elements in the coordinate arrays
+ * @param squared_distances Output array of at least `size` elements
+ *
+ * Coordinates are given as structure-of-arrays (see `ParticleArrays`) and for
+ * orthogonal boundaries the minimum image convention is applied without branching
+ * such that the loop can be vectorized by the compiler.
+ */
+inline void Chameleon::sqdist(const Point &a, const double *x, const double *y, const double *z, size_t size,
+                              double *squared_distances) const {
+    if (geometry->boundary_conditions.coordinates == ORTHOGONAL) {
+        const double ax = a.x(), ay = a.y(), az = a.z();
+        const double hx = len_half.x(), hy = len_half.y(), hz = len_half.z();
+        const double lx = len_or_zero.x(), ly = len_or_zero.y(), lz = len_or_zero.z();
+        for (size_t i = 0; i < size; ++i) {
+            double dx = std::fabs(ax - x[i]);
+            double dy = std::fabs(ay - y[i]);
+            double dz = std::fabs(az - z[i]);
+            dx -= lx * static_cast<double>(dx > hx); // casting faster than branching
+            dy -= ly * static_cast<double>(dy > hy);
+            dz -= lz * static_cast<double>(dz > hz);
+            squared_distances[i] = dx * dx + dy * dy + dz * dz;
+        }
+    } else {
+        for (size_t i = 0; i < size; ++i) {
+            squared_distances[i] = geometry->vdist(a, {x[i], y[i], z[i]}).squaredNorm();
+        }
+    }
+}
+
 void to_json(json &, const Chameleon &);
 void from_json(const json &, Chameleon &);
 
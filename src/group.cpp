@@ -377,7 +377,7 @@ TEST_CASE("[Faunus] Group") {
             CHECK(g1.begin()->id == 8);
             CHECK(p1.front().id == 8);
             CHECK(p1.back().pos.x() == -10);
-            CHECK(p1.back().ext == nullptr);
+            CHECK(p1.back().hasExtension() == false);
         }
     }
 }
@@ -1,8 +1,12 @@
+#include <doctest/doctest.h>
 #include "montecarlo.h"
 #include "speciation.h"
 #include "energy.h"
 #include "move.h"
 #include "spdlog/spdlog.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
 
 namespace Faunus {
 
@@ -36,16 +40,18 @@ bool MetropolisMonteCarlo::metropolis(double energy_change) {
  */
 void MetropolisMonteCarlo::init() {
     sum_of_energy_changes = 0;
-    Change change;
+    change.clear();
     change.all = true;
 
     state->pot->key = Energy::Energybase::ACCEPTED_MONTE_CARLO_STATE;    // this is the old energy (current, accepted)
     trial_state->pot->key = Energy::Energybase::TRIAL_MONTE_CARLO_STATE; // this is the new energy (trial)
 
+    state->spc->updateParticleArrays(change);
     state->pot->init();
     double energy = state->pot->energy(change);
     initial_energy = energy;
 
+    state->spc->journal.enable(use_journal);
     trial_state->sync(*state, change); // copy all information into trial state
     trial_state->pot->init();
     double trial_energy = trial_state->pot->energy(change);
@@ -58,6 +64,19 @@ void MetropolisMonteCarlo::init() {
         }
     }
 
+    if (!lanes.empty()) {
+        speculation_seed = Move::Movebase::slump.engine();
+        step = 0;
+        for (auto &lane : lanes) {
+            lane.state.pot->key = Energy::Energybase::ACCEPTED_MONTE_CARLO_STATE;
+            lane.trial_state.pot->key = Energy::Energybase::TRIAL_MONTE_CARLO_STATE;
+            lane.state.spc->sync(*state->spc, change); // only the Space of the accepted state is copied...
+            lane.state.pot->init();
+            lane.trial_state.sync(lane.state, change); // ...as terms sync only between trial and accepted states
+            lane.trial_state.pot->init();
+        }
+    }
+
     // Inject reference to Space into `SpeciationMove`
     // Needed to calc. differences in ideal excess chem. potentials
     for (auto speciation_move : moves->moves().find<Move::SpeciationMove>()) {
@@ -95,14 +114,76 @@ double MetropolisMonteCarlo::relativeEnergyDrift() {
 
 MetropolisMonteCarlo::MetropolisMonteCarlo(const json &j, MPI::MPIController &mpi)
     : original_log_level(faunus_logger->level()) {
+    use_journal = j.value("mcloop", json::object()).value("journal", false);
     state = std::make_shared<State>(j);
     faunus_logger->set_level(spdlog::level::off); // do not duplicate log info
-    trial_state = std::make_shared<State>(j);     // ...for the trial state
+    if (use_journal) {                            // ...for the trial state
+        trial_state = std::make_shared<State>();
+        trial_state->spc = state->spc; // moves operate on the accepted Space
+        trial_state->pot = std::make_shared<Energy::Hamiltonian>(*trial_state->spc, j.at("energy"));
+    } else {
+        trial_state = std::make_shared<State>(j);
+    }
     faunus_logger->set_level(original_log_level); // restore original log level
     moves = std::make_shared<Move::Propagator>(j, *trial_state->spc, *trial_state->pot, mpi);
+    if (use_journal) {
+        checkJournalSupport();
+    }
+    if (const int number_of_lanes = j.value("mcloop", json::object()).value("speculative", 0); number_of_lanes > 0) {
+        checkSpeculationSupport();
+        faunus_logger->set_level(spdlog::level::off);
+        lanes.resize(number_of_lanes);
+        for (auto &lane : lanes) {
+            from_json(j, lane.state);
+            from_json(j, lane.trial_state);
+            lane.moves = std::make_shared<Move::Propagator>(j, *lane.trial_state.spc, *lane.trial_state.pot, mpi);
+        }
+        faunus_logger->set_level(original_log_level);
+    }
     init();
 }
 
+/**
+ * Moves that change the number of particles rely on both the old and the trial Space,
+ * and parallel tempering exchanges complete states; neither records its changes in the journal.
+ * Volume scaling triggers, e.g. of `Confine` with `scale: true`, are registered on the shared
+ * Space by both Hamiltonians and modify data that the journal cannot restore.
+ */
+void MetropolisMonteCarlo::checkJournalSupport() {
+    if (!state->spc->scaleVolumeTriggers.empty()) {
+        throw ConfigurationError("energy terms scaled with the volume cannot be used with the mcloop journal");
+    }
+    if (!moves->moves().find<Move::SpeciationMove>().empty()) {
+        throw ConfigurationError("speciation moves cannot be used with the mcloop journal");
+    }
+#ifdef ENABLE_MPI
+    if (!moves->moves().find<Move::ParallelTempering>().empty()) {
+        throw ConfigurationError("parallel tempering cannot be used with the mcloop journal");
+    }
+#endif
+}
+
+/**
+ * A lane must propose exactly the same step as the accepted state would, given the same random numbers,
+ * and the lanes run concurrently. This holds for the atomic and molecular translation and rotation moves
+ * which depend on nothing but the particles and the random number stream.
+ */
+void MetropolisMonteCarlo::checkSpeculationSupport() {
+    if (use_journal) {
+        throw ConfigurationError("speculative moves cannot be used with the mcloop journal");
+    }
+#ifdef ENABLE_MPI
+    throw ConfigurationError("speculative moves cannot be used with MPI");
+#else
+    for (const auto &move : moves->moves()) {
+        if (!std::dynamic_pointer_cast<Move::AtomicTranslateRotate>(move) &&
+            !std::dynamic_pointer_cast<Move::TranslateRotate>(move)) {
+            throw ConfigurationError("{} cannot be used with speculative moves", move->name);
+        }
+    }
+#endif
+}
+
 /**
  * @todo Too many responsibilities; tidy up!
  */
@@ -123,9 +204,14 @@ void MetropolisMonteCarlo::restore(const json &j) {
     }
 }
 
-void MetropolisMonteCarlo::perform_move(std::shared_ptr<Move::Movebase> move) {
-    Change change;
-    move->move(change);
+/**
+ * @param move Move to perform
+ * @param lane If given, the energies are taken from this lane which has evaluated the very same step
+ * @return True if the move was accepted
+ */
+bool MetropolisMonteCarlo::perform_move(std::shared_ptr<Move::Movebase> move, const SpeculativeLane *lane) {
+    bool accepted = false;
+    move->move(change); // clears the change object but keeps its memory
 #ifndef NDEBUG
     try {
         change.sanityCheck(state->spc->groups);
@@ -133,10 +219,17 @@ void MetropolisMonteCarlo::perform_move(std::shared_ptr<Move::Movebase> move) {
         throw std::runtime_error(e.what());
     }
 #endif
+    auto &journal = state->spc->journal; // undo log if trial and old states share a Space
     if (change) {
         latest_move = move;
-        double trial_energy = trial_state->pot->energy(change);    // trial potential energy (kT)
-        double energy = state->pot->energy(change);                // potential energy before move (kT)
+        trial_state->spc->updateParticleArrays(change); // moves modify only the particle vector
+        assert(lane == nullptr || lane->change.groups.size() == change.groups.size());
+        double trial_energy = lane ? lane->trial_energy : trial_state->pot->energy(change); // trial energy (kT)
+        if (use_journal) {
+            journal.swap(*state->spc); // restore configuration before move...
+            state->spc->updateParticleArrays(change);
+        }
+        double energy = lane ? lane->energy : state->pot->energy(change); // potential energy before move (kT)
         double du = trial_energy - energy;                         // potential energy change (kT)
         if (std::isnan(energy) and not std::isnan(trial_energy)) { // if NaN --> finite energy change
             du = pc::neg_infty;                                    // ...always accept
@@ -152,9 +245,23 @@ void MetropolisMonteCarlo::perform_move(std::shared_ptr<Move::Movebase> move) {
             // throw exception here?
         }
         if (metropolis(du + move_bias + density_bias)) { // accept move
+            if (use_journal) {
+                journal.swap(*state->spc); // ...and return to the trial configuration
+                journal.commit();
+                state->spc->updateParticleArrays(change);
+            }
+            if (lane) { // let both Hamiltonians update as without lane, e.g. Ewald k-vectors and cached energies
+                trial_state->pot->energy(change);
+                state->pot->energy(change);
+            }
             state->sync(*trial_state, change);
             move->accept(change);
+            accepted = true;
         } else { // reject move
+            if (use_journal) {
+                journal.rollback(*state->spc);
+                state->spc->updateParticleArrays(change);
+            }
             trial_state->sync(*state, change);
             move->reject(change);
             du = 0.0;
@@ -164,10 +271,86 @@ void MetropolisMonteCarlo::perform_move(std::shared_ptr<Move::Movebase> move) {
             average_energy += initial_energy + sum_of_energy_changes; // update average potential energy
         }
     } else {
+        if (use_journal) {
+            journal.rollback(*state->spc); // the move may have recorded without changing anything
+        }
         // The `metropolis()` function propagates the engine and we need to stay in sync
         // Alternatively, we could use `engine.discard()`
         Move::Movebase::slump();
     }
+    return accepted;
+}
+
+/**
+ * Seeds the random number generator of the moves in the calling thread such that every step
+ * has its own, reproducible stream
+ */
+static void seedStepStream(unsigned int seed, unsigned long step) {
+    std::seed_seq sequence{seed, static_cast<unsigned int>(step), static_cast<unsigned int>(step >> 32U)};
+    Move::Movebase::slump.engine.seed(sequence);
+}
+
+void MetropolisMonteCarlo::SpeculativeLane::evaluate(unsigned int seed, unsigned long step) {
+    seedStepStream(seed, step);
+    change.clear();
+    if (auto move_it = moves->sample(); move_it != moves->end()) {
+        (*move_it)->move(change);
+        if (change) {
+            trial_state.spc->updateParticleArrays(change);
+            trial_energy = trial_state.pot->energy(change);
+            energy = state.pot->energy(change);
+            trial_state.sync(state, change); // discard the step
+        }
+    }
+}
+
+/**
+ * Energy terms synchronise only from a trial to an accepted state, or vice versa, and may modify
+ * both states when doing so. Each lane therefore replays the accepted step on its own states, as
+ * `perform_move()` does: the changed particles are copied into the lane's trial Space and both lane
+ * Hamiltonians are evaluated before the lane's accepted state is synchronised with its trial state.
+ * The main states are only read.
+ */
+void MetropolisMonteCarlo::syncLanes(Change &accepted_change) {
+#pragma omp parallel for schedule(static, 1)
+    for (int k = 0; k < static_cast<int>(lanes.size()); k++) {
+        auto &lane = lanes[k];
+        lane.trial_state.spc->sync(*state->spc, accepted_change);
+        lane.trial_state.pot->energy(accepted_change);
+        lane.state.pot->energy(accepted_change);
+        lane.state.sync(lane.trial_state, accepted_change);
+    }
+}
+
+/**
+ * Each step draws its random numbers from its own stream, seeded by the step number. All lanes
+ * therefore start from the accepted state and concurrently propose and evaluate one of the
+ * following steps each. The steps are then performed in order on the accepted state, taking the
+ * energies from the lanes, until a step is accepted; the lanes' remaining evaluations refer to
+ * an outdated state and are discarded. The outcome is identical to performing the steps one by one
+ * and independent of the number of lanes and threads. The speed-up is largest for low acceptance;
+ * as all evaluations after an accepted step are discarded, including those that do not conflict
+ * with it, no more than about 1 / (acceptance ratio) steps are completed per batch.
+ */
+void MetropolisMonteCarlo::speculativeMove() {
+    int remaining_steps = moves->repeat();
+    while (remaining_steps > 0) {
+        const int batch_size = std::min(remaining_steps, static_cast<int>(lanes.size()));
+#pragma omp parallel for schedule(static, 1)
+        for (int k = 0; k < batch_size; k++) {
+            lanes[k].evaluate(speculation_seed, step + k);
+        }
+        for (int k = 0; k < batch_size; k++) {
+            remaining_steps--;
+            seedStepStream(speculation_seed, step++);
+            if (auto move_it = moves->sample(); move_it != moves->end()) {
+                if (perform_move(*move_it, &lanes[k])) {
+                    syncLanes(change);
+                    break;
+                }
+            }
+        }
+    }
 }
 
 /**
@@ -186,14 +369,25 @@ void MetropolisMonteCarlo::perform_move(std::shared_ptr<Move::Movebase> move) {
  */
 void MetropolisMonteCarlo::move() {
     assert(moves);
-    for (int i = 0; i < moves->repeat(); i++) {
-        if (auto move_it = moves->sample(); move_it != moves->end()) { // pick random move
-            perform_move(*move_it);
+    if (lanes.empty()) {
+        for (int i = 0; i < moves->repeat(); i++) {
+            if (auto move_it = moves->sample(); move_it != moves->end()) { // pick random move
+                perform_move(*move_it);
+            }
         }
+    } else {
+        speculativeMove();
     }
     // run _hidden_ moves (weight=0) exactly once per MC sweep
     for (auto move : moves->defusedMoves()) {
-        perform_move(move);
+        if (lanes.empty()) {
+            perform_move(move);
+        } else {
+            seedStepStream(speculation_seed, step++);
+            if (perform_move(move)) {
+                syncLanes(change);
+            }
+        }
     }
 }
 
@@ -305,4 +499,142 @@ double TranslationalEntropy::energy(const Change &change) {
     }
     return energy_change; // kT
 }
+#ifdef DOCTEST_LIBRARY_INCLUDED
+/**
+ * Runs a short simulation of a salt solution with energy terms that keep state between steps
+ * (cell list, energy ledger and cached external energies).
+ * @param mcloop Input for the `mcloop` section
+ * @param extra_energy Optional energy term added to the Hamiltonian
+ * @return Final particles and the potential energy
+ */
+static std::pair<ParticleVector, double> simulateSalt(const json &mcloop, const json &extra_energy = nullptr) {
+    atoms = R"([{ "A": { "q": 1.0, "sigma": 2.0, "eps": 0.5 } },
+                { "B": { "q": -1.0, "sigma": 3.0, "eps": 0.5 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "salt": { "atoms": ["A", "B"], "atomic": true } }])"_json.get<decltype(molecules)>();
+    json input = R"({
+        "geometry": {"type": "cuboid", "length": 30},
+        "insertmolecules": [{"salt": {"N": 20}}],
+        "energy": [
+            {"nonbonded_celllist": {"cutoff": 6, "default": [{"wca": {"mixing": "LB"}}]}},
+            {"nonbonded": {"default": [{"coulomb": {"epsr": 80, "type": "plain"}}]}},
+            {"customexternal": {"molecules": ["salt"], "function": "0.01 * (x^2 + y^2)"}},
+            {"ledger": true}],
+        "moves": [{"transrot": {"molecule": "salt", "dp": 3.0, "repeat": "N"}}]})"_json;
+    input["mcloop"] = mcloop;
+    if (!extra_energy.is_null()) {
+        input["energy"].push_back(extra_energy);
+    }
+    Faunus::random.engine.seed(17); // positions of inserted molecules
+    Move::Movebase::slump.engine.seed(17);
+    MetropolisMonteCarlo simulation(input, MPI::mpi);
+    for (int sweep = 0; sweep < 10; sweep++) {
+        simulation.move();
+    }
+    CHECK(std::fabs(simulation.relativeEnergyDrift()) < 1e-6);
+    Change change;
+    change.all = true;
+    const double energy = simulation.getHamiltonian().energy(change);
+    Energy::Hamiltonian reference(simulation.getSpace(), input.at("energy")); // without cached energies
+    CHECK(energy == doctest::Approx(reference.energy(change)));
+    return {simulation.getSpace().p, energy};
+}
+
+TEST_CASE("[Faunus] MetropolisMonteCarlo") {
+    using doctest::Approx;
+    auto check_identical = [](const auto &simulation, const auto &other_simulation) {
+        REQUIRE(simulation.first.size() == other_simulation.first.size());
+        for (size_t i = 0; i < simulation.first.size(); i++) {
+            CHECK(simulation.first[i].pos == other_simulation.first[i].pos);
+        }
+        CHECK(simulation.second == Approx(other_simulation.second));
+    };
+
+    SUBCASE("Journal gives the same trajectory as two states") {
+        const auto two_states = simulateSalt(json::object());
+        const auto journal = simulateSalt(R"({"journal": true})"_json);
+        check_identical(two_states, journal);
+        for (const std::string scheme : {"PBC", "SPME"}) { // reciprocal space is updated from the journal
+            json coulomb = R"({"type": "ewald", "epsr": 80, "cutoff": 10, "alpha": 0.3, "ncutoff": 5})"_json;
+            coulomb["ewaldscheme"] = scheme;
+            if (scheme == "SPME") {
+                coulomb["mesh"] = 16;
+                coulomb["order"] = 4;
+            }
+            json ewald = R"({"nonbonded": {"default": [{"coulomb": null}]}})"_json;
+            ewald["nonbonded"]["default"][0]["coulomb"] = coulomb;
+            check_identical(simulateSalt(json::object(), ewald), simulateSalt(R"({"journal": true})"_json, ewald));
+        }
+        const json confine = R"({"confine": {"type": "sphere", "radius": 40, "k": 1.0, "scale": true,
+                                             "molecules": ["salt"]}})"_json;
+        CHECK_THROWS_AS(simulateSalt(R"({"journal": true})"_json, confine), ConfigurationError);
+    }
+
+    SUBCASE("Speculative execution is independent of the number of lanes") {
+        // cached group energies are updated incrementally from both states upon acceptance
+        const json cached = R"({"nonbonded_cached": {"default": [{"coulomb": {"epsr": 80, "type": "plain"}}]}})"_json;
+        // the energy drift and the energy from scratch are checked without lanes, which draws other
+        // random numbers, and with lanes, where the main Hamiltonians see only accepted steps
+        const auto sequential = simulateSalt(json::object(), cached);
+        const auto one_lane = simulateSalt(R"({"speculative": 1})"_json, cached);
+        const auto three_lanes = simulateSalt(R"({"speculative": 3})"_json, cached);
+        check_identical(one_lane, three_lanes);
+        CHECK(sequential.first.size() == one_lane.first.size());
+    }
+}
+#endif
+
 } // namespace Faunus
+
+#if defined(DOCTEST_LIBRARY_INCLUDED) && !defined(DOCTEST_CONFIG_DISABLE)
+namespace {
+std::atomic<bool> count_allocations{false}; //!< Count calls to the global `operator new` if true
+std::atomic<size_t> allocation_count{0};    //!< Number of counted calls to the global `operator new`
+} // namespace
+
+/*
+ * Global allocation functions counting allocations for the test below. They exist only in builds
+ * with unittests and count nothing unless `count_allocations` is set.
+ */
+void *operator new(std::size_t size) {
+    if (count_allocations.load(std::memory_order_relaxed)) {
+        allocation_count.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (void *pointer = std::malloc(size > 0 ? size : 1)) {
+        return pointer;
+    }
+    throw std::bad_alloc();
+}
+void operator delete(void *pointer) noexcept { std::free(pointer); }
+void operator delete(void *pointer, std::size_t) noexcept { std::free(pointer); }
+
+TEST_CASE("[Faunus] MetropolisMonteCarlo without allocations") {
+    using namespace Faunus;
+    atoms = R"([{ "A": { "q": 1.0, "sigma": 2.0, "eps": 0.5, "dp": 2.0 } },
+                { "B": { "q": -1.0, "sigma": 3.0, "eps": 0.5, "dp": 2.0 } }])"_json.get<decltype(atoms)>();
+    molecules = R"([{ "salt": { "atoms": ["A", "B"], "atomic": true } },
+                    { "dimer": { "rigid": true, "structure": [{"A": [0.0, 0.0, 0.0]}, {"B": [3.0, 0.0, 0.0]}] } }])"_json
+                    .get<decltype(molecules)>();
+    const json input = R"({
+        "geometry": {"type": "cuboid", "length": 30},
+        "insertmolecules": [{"salt": {"N": 10}}, {"dimer": {"N": 10}}],
+        "energy": [
+            {"nonbonded": {"default": [{"coulomb": {"epsr": 80, "type": "plain"}}, {"wca": {"mixing": "LB"}}]}},
+            {"customexternal": {"molecules": ["salt", "dimer"], "function": "0.01 * (x^2 + y^2)"}},
+            {"ledger": true}],
+        "moves": [{"transrot": {"molecule": "salt", "repeat": "N"}},
+                  {"moltransrot": {"molecule": "dimer", "dp": 2.0, "dprot": 0.5, "repeat": "N"}}]})"_json;
+    Faunus::random.engine.seed(17);
+    Move::Movebase::slump.engine.seed(17);
+    MetropolisMonteCarlo simulation(input, MPI::mpi);
+    for (int sweep = 0; sweep < 10; sweep++) { // buffers and pooled memory grow to their final size
+        simulation.move();
+    }
+    allocation_count = 0;
+    count_allocations = true;
+    for (int sweep = 0; sweep < 10; sweep++) {
+        simulation.move();
+    }
+    count_allocations = false;
+    CHECK(allocation_count.load() == 0);
+}
+#endif
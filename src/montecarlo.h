@@ -32,6 +32,18 @@ class MPIController;
  * to the particle states (positions etc.), the simulation geometry (size, volume),
  * and the state of the Hamiltonian (wave-vectors for Ewald etc.).
  *
+ * If `journal` is enabled in the `mcloop` section, the two states share a single
+ * Space and moves record modified particles, groups and geometry in `Space::journal`.
+ * The Space is swapped between the trial and the old configuration to evaluate the
+ * two energies and rejected moves are rolled back from the journal. This halves the
+ * memory for particles and avoids copying all particles after volume moves.
+ * Moves that insert or delete particles, or exchange entire states, are not supported.
+ *
+ * If `speculative` in the `mcloop` section is set to a number of lanes, each lane holds
+ * a replica of the two states and of the moves. The following steps are proposed and
+ * evaluated concurrently from the accepted state and then performed in order using the
+ * precomputed energies until a step is accepted; see `speculativeMove()`.
+ *
  * @todo
  * The class has too many responsibilities, particularly in setting up the
  * system.
@@ -59,16 +71,39 @@ class MetropolisMonteCarlo {
     };
 
   private:
+    /**
+     * @brief Replica of the states and moves used to evaluate a step ahead of time
+     */
+    struct SpeculativeLane {
+        State state;                             //!< Copy of the accepted state
+        State trial_state;                       //!< Trial state on which the lane's moves operate
+        std::shared_ptr<Move::Propagator> moves; //!< Copy of all moves
+        Change change;                           //!< Change of the latest evaluated step
+        double energy = 0.0;                     //!< Potential energy before the step (kT)
+        double trial_energy = 0.0;               //!< Potential energy after the step (kT)
+        void evaluate(unsigned int seed, unsigned long step); //!< Propose and evaluate step, then discard it
+    };
+
     spdlog::level::level_enum original_log_level; //!< Storage for original loglevel
     std::shared_ptr<State> state;                 //!< The accepted MC state
     std::shared_ptr<State> trial_state;           //!< Proposed or trial MC state
     std::shared_ptr<Move::Propagator> moves;      //!< Storage for all registered MC moves
     std::shared_ptr<Move::Movebase> latest_move;  //!< Pointer to latest MC move
+    bool use_journal = false;                     //!< Use a single Space and an undo log (journal)
+    Change change;                                //!< Reused for all moves to avoid heap allocations
+    std::vector<SpeculativeLane> lanes;           //!< Lanes for speculative execution (empty if disabled)
+    unsigned int speculation_seed = 0;            //!< Seed common to the random number streams of all steps
+    unsigned long step = 0;                       //!< Number of steps performed in speculative mode
     double sum_of_energy_changes = 0.0;           //!< Sum of all potential energy changes
     double initial_energy = 0.0;                  //!< Initial potential energy
     Average<double> average_energy;               //!< Average potential energy of the system
     void init();                                  //!< Reset state
-    void perform_move(std::shared_ptr<Move::Movebase>); //!< Perform move using given move implementation
+    bool perform_move(std::shared_ptr<Move::Movebase>,
+                      const SpeculativeLane * = nullptr); //!< Perform move; true if accepted
+    void speculativeMove();                               //!< Perform all sampled moves of a sweep speculatively
+    void syncLanes(Change &);                             //!< Sync all lanes with the accepted state
+    void checkJournalSupport();                           //!< Throws if a move cannot be used with the journal
+    void checkSpeculationSupport();                       //!< Throws if a move cannot be evaluated speculatively
 
   public:
     MetropolisMonteCarlo(const json &, MPI::MPIController &);
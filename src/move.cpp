@@ -4,6 +4,7 @@
 #include "speciation.h"
 #include "clustermove.h"
 #include "chainmove.h"
+#include "domainmove.h"
 #include "forcemove.h"
 #include "montecarlo.h"
 #include "aux/iteratorsupport.h"
@@ -12,7 +13,7 @@
 
 namespace Faunus::Move {
 
-Random Movebase::slump; // static instance of Random (shared for all moves)
+thread_local Random Movebase::slump; // static instance of Random (shared for all moves in a thread)
 
 void Movebase::from_json(const json &j) {
     if (auto it = j.find("repeat"); it != j.end()) {
@@ -93,6 +94,7 @@ void ReplayMove::_from_json(const json &j) { reader = std::make_shared<XTCReader
 void ReplayMove::_move(Change &change) {
     assert(reader != nullptr);
     if (!end_of_trajectory) {
+        spc.journal.recordPositions(spc);
         if (reader->read(frame.step, frame.timestamp, frame.box, spc.positions().begin(), spc.positions().end())) {
             spc.geo.setLength(frame.box);
             change.all = true;
@@ -165,6 +167,8 @@ void AtomicTranslateRotate::translateParticle(ParticleVector::iterator particle,
 
 void AtomicTranslateRotate::_move(Change &change) {
     if (auto particle = randomAtom(); particle != spc.p.end()) {
+        spc.journal.recordParticles(spc, particle, particle + 1);
+        spc.journal.recordGroupData(spc, spc.groups[cdata.index]);
         double translational_displacement = atoms.at(particle->id).dp;
         double rotational_displacement = atoms.at(particle->id).dprot;
 
@@ -182,7 +186,7 @@ void AtomicTranslateRotate::_move(Change &change) {
         }
 
         if (translational_displacement > 0.0 or rotational_displacement > 0.0) {
-            change.groups.push_back(cdata); // add to list of moved groups
+            change.addGroup(cdata); // add to list of moved groups
         }
     } else {
         _sqd = 0.0; // no particle found --> no movement
@@ -264,7 +268,8 @@ Propagator::Propagator(const json &j, Space &spc, Energy::Hamiltonian &pot, MPI:
                 else if (it.key() == "langevin_dynamics") {
                     auto move_ptr = std::make_shared<Move::LangevinDynamics>(spc, pot);
                     _moves.push_back<Move::LangevinDynamics>(move_ptr);
-                }
+                } else if (it.key() == "checkerboard")
+                    _moves.emplace_back<Move::CheckerboardSweep>(spc, pot, j.at("energy"));
                 // new moves go here...
 #ifdef ENABLE_MPI
                 else if (it.key() == "temper") {
@@ -470,6 +475,7 @@ void VolumeMove::_move(Change &change) {
         Vold = spc.geo.getVolume();
         Vnew = std::exp(std::log(Vold) + (slump() - 0.5) * dV);
         deltaV = Vnew - Vold;
+        spc.journal.recordPositions(spc);
         spc.scaleVolume(Vnew, method->second);
     } else
         deltaV = 0;
@@ -504,11 +510,12 @@ void ChargeMove::_from_json(const json &j) {
 }
 void ChargeMove::_move(Change &change) {
     if (dq > 0) {
+        spc.journal.recordParticles(spc, spc.p.begin() + atomIndex, spc.p.begin() + atomIndex + 1);
         auto &p = spc.p[atomIndex]; // refence to particle
         double qold = p.charge;
         p.charge += dq * (slump() - 0.5);
         deltaq = p.charge - qold;
-        change.groups.push_back(cdata); // add to list of moved groups
+        change.addGroup(cdata); // add to list of moved groups
     } else
         deltaq = 0;
 }
@@ -636,6 +643,8 @@ void ChargeTransfer::_move(Change &change) {
                 mol2.changeQ.clear(); // clearing vector containing attempted charge moves on all atoms in molecule2
                 mol1.cdata.index = Faunus::distance(spc.groups.begin(), git1);
                 mol2.cdata.index = Faunus::distance(spc.groups.begin(), git2);
+                spc.journal.recordGroup(spc, *git1);
+                spc.journal.recordGroup(spc, *git2);
 
                 for (i = 0; i < mol1.numOfAtoms; i++) {
                     auto p = git1->begin() + i; // object containing atom i in molecule1
@@ -728,10 +737,10 @@ void ChargeTransfer::_move(Change &change) {
                         p->charge += mol2.changeQ[i];
                     }
                 }
-                mol1.cdata.all = true;               // change all atoms in molecule1
-                mol2.cdata.all = true;               // change all atoms in molecule2
-                change.groups.push_back(mol1.cdata); // add to list of moved groups
-                change.groups.push_back(mol2.cdata); // add to list of moved groups
+                mol1.cdata.all = true;       // change all atoms in molecule1
+                mol2.cdata.all = true;       // change all atoms in molecule2
+                change.addGroup(mol1.cdata); // add to list of moved groups
+                change.addGroup(mol2.cdata); // add to list of moved groups
 
             } else
                 deltaq = 0;
@@ -790,6 +799,7 @@ void QuadrantJump::_move(Change &change) {
         auto it = slump.sample(mollist.begin(), mollist.end());
         if (not it->empty()) {
             assert(it->id == molid);
+            spc.journal.recordGroup(spc, *it);
             Point oldcm = it->cm;
             if (index.size() == 2) {
                 auto cm_O = Geometry::massCenter(spc.p.begin() + index[0], spc.p.begin() + index[1] + 1,
@@ -861,11 +871,11 @@ void AtomicSwapCharge::_move(Change &change) {
     _sqd = 0.0;
     auto p = randomAtom();
     if (p != spc.p.end()) {
-        // auto &g = spc.groups[cdata.index];
+        spc.journal.recordParticles(spc, p, p + 1);
         double oldcharge = p->charge;
         p->charge = fabs(oldcharge - 1);
         _sqd = fabs(oldcharge - 1) - oldcharge;
-        change.groups.push_back(cdata);   // add to list of moved groups
+        change.addGroup(cdata);           // add to list of moved groups
         _bias = _sqd * (pH - pKa) * ln10; // one may add bias here...
     }
 }
@@ -925,6 +935,7 @@ void TranslateRotate::_move(Change &change) {
         auto it = slump.sample(mollist.begin(), mollist.end());
         if (not it->empty()) {
             assert(it->id == molid);
+            spc.journal.recordGroup(spc, *it);
 
             if (dptrans > 0) { // translate
                 Point oldcm = it->cm;
@@ -1140,6 +1151,7 @@ void SmartTranslateRotate::_move(Change &change) {
                         }
                     }
                 }
+                spc.journal.recordGroup(spc, *it);
                 if (dptrans > 0) { // translate
                     Point oldcm = it->cm;
                     Point dp = ranunit(slump, dir) * dptrans * slump();
@@ -1242,6 +1254,7 @@ void ConformationSwap::_move(Change &change) {
 
             newconfid = molecules[molid].conformations.getLastIndex();
 
+            spc.journal.recordGroup(spc, *g);
             std::copy(p.begin(), p.end(), g->begin()); // override w. new conformation
 #ifndef NDEBUG
             // this move shouldn't move mass centers, so let's check if this is true:
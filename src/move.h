@@ -32,10 +32,10 @@ class Movebase {
     unsigned long rejected = 0;
 
   public:
-    static Random slump; //!< Shared for all moves
-    std::string name;    //!< Name of move
-    std::string cite;    //!< Reference
-    int repeat = 1;      //!< How many times the move should be repeated per sweep
+    static thread_local Random slump; //!< Shared for all moves (one instance per thread)
+    std::string name;                 //!< Name of move
+    std::string cite;                 //!< Reference
+    int repeat = 1;                   //!< How many times the move should be repeated per sweep
 
     void from_json(const json &);
     void to_json(json &) const; //!< JSON report w. statistics, output etc.
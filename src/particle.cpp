@@ -72,29 +72,6 @@ const AtomData &Particle::traits() const { return atoms.at(id); }
  */
 Particle::Particle(const AtomData &a) { *this = json(a).front(); }
 Particle::Particle(const AtomData &a, const Point &pos) : Particle(a) { this->pos = pos; }
-Particle::Particle(const Particle &other) : id(other.id), charge(other.charge), pos(other.pos) {
-    if (other.ext) {
-        ext = std::make_shared<Particle::ParticleExtension>(*other.ext); // deep copy
-    }
-}
-
-Particle &Particle::operator=(const Particle &other) {
-    if (&other != this) {
-        charge = other.charge;
-        pos = other.pos;
-        id = other.id;
-        if (other.ext) {           // if particle has
-            if (ext) {             // extension, then
-                *ext = *other.ext; // deep copy
-            } else {               // else if *this is empty, create new based on p
-                ext = std::make_shared<Particle::ParticleExtension>(*other.ext); // create new
-            }
-        } else { // other doesn't have extended properties
-            ext = nullptr;
-        }
-    }
-    return *this;
-}
 
 /**
  * @param quaternion Quaternion used to rotate points
@@ -110,12 +87,11 @@ void Particle::rotate(const Eigen::Quaterniond &quaternion, const Eigen::Matrix3
     }
 }
 
-bool Particle::hasExtension() const { return ext != nullptr; }
+bool Particle::hasExtension() const { return static_cast<bool>(ext); }
 
 Particle::ParticleExtension &Particle::createExtension() {
-    assert(ext == nullptr && "extension already created");
-    ext = std::make_shared<ParticleExtension>();
-    return *ext;
+    assert(!ext && "extension already created");
+    return ext.emplace();
 }
 
 void from_json(const json &j, Particle &p) {
@@ -123,13 +99,12 @@ void from_json(const json &j, Particle &p) {
     p.pos = j.value("pos", Point(0, 0, 0));
     p.charge = j.value("q", 0.0);
 
-    p.ext = std::make_shared<Particle::ParticleExtension>();
-    from_json(j, *p.ext);
+    from_json(j, p.ext.emplace());
     Particle::ParticleExtension empty_extended_particle;
     // why can't we compare ParticleExtension directly?!
     // (slow and ugly)
     if (json(*p.ext) == json(empty_extended_particle))
-        p.ext = nullptr; // no extended features found in json
+        p.ext.reset(); // no extended features found in json
 }
 void to_json(json &j, const Particle &p) {
     if (p.ext) {
@@ -195,12 +170,29 @@ TEST_CASE("[Faunus] Particle") {
     CHECK(p1.getExt().Q(1, 2) == Approx(-2));
     CHECK(p1.getExt().Q(2, 2) == Approx(1));
 
+    SUBCASE("Copy") {
+        Particle p3(p1); // deep copy
+        CHECK(p3.hasExtension() == true);
+        CHECK(p3.getExt().mu == Point(0, 0, 1));
+        p3.getExt().mu = {1, 0, 0};
+        CHECK(p1.getExt().mu == Point(0, 0, 1));
+        p3 = Particle();
+        CHECK(p3.hasExtension() == false);
+        p3 = p1;
+        CHECK(p3.getExt().mu == Point(0, 0, 1));
+        if constexpr (decltype(p3.ext)::is_inline) {
+            auto address = reinterpret_cast<const char *>(&p3.getExt());
+            CHECK(address >= reinterpret_cast<const char *>(&p3));
+            CHECK(address < reinterpret_cast<const char *>(&p3 + 1));
+        }
+    }
+
     SUBCASE("Cereal serialisation") {
         Particle p;
         p.pos = {10, 20, 30};
         p.charge = -1;
         p.id = 8;
-        p.ext = std::make_shared<Particle::ParticleExtension>();
+        p.createExtension();
         p.getExt().mu = {0.1, 0.2, 0.3};
         p.getExt().mulen = 104;
 
@@ -156,30 +156,111 @@ template <typename... Properties> void from_json(const json &j, ParticleTemplate
     from_json<Properties...>(j, dynamic_cast<Properties &>(a)...);
 }
 
+/**
+ * @brief Optional storage of extended particle properties with value semantics
+ *
+ * Behaves as a nullable pointer to `T` but copies are deep. By default the
+ * properties are placed on the heap, only for particles that have them;
+ * assignment reuses existing memory, but copy construction allocates. If
+ * compiled with `FAUNUS_INLINE_EXTENSION` (CMake option `ENABLE_INLINE_EXTENSION`)
+ * the properties are stored inside the particle: this enlarges every particle
+ * but copying never allocates and access needs no pointer indirection, which
+ * is preferable for systems made mainly of dipolar or other anisotropic particles.
+ */
+template <class T> class ExtensionStorage {
+#ifdef FAUNUS_INLINE_EXTENSION
+    T value;
+    bool has_value = false;
+
+  public:
+    static constexpr bool is_inline = true; //!< True if stored inside the particle
+    explicit operator bool() const { return has_value; }
+    T *get() { return has_value ? &value : nullptr; }
+    const T *get() const { return has_value ? &value : nullptr; }
+    T &emplace() {
+        value = T();
+        has_value = true;
+        return value;
+    } //!< Create (or reset to) default properties
+    void reset() { has_value = false; }
+#else
+    std::unique_ptr<T> pointer;
+
+  public:
+    static constexpr bool is_inline = false; //!< True if stored inside the particle
+    ExtensionStorage() = default;
+    ExtensionStorage(const ExtensionStorage &other)
+        : pointer(other.pointer ? std::make_unique<T>(*other.pointer) : nullptr) {}
+    ExtensionStorage(ExtensionStorage &&) noexcept = default;
+    ExtensionStorage &operator=(ExtensionStorage &&) noexcept = default;
+    ExtensionStorage &operator=(const ExtensionStorage &other) {
+        if (!other.pointer) {
+            pointer.reset();
+        } else if (pointer) {
+            *pointer = *other.pointer; // reuse memory
+        } else {
+            pointer = std::make_unique<T>(*other.pointer);
+        }
+        return *this;
+    }
+    explicit operator bool() const { return pointer != nullptr; }
+    T *get() { return pointer.get(); }
+    const T *get() const { return pointer.get(); }
+    T &emplace() {
+        pointer = std::make_unique<T>();
+        return *pointer;
+    } //!< Create (or reset to) default properties
+    void reset() { pointer.reset(); }
+#endif
+    T &operator*() {
+        assert(get() != nullptr);
+        return *get();
+    }
+    const T &operator*() const {
+        assert(get() != nullptr);
+        return *get();
+    }
+    T *operator->() { return &**this; }
+    const T *operator->() const { return &**this; }
+
+    template <class Archive> void save(Archive &archive) const {
+        archive(static_cast<bool>(*this));
+        if (*this) {
+            archive(**this);
+        }
+    } //!< Cereal serialisation
+
+    template <class Archive> void load(Archive &archive) {
+        bool has_extension = false;
+        archive(has_extension);
+        if (has_extension) {
+            archive(emplace());
+        } else {
+            reset();
+        }
+    } //!< Cereal deserialisation
+};
+
 /**
  * @brief Particle class for storing positions, id, and other properties
  *
  * Particles carry `id`, `pos`, `charge` by default but can have additional
- * or _extended_ data stored using a different memory model. When serializing
- * from a json object, extended properties are automatically detected and
- * memory is automatically allocated
- *
- * @todo: memory model for extended properties not optimal
+ * or _extended_ data stored using a different memory model, see `ExtensionStorage`.
+ * When serializing from a json object, extended properties are automatically
+ * detected and memory is automatically allocated
  */
 class Particle {
   public:
     using ParticleExtension = ParticleTemplate<Dipole, Quadrupole, Cigar>;
-    std::shared_ptr<ParticleExtension> ext = nullptr; //!< Point to extended properties
-    int id = -1;                                      //!< Particle id/type
-    double charge = 0.0;                              //!< Particle charge
-    Point pos = {0.0, 0.0, 0.0};                      //!< Particle position vector
+    ExtensionStorage<ParticleExtension> ext; //!< Extended properties, if any
+    int id = -1;                             //!< Particle id/type
+    double charge = 0.0;                     //!< Particle charge
+    Point pos = {0.0, 0.0, 0.0};             //!< Particle position vector
 
     Particle() = default;
     Particle(const AtomData &a, const Point &pos);
-    Particle(const AtomData &a);           //!< construct from AtomData
-    Particle(const Particle &);            //!< copy constructor
-    Particle &operator=(const Particle &); //!< assignment operator
-    const AtomData &traits() const;        //!< get properties from AtomData
+    Particle(const AtomData &a);    //!< construct from AtomData
+    const AtomData &traits() const; //!< get properties from AtomData
     void rotate(const Eigen::Quaterniond &quaternion, const Eigen::Matrix3d &rotation_matrix); //!< internal rotation
     bool hasExtension() const;            //!< check if particle has extensions (dipole etc.)
     ParticleExtension &createExtension(); //!< Create extension
@@ -192,13 +273,8 @@ class Particle {
     /**
      * @brief Cereal serialisation
      * @param archive Archive to serialize to/from
-     * @warning Still under construction
      */
-    template <class Archive> void serialize(Archive &archive) {
-        archive(ext, id, charge, pos);
-        // if (ext != nullptr)
-        //    ext->serialize(archive);
-    } //!<
+    template <class Archive> void serialize(Archive &archive) { archive(ext, id, charge, pos); }
 };
 
 //! Storage type for collections of particles
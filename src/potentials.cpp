@@ -2,12 +2,58 @@
 #include "multipole.h"
 #include "units.h"
 #include "auxiliary.h"
+#include "random.h"
 #include "spdlog/spdlog.h"
 #include <coulombgalore.h>
+#include <nanobench.h>
 
 namespace Faunus {
 namespace Potential {
 
+#ifdef ANKERL_NANOBENCH_H_INCLUDED
+TEST_CASE("[Faunus] PairMatrix Benchmark") {
+    // lookup of pair data in a pair loop; nested vectors emulate the former PairMatrix storage
+    const size_t num_types = 10, num_particles = 1000;
+    PairMatrix<double> full(num_types);
+    PairMatrix<double, true> packed(num_types);
+    std::vector<std::vector<double>> nested(num_types, std::vector<double>(num_types));
+    for (size_t i = 0; i < num_types; i++) {
+        for (size_t j = 0; j < num_types; j++) {
+            full.set(i, j, double(i + j));
+            packed.set(i, j, double(i + j));
+            nested[i][j] = double(i + j);
+        }
+    }
+    Random random;
+    std::vector<size_t> ids(num_particles);
+    std::generate(ids.begin(), ids.end(), [&] { return random.range<size_t>(0, num_types - 1); });
+    auto pair_loop = [&](auto lookup) {
+        double sum = 0.0;
+        for (size_t i = 0; i < num_particles; i++) {
+            for (size_t j = i + 1; j < num_particles; j++) {
+                sum += lookup(ids[i], ids[j]);
+            }
+        }
+        return sum;
+    };
+    CHECK(pair_loop([&](size_t i, size_t j) { return full(i, j); }) ==
+          pair_loop([&](size_t i, size_t j) { return nested[i][j]; }));
+    CHECK(pair_loop([&](size_t i, size_t j) { return packed(i, j); }) ==
+          pair_loop([&](size_t i, size_t j) { return nested[i][j]; }));
+
+    double sum = 0.0; // keeps the loops from being optimized away
+    ankerl::nanobench::Config bench;
+    bench.minEpochIterations(5);
+    bench.run("nested vectors", [&] { sum += pair_loop([&](size_t i, size_t j) { return nested[i][j]; }); })
+        .doNotOptimizeAway();
+    bench.run("PairMatrix full", [&] { sum += pair_loop([&](size_t i, size_t j) { return full(i, j); }); })
+        .doNotOptimizeAway();
+    bench.run("PairMatrix packed", [&] { sum += pair_loop([&](size_t i, size_t j) { return packed(i, j); }); })
+        .doNotOptimizeAway();
+    CHECK(sum > 0.0);
+}
+#endif
+
 // =============== PairMixer ===============
 
 TCombinatorFunc PairMixer::getCombinator(CombinationRuleType combination_rule, CoefficientType coefficient) {
@@ -376,6 +422,64 @@ void CustomPairPotential::from_json(const json &j) {
     _j["Rc"] = std::sqrt(Rc2);
     _j["T"] = pc::temperature;
     expr.set(jin, {{"r", &d->r}, {"q1", &d->q1}, {"q2", &d->q2}, {"s1", &d->s1}, {"s2", &d->s2}});
+    knots = nullptr;
+    if (j.value("tabulate", true)) {
+        createKnots(j.value("utol", 1e-5), j.value("u_at_rmin", 20.0));
+    }
+}
+
+/**
+ * The spline is verified against the expression on a fine mesh and discarded if the
+ * error exceeds `utol` even after a second attempt with a tighter spline tolerance.
+ *
+ * @param utol Maximum absolute error of the spline (kT)
+ * @param energy_at_rmin Shorter distances where |u| exceeds this energy (kT) are not splined
+ */
+void CustomPairPotential::createKnots(double utol, double energy_at_rmin) {
+    if (!std::isfinite(Rc2)) {
+        return;
+    }
+    for (const auto symbol : {"q1", "q2", "s1", "s2"}) {
+        if (expr.depends(symbol)) {
+            return;
+        }
+    }
+    auto energy = [&](double r_squared) {
+        d->r = std::sqrt(r_squared);
+        return expr();
+    };
+    const double cutoff = std::sqrt(Rc2);
+    const double dr = 1e-3 * cutoff; // resolution of the lower bound and of the verification
+    double rmin = cutoff;
+    while (rmin > 2 * dr && std::fabs(energy(std::pow(rmin - dr, 2))) < energy_at_rmin) { // false if not finite
+        rmin -= dr;
+    }
+    if (rmin > cutoff - 10 * dr) {
+        return;
+    }
+    for (const double tolerance : {utol, 0.1 * utol}) {
+        spline.setTolerance(tolerance);
+        Tabulate::TabulatorBase<double>::data data;
+        try {
+            data = spline.generate(energy, rmin * rmin, Rc2);
+        } catch (std::exception &e) {
+            faunus_logger->debug("{}: {}", name, e.what());
+            break;
+        }
+        double max_error = 0.0;
+        for (double r = std::sqrt(data.rmin2) + 0.1 * dr; r <= cutoff && max_error <= utol; r += 0.1 * dr) {
+            const double error = std::fabs(spline.eval(data, r * r) - energy(r * r));
+            max_error = std::isfinite(error) ? std::max(error, max_error) : pc::infty;
+        }
+        if (max_error <= utol) {
+            faunus_logger->debug("{} splined between [{:.2f}:{:.2f}] {} using {} knots w. maximum absolute error of "
+                                 "{:.1E} kT",
+                                 name, std::sqrt(data.rmin2), cutoff, u8::angstrom, data.numKnots(), max_error);
+            knots = std::make_shared<const Tabulate::TabulatorBase<double>::data>(std::move(data));
+            return;
+        }
+    }
+    faunus_logger->debug("{} could not be splined and is evaluated as an expression", name);
 }
 
 void CustomPairPotential::to_json(json &j) const {
@@ -399,6 +503,24 @@ TEST_CASE("[Faunus] CustomPairPotential") {
                 "constants": { "kappa": 30, "lB": 7},
                 "function": "lB * q1 * q2 / (s1+s2) * exp(-kappa/r) * kT + pi"})"_json;
     CHECK(pot(a, b, 2 * 2, {0, 0, 2}) == Approx(-7 / (3.0 + 4.0) * std::exp(-30 / 2) * pc::kT() + pc::pi));
+
+    SUBCASE("Splined") {
+        auto yukawa = [](double r) { return 7.0 / r * std::exp(-r / 30.0) - 7.0 / 40.0 * std::exp(-40.0 / 30.0); };
+        json input = {{"function", "lB / r * exp(-r/D) - lB / Rc * exp(-Rc/D)"},
+                      {"cutoff", 40},
+                      {"constants", {{"D", 30}, {"lB", 7}}}};
+        CustomPairPotential splined = input;
+        input["tabulate"] = false;
+        CustomPairPotential exact = input;
+        for (double r : {0.05, 0.2, 0.5, 1.0, 2.3, 7.7, 20.0, 39.9, 40.0}) {
+            CHECK(std::fabs(splined(a, b, r * r, {0, 0, r}) - yukawa(r)) < 1e-5);
+            CHECK(exact(a, b, r * r, {0, 0, r}) == Approx(yukawa(r)));
+        }
+        CHECK(splined(a, b, 40.1 * 40.1, {0, 0, 40.1}) == 0.0);
+        CHECK(splined.isSplined());
+        CHECK_FALSE(exact.isSplined());
+        CHECK_FALSE(pot.isSplined()); // depends on charges and sigmas
+    }
 }
 
 // =============== Dummy ===============
@@ -654,49 +776,56 @@ void FunctorPotential::registerSelfEnergy(PairPotentialBase *pot) {
         faunus_logger->trace("Failed to register non-defined selfEnergy() for {}", pot->name);
 }
 
-FunctorPotential::uFunc FunctorPotential::combineFunc(json &j) {
-    uFunc u = [](const Particle &, const Particle &, double, const Point &) { return 0.0; };
+/**
+ * @param j json array of potentials, each given as a single-key object
+ * @return List with a copy of each potential; the pair energy is the sum over the list
+ */
+FunctorPotential::PotentialList FunctorPotential::combinePotentials(json &j) {
+    PotentialList potentials;
+    auto add = [&potentials](const auto &potential) {
+        potentials.emplace_back(std::in_place_type<std::decay_t<decltype(potential)>>, potential);
+    };
     if (j.is_array()) {
         for (auto &i : j) { // loop over all defined potentials in array
             if (i.is_object() and (i.size() == 1)) {
                 for (auto it : i.items()) {
-                    uFunc _u = nullptr;
+                    const auto num_potentials = potentials.size();
                     try {
                         if (it.key() == "custom")
-                            _u = CustomPairPotential() = it.value();
+                            add(CustomPairPotential() = it.value());
 
                         // add Coulomb potential and self-energy
                         // terms if not already added
                         else if (it.key() == "coulomb") { // temporary name
                             std::get<0>(potlist).from_json(it.value()); // initialize w. json object
                             std::get<0>(potlist).to_json(it.value());   // write back to json object with added values
-                            _u = std::get<0>(potlist);
+                            add(std::get<0>(potlist));
                             if (not have_monopole_self_energy) {
                                 registerSelfEnergy(&std::get<0>(potlist));
                                 have_monopole_self_energy = true;
                             }
                         } else if (it.key() == "cos2")
-                            _u = std::get<1>(potlist) = i;
+                            add(std::get<1>(potlist) = i);
                         else if (it.key() == "polar")
-                            _u = std::get<2>(potlist) = i;
+                            add(std::get<2>(potlist) = i);
                         else if (it.key() == "hardsphere")
-                            _u = std::get<3>(potlist) = i;
+                            add(std::get<3>(potlist) = i);
                         else if (it.key() == "lennardjones")
-                            _u = std::get<4>(potlist) = i;
+                            add(std::get<4>(potlist) = i);
                         else if (it.key() == "repulsionr3")
-                            _u = std::get<5>(potlist) = i;
+                            add(std::get<5>(potlist) = i);
                         else if (it.key() == "sasa")
-                            _u = std::get<6>(potlist) = i;
+                            add(std::get<6>(potlist) = i);
                         else if (it.key() == "wca")
-                            _u = std::get<7>(potlist) = i;
+                            add(std::get<7>(potlist) = i);
                         else if (it.key() == "pm")
-                            _u = std::get<8>(potlist) = it.value();
+                            add(std::get<8>(potlist) = it.value());
                         else if (it.key() == "pmwca")
-                            _u = std::get<9>(potlist) = it.value();
+                            add(std::get<9>(potlist) = it.value());
                         else if (it.key() == "hertz")
-                            _u = std::get<10>(potlist) = i;
+                            add(std::get<10>(potlist) = i);
                         else if (it.key() == "squarewell")
-                            _u = std::get<11>(potlist) = i;
+                            add(std::get<11>(potlist) = i);
                         else if (it.key() == "dipoledipole") {
                             faunus_logger->error("'{}' is deprecated, use 'multipole' instead", it.key());
                         } else if (it.key() == "stockmayer") {
@@ -705,23 +834,19 @@ FunctorPotential::uFunc FunctorPotential::combineFunc(json &j) {
                         } else if (it.key() == "multipole") {
                             std::get<12>(potlist).from_json(it.value()); // init from json
                             std::get<12>(potlist).to_json(it.value());   // write back added info to json
-                            _u = std::get<12>(potlist);
+                            add(std::get<12>(potlist));
                             isotropic = false;                         // potential is now angular dependent
                             if (not have_dipole_self_energy) {
                                 registerSelfEnergy(&std::get<12>(potlist));
                                 have_dipole_self_energy = true;
                             }
                         }
-                        // place additional potentials here...
+                        // place additional potentials here and in `PotentialVariant`...
                     } catch (std::exception &e) {
                         throw std::runtime_error(it.key() + ": " + e.what() + usageTip[it.key()]);
                     }
 
-                    if (_u != nullptr) // if found, sum them into new function object
-                        u = [u, _u](const Particle &a, const Particle &b, double r2, const Point &r) {
-                            return u(a, b, r2, r) + _u(a, b, r2, r);
-                        };
-                    else
+                    if (potentials.size() == num_potentials) // nothing was added
                         throw std::runtime_error("unknown potential: " + it.key());
                 }
             }
@@ -729,7 +854,7 @@ FunctorPotential::uFunc FunctorPotential::combineFunc(json &j) {
     } else
         throw std::runtime_error("dictionary of potentials required");
 
-    return u;
+    return potentials;
 }
 
 void FunctorPotential::to_json(json &j) const {
@@ -741,12 +866,12 @@ void FunctorPotential::from_json(const json &j) {
     have_monopole_self_energy = false;
     have_dipole_self_energy = false;
     _j = j;
-    umatrix = decltype(umatrix)(atoms.size(), combineFunc(_j.at("default")));
+    umatrix = decltype(umatrix)(atoms.size(), combinePotentials(_j.at("default")));
     for (auto it = _j.begin(); it != _j.end(); ++it) {
         auto atompair = words2vec<std::string>(it.key()); // is this for a pair of atoms?
         if (atompair.size() == 2) {
             auto ids = names2ids(atoms, atompair);
-            umatrix.set(ids[0], ids[1], combineFunc(it.value()));
+            umatrix.set(ids[0], ids[1], combinePotentials(it.value()));
         }
     }
 }
@@ -784,6 +909,7 @@ TEST_CASE("[Faunus] FunctorPotential") {
     CHECK(u(a, b, r2, r) == Approx(coulomb(a, b, r2, r) + wca(a, b, r2, r)));
     CHECK(u(c, c, (r * 1.01).squaredNorm(), r * 1.01) == 0);
     CHECK(u(c, c, (r * 0.99).squaredNorm(), r * 0.99) == pc::infty);
+    CHECK_THROWS(R"({"default": [{"nonsense": {}}]})"_json.get<FunctorPotential>());
 
     SUBCASE("selfEnergy()") {
         // let's check that the self energy gets properly transferred to the functor potential
@@ -908,12 +1034,49 @@ double SplinedPotential::findUpperDistance(int i, int j, double energy_threshold
     return rmax;
 }
 
+/**
+ * @param js Input json object with optional "grid" keyword
+ * @param i Atom type index
+ * @param j Atom type index
+ * @return Knot placement for the given pair
+ *
+ * The grid is either given as a string for all pairs or as an object with
+ * a "default" value and optional pair specific values, e.g. `{"default": "adaptive", "Na Cl": "invr"}`.
+ */
+static Tabulate::GridSpacing gridSpacing(const json &js, int i, int j) {
+    using Tabulate::GridSpacing;
+    static const std::map<std::string, GridSpacing> names = {{"adaptive", GridSpacing::ADAPTIVE},
+                                                             {"r2", GridSpacing::SQUARED_DISTANCE},
+                                                             {"invr", GridSpacing::INVERSE_DISTANCE}};
+    std::string name = "adaptive";
+    if (auto it = js.find("grid"); it != js.end()) {
+        if (it->is_string()) {
+            name = it->get<std::string>();
+        } else if (it->is_object()) {
+            name = it->value("default", name);
+            for (const auto &[key, value] : it->items()) {
+                if (auto atompair = words2vec<std::string>(key); atompair.size() == 2) {
+                    auto ids = names2ids(atoms, atompair);
+                    if ((ids[0] == i && ids[1] == j) || (ids[0] == j && ids[1] == i)) {
+                        name = value.get<std::string>();
+                    }
+                }
+            }
+        }
+    }
+    if (auto it = names.find(name); it != names.end()) {
+        return it->second;
+    }
+    throw ConfigurationError("unknown spline grid '{}'", name);
+}
+
 void SplinedPotential::from_json(const json &js) {
     FunctorPotential::from_json(js);
     if (!isotropic) {
         throw std::runtime_error("Cannot spline anisotropic potentials");
     }
     spline.setTolerance(js.value("utol", 1e-3), js.value("ftol", 1e-2));
+    equidistant.setTolerance(js.value("utol", 1e-3), js.value("ftol", 1e-2));
     hardsphere_repulsion = js.value("hardsphere", false);
     double energy_at_rmin = js.value("u_at_rmin", 20);
     double energy_at_rmax = js.value("u_at_rmax", 1e-6);
@@ -937,7 +1100,7 @@ void SplinedPotential::from_json(const json &js) {
             rmin = findLowerDistance(i, j, energy_at_rmin, rmin);
             rmax = findUpperDistance(i, j, energy_at_rmax, rmax);
             assert(rmin < rmax);
-            createKnots(i, j, rmin, rmax);
+            createKnots(i, j, rmin, rmax, gridSpacing(js, i, j));
         }
     }
     if (js.value("to_disk", false)) {
@@ -952,20 +1115,22 @@ SplinedPotential::SplinedPotential(const std::string &name) : FunctorPotential(n
  * @param j Atom index
  * @param rmin Minimum splining distance
  * @param rmax Maximum splining distance
+ * @param spacing Placement of knots
  */
-void SplinedPotential::createKnots(int i, int j, double rmin, double rmax) {
+void SplinedPotential::createKnots(int i, int j, double rmin, double rmax, Tabulate::GridSpacing spacing) {
     Particle particle1 = Faunus::atoms.at(i);
     Particle particle2 = Faunus::atoms.at(j);
-    KnotData knotdata = spline.generate(
-        [&](double r_squared) {
-            return FunctorPotential::operator()(particle1, particle2, r_squared, {0, 0, 0});
-        },
-        rmin * rmin, rmax * rmax); // spline along r^2
+    auto energy = [&](double r_squared) {
+        return FunctorPotential::operator()(particle1, particle2, r_squared, {0, 0, 0});
+    };
+    KnotData knotdata = (spacing == Tabulate::GridSpacing::ADAPTIVE)
+                            ? spline.generate(energy, rmin * rmin, rmax * rmax) // spline along r^2
+                            : equidistant.generate(energy, rmin * rmin, rmax * rmax, spacing);
 
     // if set, hard-sphere repulsion (infinity) is used IF the potential is repulsive below rmin
     knotdata.hardsphere_repulsion = hardsphere_repulsion;
-    if (spline.eval(knotdata, knotdata.rmin2 + dr) < 0) { // disable hard sphere
-        knotdata.hardsphere_repulsion = false;            // repulsion for attractive potentials
+    if (eval(knotdata, knotdata.rmin2 + dr) < 0) { // disable hard sphere
+        knotdata.hardsphere_repulsion = false;     // repulsion for attractive potentials
     }
     if (knotdata.hardsphere_repulsion) {
         faunus_logger->trace("Hardsphere repulsion enabled for {}-{} spline", Faunus::atoms.at(i).name,
@@ -979,11 +1144,82 @@ void SplinedPotential::createKnots(int i, int j, double rmin, double rmax) {
                                  FunctorPotential::operator()(particle1, particle2, r *r, {r, 0, 0}));
         max_error = std::max(error, max_error);
     }
+    knotdata.max_error = max_error;
+    matrix_of_knots.set(i, j, knotdata); // store also the error for reporting
     faunus_logger->debug(
         "{}-{} interaction splined between [{:6.2f}:{:6.2f}] {} using {} knots w. maximum absolute error of {:.1E} kT",
         Faunus::atoms[i].name, Faunus::atoms[j].name, rmin, rmax, u8::angstrom, knotdata.numKnots(), max_error);
 }
 
+/**
+ * Besides the input, the number of knots, memory footprint, and maximum
+ * absolute error of each pair table are reported under "splines". This
+ * can be used to choose grids that fit in the CPU caches.
+ */
+void SplinedPotential::to_json(json &j) const {
+    FunctorPotential::to_json(j);
+    static const std::map<Tabulate::GridSpacing, std::string> names = {
+        {Tabulate::GridSpacing::ADAPTIVE, "adaptive"},
+        {Tabulate::GridSpacing::SQUARED_DISTANCE, "r2"},
+        {Tabulate::GridSpacing::INVERSE_DISTANCE, "invr"}};
+    auto &_j = j["splines"] = json::object();
+    size_t total_bytes = 0;
+    for (size_t i = 0; i < Faunus::atoms.size() && i < matrix_of_knots.size(); ++i) {
+        for (size_t k = 0; k <= i; ++k) {
+            const auto &knots = matrix_of_knots(i, k);
+            if (knots.empty()) {
+                continue;
+            }
+            total_bytes += knots.bytes();
+            _j[Faunus::atoms[i].name + " " + Faunus::atoms[k].name] = {{"grid", names.at(knots.spacing)},
+                                                                       {"knots", knots.numKnots()},
+                                                                       {"bytes", knots.bytes()},
+                                                                       {"max error", knots.max_error}};
+        }
+    }
+    j["splines bytes"] = total_bytes;
+}
+
+TEST_CASE("[Faunus] SplinedPotential") {
+    using doctest::Approx;
+    atoms = R"([{"A": {"r": 1.5, "eps": 0.1}}, {"B": {"r": 2.0, "eps": 0.05}}])"_json.get<decltype(atoms)>();
+    SplinedPotential splined = R"({"default": [{"lennardjones": {"mixing": "LB"}}], "utol": 1e-5})"_json;
+
+    Particle particle = atoms[0];
+    ParticleVector partners;
+    std::vector<double> squared_distances;
+    std::vector<int> ids;
+    for (double r = 2.0; r < 40.0; r += 0.37) { // below rmin, within and beyond the spline range
+        partners.push_back(atoms[partners.size() % 2]);
+        squared_distances.push_back(r * r);
+        ids.push_back(partners.back().id);
+    }
+    double u_pairwise = 0.0;
+    for (size_t i = 0; i < partners.size(); ++i) {
+        u_pairwise += splined(particle, partners[i], squared_distances[i], {0, 0, 0});
+    }
+    CHECK(splined(particle, partners, squared_distances.data(), ids.data(), partners.size()) == Approx(u_pairwise));
+    CHECK(splined(particle, partners, squared_distances.data(), ids.data(), 0) == 0.0);
+
+    SUBCASE("Equidistant grids") {
+        SplinedPotential equidistant = R"({"default": [{"lennardjones": {"mixing": "LB"}}], "utol": 1e-5,
+                                           "grid": {"default": "r2", "A B": "invr"}})"_json;
+        json j;
+        equidistant.to_json(j);
+        CHECK(j.at("splines").at("A A").at("grid") == "r2");
+        CHECK(j.at("splines").at("B A").at("grid") == "invr");
+        CHECK(j.at("splines").at("B A").at("max error").get<double>() < 1e-4);
+        CHECK(j.at("splines bytes").get<size_t>() > 0);
+        for (size_t i = 0; i < partners.size(); ++i) {
+            CHECK(equidistant(particle, partners[i], squared_distances[i], {0, 0, 0}) ==
+                  Approx(splined(particle, partners[i], squared_distances[i], {0, 0, 0})).epsilon(1e-3));
+        }
+        CHECK(equidistant(particle, partners, squared_distances.data(), ids.data(), partners.size()) ==
+              Approx(u_pairwise).epsilon(1e-3));
+        CHECK_THROWS(R"({"default": [{"lennardjones": {"mixing": "LB"}}], "grid": "x"})"_json.get<SplinedPotential>());
+    }
+}
+
 // =============== NewCoulombGalore ===============
 
 void NewCoulombGalore::setSelfEnergy() {
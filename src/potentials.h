@@ -9,6 +9,7 @@
 #include <coulombgalore.h>
 #include <array>
 #include <functional>
+#include <variant>
 
 /*
 namespace CoulombGalore {
@@ -114,7 +115,7 @@ class PairMixer {
  * Monte Carlo schemes.
  */
 struct PairPotentialBase {
-    std::string name; //!< unique name per polymorphic call; used in FunctorPotential::combineFunc
+    std::string name; //!< unique name per polymorphic call; used in FunctorPotential::combinePotentials
     std::string cite; //!< Typically a short-doi litterature reference
     bool isotropic = true; //!< true if pair-potential is independent of particle orientation
     std::function<double(const Particle &)> selfEnergy = nullptr; //!< self energy of particle (kT)
@@ -602,6 +603,12 @@ class Multipole : public NewCoulombGalore {
 
 /**
  * @brief Custom pair-potential taking math. expressions at runtime
+ *
+ * If the expression depends on the separation only, i.e. not on charges or
+ * sigmas, and a finite cutoff is given, it is splined between the cutoff and
+ * the distance where the energy exceeds `u_at_rmin`. The expression is evaluated
+ * only at shorter distances, or for all distances if the spline cannot be
+ * verified to meet the tolerance.
  */
 class CustomPairPotential : public PairPotentialBase {
   private:
@@ -614,10 +621,16 @@ class CustomPairPotential : public PairPotentialBase {
     double Rc2;
     std::shared_ptr<Data> d;
     json jin; // initial json input
+    Tabulate::Andrea<double> spline;
+    std::shared_ptr<const Tabulate::TabulatorBase<double>::data> knots; //!< Spline in ]rmin2,Rc2]; empty if not splined
+    void createKnots(double utol, double energy_at_rmin); //!< Spline the expression if it depends on r only
+
   public:
     inline double operator()(const Particle &a, const Particle &b, double r2, const Point &) const override {
         if (r2 > Rc2)
             return 0;
+        if (knots && r2 > knots->rmin2)
+            return spline.eval(*knots, r2);
         d->r = sqrt(r2);
         d->q1 = a.charge;
         d->q2 = b.charge;
@@ -626,6 +639,7 @@ class CustomPairPotential : public PairPotentialBase {
         return expr();
     }
     CustomPairPotential(const std::string & = "custom");
+    bool isSplined() const { return knots != nullptr; } //!< True if the expression is (partly) replaced by a spline
 
     void from_json(const json &) override;
     void to_json(json &) const override;
@@ -635,15 +649,16 @@ class CustomPairPotential : public PairPotentialBase {
 /**
  * @brief Arbitrary potentials for specific atom types
  *
- * This maintains a species x species matrix with function pointers (`std::function`)
- * that wraps pair potentials. Flexibility over performance.
+ * This maintains a species x species matrix with a list of the pair potentials
+ * active for each pair. Each potential is stored as a `std::variant` over the concrete
+ * potential types and the energy is obtained by `std::visit`, i.e. through a jump table
+ * followed by a direct, inlineable call rather than a chain of type erased closures.
  *
  * @todo `to_json` should retrieve info from potentials instead of merely passing input
  * @warning Each atom pair will be assigned an instance of a pair-potential. This *could* be
  *          problematic if these have large memory requirements.
  */
 class FunctorPotential : public PairPotentialBase {
-    typedef std::function<double(const Particle &, const Particle &, double, const Point &)> uFunc;
     json _j; // storage for input json
     typedef CombinedPairPotential<Coulomb, HardSphere> PrimitiveModel;
     typedef CombinedPairPotential<Coulomb, WeeksChandlerAndersen> PrimitiveModelWCA;
@@ -672,10 +687,17 @@ class FunctorPotential : public PairPotentialBase {
                >
         potlist;
 
-    uFunc combineFunc(json &j); // parse json array of potentials to a single potential function object
+    //! Any of the pair potentials in `potlist` or a custom potential
+    typedef std::variant<CustomPairPotential, NewCoulombGalore, CosAttract, Polarizability, HardSphere, LennardJones,
+                         RepulsionR3, SASApotential, WeeksChandlerAndersen, PrimitiveModel, PrimitiveModelWCA, Hertz,
+                         SquareWell, Multipole>
+        PotentialVariant;
+    typedef std::vector<PotentialVariant> PotentialList; //!< Potentials for a single pair; energies are summed
+
+    PotentialList combinePotentials(json &j); // parse json array of potentials to a list of potentials
 
   protected:
-    PairMatrix<uFunc, true> umatrix; // matrix with potential for each atom pair; cannot be Eigen matrix
+    PairMatrix<PotentialList, true> umatrix; // matrix with potentials for each atom pair; cannot be Eigen matrix
 
   public:
     FunctorPotential(const std::string &name = "functor potential");
@@ -692,7 +714,16 @@ class FunctorPotential : public PairPotentialBase {
      */
     inline double operator()(const Particle &a, const Particle &b, double r2,
                              const Point &r = {0, 0, 0}) const override {
-        return umatrix(a.id, b.id)(a, b, r2, r);
+        double u = 0.0;
+        for (const auto &potential : umatrix(a.id, b.id)) {
+            u += std::visit(
+                [&](const auto &pair_potential) {
+                    using T = std::decay_t<decltype(pair_potential)>;
+                    return pair_potential.T::operator()(a, b, r2, r); // qualified call avoids virtual dispatch
+                },
+                potential);
+        }
+        return u;
     }
 };
 
@@ -706,6 +737,10 @@ class FunctorPotential : public PairPotentialBase {
  * The spline range is automatically detected based on user-defined
  * energy thresholds. If below the range, the default behavior is to return
  * the EXACT energy, while if above ZERO is returned.
+ *
+ * Knots are by default placed adaptively (`Tabulate::Andrea`), but each pair
+ * may instead use equidistant knots along r² or 1/r (`Tabulate::Equidistant`)
+ * for constant time lookup.
  */
 class SplinedPotential : public FunctorPotential {
     /** @brief Expand spline data class to hold information about the sign of values for r<rmin */
@@ -713,12 +748,14 @@ class SplinedPotential : public FunctorPotential {
       public:
         using base = Tabulate::TabulatorBase<double>::data;
         bool hardsphere_repulsion = false; //!< Use hardsphere repulsion for r smaller than rmin
+        double max_error = 0.0;            //!< Maximum absolute error of the spline in [rmin:rmax]
         KnotData() = default;
         KnotData(const base &);
     };
 
     PairMatrix<KnotData> matrix_of_knots;                 //!< Matrix with tabulated potential for each atom pair
-    Tabulate::Andrea<double> spline;                      //!< Spline method
+    Tabulate::Andrea<double> spline;                      //!< Spline method for adaptive knots
+    Tabulate::Equidistant<double> equidistant;            //!< Spline method for equidistant knots
     bool hardsphere_repulsion = false;                    //!< Use hardsphere repulsion for r smaller than rmin
     const int max_iterations = 1e6;                       //!< Max number of iterations when determining spline interval
     void stream_pair_potential(std::ostream &, int, int); //!< Stream pair potential to output stream
@@ -726,7 +763,23 @@ class SplinedPotential : public FunctorPotential {
     double findLowerDistance(int, int, double, double);   //!< Find lower distance for splining (rmin)
     double findUpperDistance(int, int, double, double);   //!< Find upper distance for splining (rmax)
     double dr = 1e-2;                                     //!< Distance interval when searching for rmin and rmax
-    void createKnots(int, int, double, double);           //!< Create spline knots for pair of particles in [rmin:rmax]
+    static constexpr size_t num_coefficients = 6;         //!< Spline coefficients per knot interval
+    void createKnots(int, int, double, double, Tabulate::GridSpacing); //!< Create spline knots for pair in [rmin:rmax]
+
+    /** @brief Spline coefficients of the knot interval containing r2 and the distance, dz, from its lower knot */
+    inline const double *locate(const KnotData &knots, double r2, double &dz) const {
+        if (knots.spacing == Tabulate::GridSpacing::ADAPTIVE) {
+            const size_t pos = spline.interval(knots, r2);
+            dz = r2 - knots.r2[pos];
+            return knots.c.data() + num_coefficients * pos;
+        }
+        return equidistant.locate(knots, r2, dz);
+    }
+
+    inline double eval(const KnotData &knots, double r2) const {
+        return knots.spacing == Tabulate::GridSpacing::ADAPTIVE ? spline.eval(knots, r2)
+                                                                  : equidistant.eval(knots, r2);
+    } //!< Splined energy in ]rmin2:rmax2[
 
   public:
     explicit SplinedPotential(const std::string &name = "splined");
@@ -745,7 +798,7 @@ class SplinedPotential : public FunctorPotential {
             return 0.0;
         }
         if (r2 > knots.rmin2) {
-            return spline.eval(knots, r2); // spline energy
+            return eval(knots, r2); // spline energy
         }
         if (knots.hardsphere_repulsion) {
             return pc::infty;
@@ -753,7 +806,62 @@ class SplinedPotential : public FunctorPotential {
         return FunctorPotential::operator()(p1, p2, r2, {0, 0, 0}); // exact energy
     }
 
+    /**
+     * @brief Summed energy between a particle and a range of partners
+     *
+     * @param particle  particle to pair with all partners
+     * @param partners  random access range of partner particles; only accessed if r <= rmin
+     * @param squared_distances  array of squared distances to the partners
+     * @param ids  array of partner atom ids
+     * @param size  number of partners
+     * @return energy sum; same policies as the single pair operator()
+     *
+     * Partners are processed in blocks: first the knot interval of each partner within the
+     * spline range is found by a branch-free lookup and the spline coefficients are gathered
+     * into lane buffers; then the polynomials of the whole block are evaluated in a single loop
+     * which the compiler can vectorize. Partners closer than rmin (rare) are treated one by one.
+     */
+    template <typename TPartners>
+    double operator()(const Particle &particle, const TPartners &partners, const double *squared_distances,
+                      const int *ids, const size_t size) const {
+        constexpr size_t block_size = 16;
+        alignas(64) double dz[block_size];                             // distance from lower knot
+        alignas(64) double coefficients[num_coefficients][block_size]; // gathered spline coefficients
+        double u = 0.0;
+        for (size_t first = 0; first < size; first += block_size) {
+            const size_t last = std::min(first + block_size, size);
+            size_t lanes = 0; // number of partners in the spline range
+            for (size_t i = first; i < last; ++i) {
+                const double r2 = squared_distances[i];
+                const auto &knots = matrix_of_knots(particle.id, ids[i]);
+                if (r2 >= knots.rmax2) {
+                    continue;
+                }
+                if (r2 > knots.rmin2) {
+                    const double *c = locate(knots, r2, dz[lanes]);
+                    for (size_t k = 0; k < num_coefficients; ++k) {
+                        coefficients[k][lanes] = c[k];
+                    }
+                    ++lanes;
+                } else if (knots.hardsphere_repulsion) {
+                    return pc::infty;
+                } else {
+                    u += FunctorPotential::operator()(particle, partners[i], r2, {0, 0, 0}); // exact energy
+                }
+            }
+            for (size_t lane = 0; lane < lanes; ++lane) { // Horner scheme in all lanes
+                double sum = coefficients[num_coefficients - 1][lane];
+                for (size_t k = num_coefficients - 1; k > 0; --k) {
+                    sum = coefficients[k - 1][lane] + dz[lane] * sum;
+                }
+                u += sum;
+            }
+        }
+        return u;
+    }
+
     void from_json(const json &) override;
+    void to_json(json &) const override;
 };
 
 } // end of namespace Potential
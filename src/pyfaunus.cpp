@@ -37,6 +37,21 @@ inline py::dict json2dict(const json &j) {
     return loads( j.dump() ) ;
 }
 
+/**
+ * Python modifies particles directly rather than through moves and hence the Hamiltonian
+ * refreshes the structure-of-arrays mirror of its space before each evaluation
+ */
+class PyHamiltonian : public Thamiltonian {
+    Space &spc;
+
+  public:
+    PyHamiltonian(Space &spc, const json &j) : Thamiltonian(spc, j), spc(spc) {}
+    double energy(Change &change) override {
+        spc.particle_arrays.update(spc.p);
+        return Thamiltonian::energy(change);
+    }
+};
+
 template<class T>
 std::unique_ptr<T> from_dict(py::dict dict) {
     auto ptr = new T();
@@ -240,14 +255,17 @@ PYBIND11_MODULE(pyfaunus, m)
         .def_readwrite("p", &Space::p)
         .def_readwrite("groups", &Space::groups)
         .def("findMolecules", &Space::findMolecules)
+        .def("updateParticleArrays", &Space::updateParticleArrays)
         .def("from_dict", [](Space &spc, py::dict dict) { from_json(dict2json(dict), spc); });
 
     // Hamiltonian
     py::class_<Thamiltonian>(m, "Hamiltonian")
-        .def(py::init<Space &, const json &>())
+        .def(py::init([](Space &spc, const json &j) {
+            return std::unique_ptr<Thamiltonian>(new PyHamiltonian(spc, j));
+        }))
         .def(py::init([](Space &spc, py::list list) {
             json j = list2json(list);
-            return std::unique_ptr<Thamiltonian>(new Thamiltonian(spc, j));
+            return std::unique_ptr<Thamiltonian>(new PyHamiltonian(spc, j));
         }))
         .def("init", &Thamiltonian::init)
         .def("energy", &Thamiltonian::energy);
@@ -8,8 +8,33 @@ namespace Faunus {
 
 bool Change::data::operator<(const Faunus::Change::data &other) const { return index < other.index; }
 
+/**
+ * When a Change object is reused for every move, the group vector and the atom index vectors
+ * keep their capacity and a steady-state move loop needs no heap allocations.
+ */
+Change::data &Change::addGroup(const data &other) {
+    auto &added = groups.emplace_back();
+    if (!recycled_atoms.empty()) {
+        added.atoms.swap(recycled_atoms.back());
+        recycled_atoms.pop_back();
+    }
+    added = other; // copy assignment reuses the capacity of `atoms`
+    return added;
+}
+
 void Change::clear() {
-    *this = Change();
+    dV = false;
+    all = false;
+    dN = false;
+    moved2moved = true;
+    for (auto &changed : groups) {
+        // moves adding groups with `groups.push_back()` would otherwise let the pool grow without bound
+        if (changed.atoms.capacity() > 0 && recycled_atoms.size() < groups.capacity()) {
+            changed.atoms.clear();
+            recycled_atoms.push_back(std::move(changed.atoms));
+        }
+    }
+    groups.clear();
     assert(empty());
 }
 bool Change::empty() const {
@@ -72,10 +97,98 @@ TEST_CASE("[Faunus] Change") {
     CHECK(change);
     change.clear();
     CHECK(change.empty());
+
+    SUBCASE("Memory is reused after clear") {
+        Change::data data;
+        data.index = 2;
+        data.atoms = {1, 3};
+        change.addGroup(data);
+        CHECK(change.groups.at(0).index == 2);
+        CHECK(change.groups.at(0).atoms == data.atoms);
+        const auto *groups_memory = change.groups.data();
+        const auto *atoms_memory = change.groups.at(0).atoms.data();
+        change.clear();
+        CHECK(change.empty());
+        data.atoms = {4};
+        auto &added = change.addGroup(data);
+        CHECK(added.atoms == std::vector<int>{4});
+        CHECK(change.groups.data() == groups_memory);
+        CHECK(added.atoms.data() == atoms_memory);
+    }
+}
+
+size_t ParticleArrays::size() const { return id.size(); }
+
+void ParticleArrays::clear() {
+    for (auto vec : {&x, &y, &z}) {
+        vec->clear();
+    }
+    id.clear();
+}
+
+void ParticleArrays::set(size_t index, const Particle &particle) {
+    x[index] = particle.pos.x();
+    y[index] = particle.pos.y();
+    z[index] = particle.pos.z();
+    id[index] = particle.id;
+}
+
+void ParticleArrays::update(const ParticleVector &particles) {
+    for (auto vec : {&x, &y, &z}) {
+        vec->resize(particles.size());
+    }
+    id.resize(particles.size());
+    update(particles.begin(), particles.end(), 0);
+}
+
+void ParticleArrays::update(const ParticleVector::const_iterator begin, const ParticleVector::const_iterator end,
+                            size_t offset) {
+    assert(offset + std::distance(begin, end) <= size());
+    std::for_each(begin, end, [&](const Particle &particle) { set(offset++, particle); });
+}
+
+/**
+ * The cost is proportional to the number of particles; intended for assertions in debug builds.
+ */
+bool ParticleArrays::matches(const ParticleVector::const_iterator begin, const ParticleVector::const_iterator end,
+                             size_t offset) const {
+    if (offset + std::distance(begin, end) > size()) {
+        return false;
+    }
+    return std::all_of(begin, end, [&](const Particle &particle) {
+        const auto i = offset++;
+        return x[i] == particle.pos.x() && y[i] == particle.pos.y() && z[i] == particle.pos.z() &&
+               id[i] == particle.id;
+    });
+}
+
+TEST_CASE("[Faunus] ParticleArrays") {
+    using doctest::Approx;
+    ParticleVector particles(3);
+    particles[1].pos = {1, 2, 3};
+    particles[1].id = 2;
+    ParticleArrays arrays;
+    arrays.update(particles);
+    CHECK(arrays.size() == 3);
+    CHECK(arrays.x[1] == Approx(1));
+    CHECK(arrays.y[1] == Approx(2));
+    CHECK(arrays.z[1] == Approx(3));
+    CHECK(arrays.id[1] == 2);
+    particles[2].pos = {4, 5, 6};
+    arrays.update(particles.begin() + 2, particles.end(), 2);
+    CHECK(arrays.z[2] == Approx(6));
+    CHECK(arrays.matches(particles.begin(), particles.end(), 0));
+    particles[0].pos.x() = 1.0; // not mirrored
+    CHECK(arrays.matches(particles.begin() + 1, particles.end(), 1));
+    CHECK_FALSE(arrays.matches(particles.begin(), particles.end(), 0));
+    CHECK_FALSE(arrays.matches(particles.begin(), particles.end(), 1)); // beyond the arrays
+    arrays.clear();
+    CHECK(arrays.size() == 0);
 }
 
 void Space::clear() {
     p.clear();
+    particle_arrays.clear();
     groups.clear();
     implicit_reservoir.clear();
 }
@@ -168,6 +281,228 @@ void Space::sync(const Space &other, const Change &change) {
                 }
             }
         }
+        updateParticleArrays(change);
+    }
+}
+
+/**
+ * @param change Change object describing which particles have been modified
+ *
+ * Only the particles touched by the change are copied into `particle_arrays`, i.e.
+ * the cost is proportional to the number of changed particles. The whole mirror is rebuilt
+ * if everything or the volume has changed, or if particles have been added to the system.
+ * Groups with a changed number of particles are refreshed up to their capacity as
+ * (de)activation shuffles the particles within the group.
+ */
+void Space::updateParticleArrays(const Change &change) {
+    if (change.all || change.dV || particle_arrays.size() != p.size()) {
+        particle_arrays.update(p);
+        return;
+    }
+    for (const auto &changed : change.groups) {
+        const auto &group = groups.at(changed.index);
+        const auto offset = std::distance(p.begin(), group.begin());
+        if (changed.all || changed.atoms.empty() || change.dN) {
+            particle_arrays.update(group.begin(), group.trueend(), offset);
+        } else {
+            for (auto i : changed.atoms) { // atom index relative to group
+                particle_arrays.set(offset + i, *(group.begin() + i));
+            }
+        }
+    }
+}
+
+void SpaceJournal::enable(bool enable) {
+    particles.clear();
+    groups.clear();
+    positions.clear();
+    geometry.reset();
+    is_swapped = false;
+    is_enabled = enable;
+}
+
+bool SpaceJournal::enabled() const { return is_enabled; }
+
+bool SpaceJournal::empty() const { return particles.empty() && groups.empty() && positions.empty() && !geometry; }
+
+void SpaceJournal::recordParticles(const Space &spc, ParticleVector::const_iterator first,
+                                   ParticleVector::const_iterator last) {
+    if (is_enabled) {
+        assert(!is_swapped);
+        auto index = static_cast<size_t>(std::distance(spc.p.cbegin(), first));
+        for (auto particle = first; particle != last; ++particle) {
+            particles.emplace_back(index++, *particle);
+        }
+    }
+}
+
+void SpaceJournal::recordGroupData(const Space &spc, const Group<Particle> &group) {
+    if (is_enabled) {
+        assert(!is_swapped);
+        groups.emplace_back(std::distance(&spc.groups.front(), &group), group); // copies data, not particles
+    }
+}
+
+void SpaceJournal::recordGroup(const Space &spc, const Group<Particle> &group) {
+    recordGroupData(spc, group);
+    recordParticles(spc, group.begin(), group.trueend());
+}
+
+/**
+ * Only positions are stored for the particles which is sufficient for e.g. volume moves.
+ * Must be recorded before any particles are recorded; subsequent calls are ignored.
+ */
+void SpaceJournal::recordPositions(const Space &spc) {
+    if (is_enabled && !geometry) {
+        assert(!is_swapped);
+        assert(particles.empty());
+        geometry = spc.geo;
+        positions.resize(spc.p.size());
+        std::transform(spc.p.begin(), spc.p.end(), positions.begin(), [](auto &particle) { return particle.pos; });
+        for (const auto &group : spc.groups) {
+            recordGroupData(spc, group);
+        }
+    }
+}
+
+/**
+ * Modifications are undone in the reverse order of recording and redone in the order of recording.
+ * Particles are exchanged by move which avoids copying the particle extensions.
+ */
+void SpaceJournal::swap(Space &spc) {
+    auto swap_particle = [&](std::pair<size_t, Particle> &record) { std::swap(spc.p.at(record.first), record.second); };
+    auto swap_group = [&](std::pair<size_t, Group<Particle>> &record) {
+        auto &group = spc.groups.at(record.first);
+        Group<Particle> current(group); // copies data, not particles
+        group.shallowcopy(record.second);
+        record.second.shallowcopy(current);
+    };
+    auto swap_positions = [&] {
+        if (geometry) {
+            std::swap(spc.geo, *geometry);
+            assert(positions.size() == spc.p.size());
+            for (size_t i = 0; i < positions.size(); i++) {
+                std::swap(spc.p[i].pos, positions[i]);
+            }
+        }
+    };
+    if (is_swapped) { // redo
+        swap_positions();
+        std::for_each(particles.begin(), particles.end(), swap_particle);
+        std::for_each(groups.begin(), groups.end(), swap_group);
+    } else { // undo
+        std::for_each(particles.rbegin(), particles.rend(), swap_particle);
+        std::for_each(groups.rbegin(), groups.rend(), swap_group);
+        swap_positions();
+    }
+    is_swapped = !is_swapped;
+}
+
+void SpaceJournal::commit() {
+    assert(!is_swapped);
+    enable(is_enabled);
+}
+
+void SpaceJournal::rollback(Space &spc) {
+    if (!is_swapped) {
+        swap(spc);
+    }
+    enable(is_enabled);
+}
+
+/**
+ * @param committed Cleared and filled with the index and the recorded value of each particle
+ *                  modified since the last commit; pointers are valid until the next record
+ *
+ * A particle may be recorded several times, whereof the first record holds the committed value.
+ * Unrecorded particles are unmodified. Positions recorded by `recordPositions()` are not
+ * included and the journal must not be swapped.
+ */
+void SpaceJournal::committedParticles(std::vector<std::pair<size_t, const Particle *>> &committed) const {
+    assert(!is_swapped && !geometry);
+    committed.clear();
+    for (const auto &[index, particle] : particles) {
+        committed.emplace_back(index, &particle);
+    }
+    // records of the same particle keep the order of recording as they are stored contiguously
+    std::sort(committed.begin(), committed.end());
+    auto duplicates = std::unique(committed.begin(), committed.end(),
+                                  [](const auto &record, const auto &other) { return record.first == other.first; });
+    committed.erase(duplicates, committed.end());
+}
+
+/**
+ * @return First record of the group data; `nullptr` if the group data is unmodified
+ */
+const Group<Particle> *SpaceJournal::committedGroupData(size_t group_index) const {
+    assert(!is_swapped);
+    auto record = std::find_if(groups.begin(), groups.end(),
+                               [group_index](const auto &record) { return record.first == group_index; });
+    return record != groups.end() ? &record->second : nullptr;
+}
+
+TEST_CASE("[Faunus] SpaceJournal") {
+    Space spc;
+    SpaceFactory::makeNaCl(spc, 5, R"( {"type": "cuboid", "length": 20} )"_json);
+    const ParticleVector original_particles = spc.p;
+    const double original_volume = spc.geo.getVolume();
+    auto &group = spc.groups.front();
+    const Point original_mass_center = group.cm;
+    auto positions_match = [&](const ParticleVector &particles) {
+        return std::equal(particles.begin(), particles.end(), spc.p.begin(),
+                          [](auto &a, auto &b) { return a.pos == b.pos && a.charge == b.charge; });
+    };
+
+    spc.journal.recordParticles(spc, spc.p.begin(), spc.p.begin() + 1);
+    CHECK(spc.journal.empty()); // disabled
+    spc.journal.enable(true);
+
+    SUBCASE("Particles and groups") {
+        spc.journal.recordParticles(spc, spc.p.begin() + 1, spc.p.begin() + 2);
+        spc.p[1].pos.x() += 1.0;
+        spc.journal.recordGroup(spc, group);
+        spc.p[1].pos.x() += 1.0; // recorded twice
+        spc.p[2].charge = 5.0;
+        group.cm = {1, 2, 3};
+        const ParticleVector trial_particles = spc.p;
+        CHECK(!spc.journal.empty());
+
+        std::vector<std::pair<size_t, const Particle *>> committed;
+        spc.journal.committedParticles(committed);
+        CHECK(std::adjacent_find(committed.begin(), committed.end(), [](auto &a, auto &b) {
+                  return a.first >= b.first;
+              }) == committed.end()); // sorted and unique
+        auto particle1 = std::find_if(committed.begin(), committed.end(), [](auto &record) { return record.first == 1; });
+        REQUIRE(particle1 != committed.end());
+        CHECK(particle1->second->pos == original_particles[1].pos); // first of two records
+        REQUIRE(spc.journal.committedGroupData(0) != nullptr);
+        CHECK(spc.journal.committedGroupData(0)->cm == original_mass_center);
+        CHECK(spc.journal.committedGroupData(spc.groups.size()) == nullptr);
+
+        spc.journal.swap(spc); // undo
+        CHECK(positions_match(original_particles));
+        CHECK(group.cm == original_mass_center);
+        spc.journal.swap(spc); // redo
+        CHECK(positions_match(trial_particles));
+        CHECK(group.cm == Point(1, 2, 3));
+        spc.journal.rollback(spc);
+        CHECK(positions_match(original_particles));
+        CHECK(spc.journal.empty());
+    }
+
+    SUBCASE("Volume") {
+        spc.journal.recordPositions(spc);
+        spc.scaleVolume(2.0 * original_volume);
+        spc.journal.recordParticles(spc, spc.p.begin(), spc.p.begin() + 1);
+        spc.p[0].pos.z() += 0.5;
+        spc.journal.swap(spc);
+        CHECK(spc.geo.getVolume() == doctest::Approx(original_volume));
+        CHECK(positions_match(original_particles));
+        spc.journal.swap(spc);
+        CHECK(spc.geo.getVolume() == doctest::Approx(2.0 * original_volume));
+        spc.journal.commit();
+        CHECK(spc.journal.empty());
+        CHECK(spc.journal.enabled());
     }
 }
 
@@ -220,6 +555,7 @@ Point Space::scaleVolume(double Vnew, Geometry::VolumeMethod method) {
     if (method == Geometry::ISOCHORIC) { // ? not used for anything...
         Vold = std::pow(Vold, 1. / 3.);  // ?
     }
+    particle_arrays.update(p);
     for (auto trigger_function : scaleVolumeTriggers) { // external clients may have added function
         trigger_function(*this, Vold, Vnew);            // to be triggered upon each volume change
     }
@@ -347,6 +683,8 @@ void from_json(const json &j, Space &spc) {
             faunus_logger->trace("{} implicit molecules loaded", it->size());
         }
 
+        spc.particle_arrays.update(spc.p);
+
         // check correctness of molecular mass centers
         for (auto &group : spc.groups) {
             if (!group.empty() && group.isMolecular()) {
@@ -535,6 +873,33 @@ TEST_CASE("[Faunus] Space::updateParticles") {
     }
 }
 
+TEST_CASE("[Faunus] Space::updateParticleArrays") {
+    using doctest::Approx;
+    Space spc, other;
+    SpaceFactory::makeWater(spc, 2, R"( {"type": "cuboid", "length": 20} )"_json);
+    SpaceFactory::makeWater(other, 2, R"( {"type": "cuboid", "length": 20} )"_json);
+    Change change;
+    change.all = true;
+    spc.updateParticleArrays(change);
+    CHECK(spc.particle_arrays.size() == spc.p.size());
+    CHECK(spc.particle_arrays.x[4] == Approx(spc.p[4].pos.x()));
+
+    change.clear();
+    change.groups.push_back({});
+    change.groups.back().index = 1;
+    change.groups.back().atoms = {1};
+    other.updateParticleArrays(change); // first call copies everything
+    other.p[4].pos.x() = 3.3;
+    other.p[5].pos.x() = 4.4; // not part of the change
+    other.updateParticleArrays(change);
+    CHECK(other.particle_arrays.x[4] == Approx(3.3));
+    CHECK(other.particle_arrays.x[5] != Approx(4.4));
+
+    spc.sync(other, change); // particle arrays follow the synchronised particles
+    CHECK(spc.particle_arrays.x[4] == Approx(3.3));
+    CHECK(spc.particle_arrays.x[5] == Approx(spc.p[5].pos.x()));
+}
+
 TEST_SUITE_END();
 
 namespace SpaceFactory {
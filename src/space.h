@@ -4,6 +4,7 @@
 #include "group.h"
 #include "molecule.h"
 #include <range/v3/view/join.hpp>
+#include <optional>
 
 namespace Faunus {
 
@@ -14,6 +15,11 @@ class Space;
  *
  * - If `moved` or `removed` are defined for a group, but are
  *   empty, it is assumed that *all* particles in the group are affected.
+ * - `clear()` keeps the memory of the group list and of the atom index vectors for reuse
+ *   by `addGroup()`, such that reusing a Change for moves of similar size does not allocate.
+ *   Non-bonded energies and the energy ledger likewise keep their work buffers, such that a
+ *   Monte Carlo loop with these terms does not allocate once the buffers have grown to the
+ *   size of the largest move (tested in montecarlo.cpp).
  */
 struct Change {
     bool dV = false;         //!< Set to true if there's a volume change
@@ -42,15 +48,80 @@ struct Change {
     //! List of changed atom index relative to first particle in system
     std::vector<int> touchedParticleIndex(const std::vector<Group<Particle>> &);
 
-    void clear();                                                 //!< Clear all change data
+    data &addGroup(const data &);                                 //!< As `groups.push_back()` but reuses cleared memory
+    void clear();                                                 //!< Clear all change data; memory is kept for reuse
     bool empty() const;                                           //!< Check if change object is empty
     explicit operator bool() const;                               //!< True if object is not empty
     void sanityCheck(const std::vector<Group<Particle>> &) const; //!< Sanity check on contained object data
+
+  private:
+    std::vector<std::vector<int>> recycled_atoms; //!< Emptied `data::atoms` vectors with retained capacity
 };
 
 void to_json(json &, const Change::data &); //!< Serialize Change data to json
 void to_json(json &, const Change &);       //!< Serialise Change object to json
 
+/**
+ * @brief Structure-of-arrays mirror of the particle vector
+ *
+ * Positions and atom ids are stored in separate, contiguous
+ * arrays indexed as `Space::p` (including inactive particles). Inner
+ * non-bonded loops over a range of particles can thus use packed (SIMD)
+ * loads instead of striding through the much larger `Particle` objects.
+ * The mirror is refreshed from the particle vector by `Space::updateParticleArrays()`, which
+ * must be called by the code modifying particles before energies are evaluated; debug builds
+ * check this with `matches()`. Charges and other properties are not mirrored as pair
+ * potentials take whole particles.
+ */
+struct ParticleArrays {
+    std::vector<double> x, y, z; //!< Particle positions
+    std::vector<int> id;         //!< Atom ids
+
+    size_t size() const;                            //!< Number of mirrored particles
+    void clear();                                   //!< Remove all particles
+    void set(size_t index, const Particle &);       //!< Copy a single particle into the arrays
+    void update(const ParticleVector &);            //!< Copy all particles into the arrays
+    void update(const ParticleVector::const_iterator begin, const ParticleVector::const_iterator end,
+                size_t offset);                     //!< Copy a particle range into the arrays starting at offset
+    bool matches(const ParticleVector::const_iterator begin, const ParticleVector::const_iterator end,
+                 size_t offset) const; //!< True if a particle range equals the arrays starting at offset
+};
+
+/**
+ * @brief Undo log of modifications made directly to a Space
+ *
+ * Moves record particles, group data and the geometry *before* modifying them.
+ * `swap()` exchanges the recorded and the current values and hence toggles the Space
+ * between the state before and after the modification, at a cost proportional to the number
+ * of records. The journal is emptied with `commit()` whereas `rollback()` restores the state
+ * at the last commit. Recording is ignored unless the journal is enabled, see `enable()`.
+ */
+class SpaceJournal {
+  private:
+    std::vector<std::pair<size_t, Particle>> particles;     //!< Particle index and recorded particle
+    std::vector<std::pair<size_t, Group<Particle>>> groups; //!< Group index and recorded group data
+    std::vector<Point> positions;                           //!< Recorded positions of *all* particles (if any)
+    std::optional<Geometry::Chameleon> geometry;            //!< Recorded geometry (if any)
+    bool is_enabled = false;                                //!< Ignore all records if false
+    bool is_swapped = false;                                //!< True if the recorded state is in the Space
+
+  public:
+    void enable(bool);    //!< Turn recording on or off; empties the journal
+    bool enabled() const; //!< True if recording is turned on
+    bool empty() const;   //!< True if nothing is recorded
+    void recordParticles(const Space &, ParticleVector::const_iterator first,
+                         ParticleVector::const_iterator last); //!< Record range of particles
+    void recordGroupData(const Space &, const Group<Particle> &); //!< Record group data, but *not* its particles
+    void recordGroup(const Space &, const Group<Particle> &);     //!< Record group data and all its particles
+    void recordPositions(const Space &); //!< Record geometry, positions of all particles, and all group data
+    void swap(Space &);                  //!< Exchange recorded and current values
+    void commit();                       //!< Accept all modifications since last commit
+    void rollback(Space &);              //!< Restore state at last commit
+    //! Index and value at the last commit of every recorded particle, sorted by index
+    void committedParticles(std::vector<std::pair<size_t, const Particle *>> &) const;
+    const Group<Particle> *committedGroupData(size_t) const; //!< Group data at the last commit, if recorded
+};
+
 /**
  * @brief Placeholder for atoms and molecules
  */
@@ -83,6 +154,8 @@ class Space {
     ParticleVector p;                                       //!< Particle vector storing all particles in system
     Tgvec groups;                                           //!< Group vector storing all molecules in system
     Tgeometry geo;                                          //!< Container geometry (boundaries, shape, volume)
+    ParticleArrays particle_arrays;                         //!< Structure-of-arrays mirror of `p`
+    SpaceJournal journal;                                   //!< Undo log for moves operating on a single Space
     std::vector<ScaleVolumeTrigger> scaleVolumeTriggers;    //!< Called whenever the volume is scaled
     const std::map<int, int> &getImplicitReservoir() const; //!< Storage for implicit molecules
     std::map<int, int> &getImplicitReservoir();             //!< Storage for implicit molecules
@@ -242,6 +315,8 @@ class Space {
     void sync(const Space &other,
               const Tchange &change); //!< Copy differing data from other (o) Space using Change object
 
+    void updateParticleArrays(const Tchange &change); //!< Refresh `particle_arrays` for particles touched by change
+
 }; // end of space
 
 void to_json(json &j, Space &spc);         //!< Serialize Space to json object
@@ -7,6 +7,9 @@
 #include <algorithm>
 #include <cmath>
 #include <memory>
+#include <cassert>
+#include <stdexcept>
+#include <array>
 
 namespace Faunus {
 
@@ -23,6 +26,15 @@ namespace Faunus {
 
 namespace Tabulate {
 
+/**
+ * @brief Placement of the knots in a table
+ *
+ * - `ADAPTIVE` knots along r² are placed where needed and found by a logarithmic search (Andrea)
+ * - `SQUARED_DISTANCE` equidistant knots along r² with constant time lookup (Equidistant)
+ * - `INVERSE_DISTANCE` equidistant knots along 1/r with constant time lookup (Equidistant)
+ */
+enum class GridSpacing { ADAPTIVE, SQUARED_DISTANCE, INVERSE_DISTANCE };
+
 /* base class for all tabulators - no dependencies */
 template <typename T = double> class TabulatorBase {
   protected:
@@ -52,11 +64,14 @@ template <typename T = double> class TabulatorBase {
 
   public:
     struct data {
-        std::vector<T> r2;      // r2 for intervals
+        std::vector<T> r2;      // r2 for intervals (adaptive grid only)
         std::vector<T> c;       // c for coefficents
         T rmin2 = 0, rmax2 = 0; // useful to save these with table
+        GridSpacing spacing = GridSpacing::ADAPTIVE;
+        T xmin = 0, dx = 0, dx_inv = 0; // first knot and knot spacing (equidistant grids only)
         bool empty() const { return r2.empty() && c.empty(); }
-        inline size_t numKnots() const { return r2.size(); }
+        inline size_t numKnots() const { return c.empty() ? r2.size() : c.size() / 6 + 1; }
+        inline size_t bytes() const { return (r2.size() + c.size()) * sizeof(T); } //!< memory used by the table
     };
 
     void setTolerance(T _utol, T _ftol = -1, T _umaxtol = -1, T _fmaxtol = -1) {
@@ -177,6 +192,26 @@ template <typename T = double> class Andrea : public TabulatorBase<T> {
                          dz * (d.c[pos6 + 2] + dz * (d.c[pos6 + 3] + dz * (d.c[pos6 + 4] + dz * (d.c[pos6 + 5])))));
     }
 
+    /**
+     * @brief Index of the knot interval containing r2
+     * @param d Table data
+     * @param r2 value in the interval ]rmin2,rmax2]
+     *
+     * Same result as the search in `eval()`, but the binary search has a fixed number of
+     * iterations for a given table and compiles to conditional moves. This makes it suited
+     * for interleaved lookups of many values, see `SplinedPotential`.
+     */
+    inline size_t interval(const typename base::data &d, T r2) const {
+        assert(r2 > d.r2.front() && r2 <= d.r2.back());
+        const T *first = d.r2.data();
+        for (size_t length = d.r2.size(); length > 1;) {
+            const size_t half = length / 2;
+            first = (first[half] < r2) ? first + half : first;
+            length -= half;
+        }
+        return first - d.r2.data();
+    }
+
     /**
      * @brief Get tabulated value at df(x)/dx
      * @param d Table data
@@ -299,10 +334,358 @@ template <typename T = double> class Andrea : public TabulatorBase<T> {
 #endif
     }
 };
+
+/**
+ * @brief Table with equidistant knots along r² or 1/r
+ *
+ * Each interval is a quintic Hermite polynomial matching the value as well as the
+ * first and second derivatives at both knots, i.e. the same representation as in `Andrea`.
+ * As the knots are equidistant, the interval is found by a single multiplication rather
+ * than a search, and evaluation has no data dependent branches. The number of knots is
+ * doubled until the tolerances `utol` and `ftol` (if given) are met within each interval;
+ * `umaxtol` and `fmaxtol` are ignored.
+ *
+ * - `SQUARED_DISTANCE`: cheapest lookup; suited for potentials which are smooth in r²
+ * - `INVERSE_DISTANCE`: needs a square root but places more knots at short separations
+ *   where steep potentials vary the most. The table hence is often much smaller.
+ *
+ * The coefficients of an interval are found with `locate()`, such that evaluation of many
+ * tables can be interleaved (see `SplinedPotential`).
+ */
+template <typename T = double> class Equidistant : public TabulatorBase<T> {
+  private:
+    typedef TabulatorBase<T> base;
+    size_t max_intervals = 1u << 16; // upper limit before giving up
+
+    static inline T toGrid(const typename base::data &d, T r2) {
+        return (d.spacing == GridSpacing::INVERSE_DISTANCE) ? 1 / std::sqrt(r2) : r2;
+    } //!< r² --> grid coordinate
+
+    static inline T fromGrid(GridSpacing spacing, T x) {
+        return (spacing == GridSpacing::INVERSE_DISTANCE) ? 1 / (x * x) : x;
+    } //!< grid coordinate --> r²
+
+    bool isWithinTolerance(const typename base::data &d, std::function<T(T)> f, T xlow, T xupp) const {
+        constexpr int num_checks = 11; // number of points to control in each interval
+        for (int i = 0; i < num_checks; i++) {
+            const T r2 = fromGrid(d.spacing, xlow + (xupp - xlow) * i / (num_checks - 1));
+            if (!(std::fabs(eval(d, r2) - f(r2)) <= base::utol)) { // also rejects non-finite values
+                return false;
+            }
+            if (base::ftol != -1 && std::fabs(evalDer(d, r2) - base::f1(f, r2)) > base::ftol) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+  public:
+    /**
+     * @brief Spline coefficients of the interval containing r2
+     * @param d Table data
+     * @param r2 value in the interval [rmin2,rmax2]
+     * @param dz Output distance from the lower knot of the interval (in grid coordinates)
+     * @returns Pointer to the six polynomial coefficients of the interval
+     */
+    inline const T *locate(const typename base::data &d, T r2, T &dz) const {
+        const T t = (toGrid(d, r2) - d.xmin) * d.dx_inv;
+        const size_t last = d.c.size() / 6 - 1; // clamp as rounding may push the upper boundary out
+        const size_t pos = std::min(static_cast<size_t>(std::max(t, T(0))), last);
+        dz = (t - static_cast<T>(pos)) * d.dx;
+        return d.c.data() + 6 * pos;
+    }
+
+    /**
+     * @brief Get tabulated value at f(x)
+     * @param d Table data
+     * @param r2 value
+     */
+    inline T eval(const typename base::data &d, T r2) const {
+        T dz;
+        const T *c = locate(d, r2, dz);
+        return c[0] + dz * (c[1] + dz * (c[2] + dz * (c[3] + dz * (c[4] + dz * c[5]))));
+    }
+
+    /**
+     * @brief Get tabulated value at df(x)/dx with x=r²
+     * @param d Table data
+     * @param r2 value
+     */
+    T evalDer(const typename base::data &d, T r2) const {
+        T dz;
+        const T *c = locate(d, r2, dz);
+        const T derivative = c[1] + dz * (2.0 * c[2] + dz * (3.0 * c[3] + dz * (4.0 * c[4] + dz * (5.0 * c[5]))));
+        if (d.spacing == GridSpacing::INVERSE_DISTANCE) {
+            const T x = toGrid(d, r2);
+            return -0.5 * x * x * x * derivative; // dx/dr² = -x³/2
+        }
+        return derivative;
+    }
+
+    /**
+     * @brief Tabulate f(x) in interval [min,max]
+     * @param f Function of r²
+     * @param rmin2 Lower bound of r²
+     * @param rmax2 Upper bound of r²
+     * @param spacing Placement of the knots; must be equidistant
+     */
+    typename base::data generate(std::function<T(T)> f, T rmin2, T rmax2, GridSpacing spacing) {
+        if (spacing == GridSpacing::ADAPTIVE) {
+            throw std::runtime_error("Equidistant spline: equidistant grid spacing required");
+        }
+        base::check();
+        typename base::data d;
+        d.rmin2 = rmin2;
+        d.rmax2 = rmax2;
+        d.spacing = spacing;
+        const T x_first = toGrid(d, rmin2);
+        const T x_last = toGrid(d, rmax2);
+        d.xmin = std::min(x_first, x_last);
+        const T length = std::fabs(x_last - x_first);
+        auto g = [&](T x) { return f(fromGrid(spacing, x)); }; // f along the grid coordinate
+
+        for (size_t num_intervals = 8; num_intervals <= max_intervals; num_intervals *= 2) {
+            d.dx = length / num_intervals;
+            d.dx_inv = 1 / d.dx;
+            d.c.clear();
+            d.c.reserve(6 * num_intervals);
+            T xlow = d.xmin;
+            T u0low = g(xlow), u1low = base::f1(g, xlow), u2low = base::f2(g, xlow);
+            for (size_t i = 1; i <= num_intervals; i++) {
+                const T xupp = d.xmin + i * d.dx;
+                const T u0upp = g(xupp), u1upp = base::f1(g, xupp), u2upp = base::f2(g, xupp);
+                const T dz1 = d.dx, dz2 = dz1 * dz1, dz3 = dz2 * dz1;
+                const T c0 = u0low, c1 = u1low, c2 = 0.5 * u2low;
+                const T a = 6 * (u0upp - c0 - c1 * dz1 - c2 * dz2) / dz3;
+                const T b = 2 * (u1upp - c1 - 2 * c2 * dz1) / dz2;
+                const T c = (u2upp - 2 * c2) / dz1;
+                d.c.insert(d.c.end(), {c0, c1, c2, (10 * a - 12 * b + 3 * c) / 6, (-15 * a + 21 * b - 6 * c) / (6 * dz1),
+                                       (2 * a - 3 * b + c) / (2 * dz2)});
+                xlow = xupp;
+                u0low = u0upp;
+                u1low = u1upp;
+                u2low = u2upp;
+            }
+            bool approved = true;
+            for (size_t i = 0; i < num_intervals && approved; i++) {
+                approved = isWithinTolerance(d, f, d.xmin + i * d.dx, d.xmin + (i + 1) * d.dx);
+            }
+            if (approved) {
+                return d;
+            }
+        }
+        throw std::runtime_error("Equidistant spline: try to increase utol/ftol");
+    }
+};
+
+/**
+ * @brief Trilinear interpolation of f(x,y,z) on a regular grid
+ *
+ * The grid is either sampled with a given resolution by `sample()`, or by `generate()`
+ * which, starting from a coarse grid, doubles the number of nodes along each active
+ * dimension until the absolute error at all cell centres is below `utol`. Inactive
+ * dimensions have a single node, such that a function of fewer than three coordinates
+ * is sampled only along the axes it depends on. Generation fails with an exception if
+ * the function is not finite or if the tolerance cannot be met within `max_nodes`.
+ */
+template <typename T = double> class Grid3D {
+  private:
+    T utol = 1e-5;
+    size_t max_nodes = 1u << 22; // upper limit on the number of sampled values
+
+  public:
+    typedef std::array<T, 3> Point;
+
+    struct data {
+        Point low = {0, 0, 0}, high = {0, 0, 0}; // corners of the sampled region
+        Point spacing_inv = {0, 0, 0};           // inverse node spacing; zero for inactive dimensions
+        std::array<size_t, 3> nodes = {1, 1, 1}; // number of nodes along each dimension
+        std::vector<T> values;                   // function values in row-major order
+        bool empty() const { return values.empty(); }
+        inline size_t bytes() const { return values.size() * sizeof(T); } //!< memory used by the grid
+        inline bool contains(const Point &p) const {
+            for (size_t d = 0; d < 3; d++) {
+                if (nodes[d] > 1 && !(p[d] >= low[d] && p[d] <= high[d])) {
+                    return false;
+                }
+            }
+            return true;
+        } //!< true if point is inside the sampled region (inactive dimensions are ignored)
+    };
+
+    void setTolerance(T _utol) { utol = _utol; }
+    void setMaxNodes(size_t n) { max_nodes = n; }
+
+  private:
+    Point fill(std::function<T(const Point &)> &f, data &d) const {
+        Point spacing = {0, 0, 0};
+        for (size_t i = 0; i < 3; i++) {
+            if (d.nodes[i] > 1) {
+                spacing[i] = (d.high[i] - d.low[i]) / static_cast<T>(d.nodes[i] - 1);
+                d.spacing_inv[i] = 1 / spacing[i];
+            }
+        }
+        d.values.resize(d.nodes[0] * d.nodes[1] * d.nodes[2]);
+        auto value = d.values.begin();
+        for (size_t i = 0; i < d.nodes[0]; i++) {
+            for (size_t j = 0; j < d.nodes[1]; j++) {
+                for (size_t k = 0; k < d.nodes[2]; k++) {
+                    *value = f({d.low[0] + i * spacing[0], d.low[1] + j * spacing[1], d.low[2] + k * spacing[2]});
+                    if (!std::isfinite(*value++)) {
+                        throw std::runtime_error("Grid3D: function is not finite");
+                    }
+                }
+            }
+        }
+        return spacing;
+    } //!< sample f on the nodes of d and return the node spacing
+
+  public:
+
+    /**
+     * @brief Interpolated value at point which must be inside the grid, see `data::contains()`
+     */
+    inline T eval(const data &d, const Point &p) const {
+        size_t offset = 0;
+        std::array<size_t, 3> stride = {0, 0, 0};
+        Point w = {0, 0, 0}; // fractional position within the cell
+        size_t block = 1;
+        for (int i = 2; i >= 0; i--) {
+            if (d.nodes[i] > 1) {
+                const T t = std::max((p[i] - d.low[i]) * d.spacing_inv[i], T(0));
+                const size_t cell = std::min(static_cast<size_t>(t), d.nodes[i] - 2);
+                w[i] = t - static_cast<T>(cell);
+                offset += cell * block;
+                stride[i] = block;
+            }
+            block *= d.nodes[i];
+        }
+        const T *v = d.values.data() + offset;
+        auto lerp = [](T a, T b, T t) { return a + t * (b - a); };
+        auto line = [&](size_t i) { return lerp(v[i], v[i + stride[2]], w[2]); };
+        auto plane = [&](size_t i) { return lerp(line(i), line(i + stride[1]), w[1]); };
+        return lerp(plane(0), plane(stride[0]), w[0]);
+    }
+
+    /**
+     * @brief Sample f on a grid with a given number of nodes along each dimension; no error control
+     * @param f Function to tabulate
+     * @param low Lower corner
+     * @param high Upper corner
+     * @param nodes Number of nodes along each dimension; one for inactive dimensions
+     */
+    data sample(std::function<T(const Point &)> f, const Point &low, const Point &high,
+                const std::array<size_t, 3> &nodes) const {
+        data d;
+        d.low = low;
+        d.high = high;
+        d.nodes = nodes;
+        fill(f, d);
+        return d;
+    }
+
+    /**
+     * @brief Sample f in the box [low,high] with increasing resolution until the tolerance is met
+     * @param f Function to tabulate
+     * @param low Lower corner
+     * @param high Upper corner
+     * @param active Dimensions that f depends on
+     */
+    data generate(std::function<T(const Point &)> f, const Point &low, const Point &high,
+                  const std::array<bool, 3> &active) {
+        data d;
+        d.low = low;
+        d.high = high;
+        for (size_t i = 0; i < 3; i++) {
+            d.nodes[i] = active[i] ? 9 : 1;
+        }
+        while (d.nodes[0] * d.nodes[1] * d.nodes[2] <= max_nodes) {
+            const Point spacing = fill(f, d);
+            T max_error = 0; // error is largest at cell centres where interpolation is furthest from nodes
+            for (size_t i = 0; i < std::max(d.nodes[0] - 1, size_t(1)); i++) {
+                for (size_t j = 0; j < std::max(d.nodes[1] - 1, size_t(1)); j++) {
+                    for (size_t k = 0; k < std::max(d.nodes[2] - 1, size_t(1)); k++) {
+                        const Point p = {low[0] + (i + 0.5) * spacing[0], low[1] + (j + 0.5) * spacing[1],
+                                         low[2] + (k + 0.5) * spacing[2]};
+                        const T exact = f(p);
+                        if (!std::isfinite(exact)) {
+                            throw std::runtime_error("Grid3D: function is not finite");
+                        }
+                        max_error = std::max(max_error, std::fabs(eval(d, p) - exact));
+                    }
+                }
+            }
+            if (max_error <= utol) {
+                return d;
+            }
+            for (size_t i = 0; i < 3; i++) {
+                if (d.nodes[i] > 1) {
+                    d.nodes[i] = 2 * d.nodes[i] - 1; // halve the spacing
+                }
+            }
+        }
+        throw std::runtime_error("Grid3D: try to increase utol");
+    }
+};
 } // namespace Tabulate
 } // namespace Faunus
 
 #ifdef DOCTEST_LIBRARY_INCLUDED
+TEST_CASE("[Faunus] Equidistant") {
+    using doctest::Approx;
+    using namespace Faunus::Tabulate;
+
+    auto f = [](double r2) { return 1.0 / r2 - 1.0 / std::sqrt(r2); };
+    Equidistant<double> spline;
+    spline.setTolerance(1e-6, 1e-4);
+    for (auto spacing : {GridSpacing::SQUARED_DISTANCE, GridSpacing::INVERSE_DISTANCE}) {
+        auto d = spline.generate(f, 1.0, 100.0, spacing);
+        CHECK(d.spacing == spacing);
+        CHECK(d.numKnots() > 2);
+        CHECK(d.bytes() == d.c.size() * sizeof(double));
+        for (double r2 : {1.0, 1.5, 4.0, 33.3, 99.9, 100.0}) {
+            CHECK(spline.eval(d, r2) == Approx(f(r2)).epsilon(1e-5));
+        }
+        const double r2 = 7.0;
+        auto f_prime = [&](double dx = 1e-6) { return (f(r2 + dx) - f(r2 - dx)) / (2 * dx); };
+        CHECK(spline.evalDer(d, r2) == Approx(f_prime()).epsilon(1e-3));
+    }
+    CHECK_THROWS(spline.generate(f, 1.0, 100.0, GridSpacing::ADAPTIVE));
+}
+
+TEST_CASE("[Faunus] Grid3D") {
+    using doctest::Approx;
+    using namespace Faunus::Tabulate;
+    typedef Grid3D<double>::Point Point;
+
+    auto f = [](const Point &p) { return std::sin(p[0]) * std::cos(p[2]); }; // independent of y
+    Grid3D<double> grid;
+    grid.setTolerance(1e-4);
+    auto d = grid.generate(f, {-2, -5, -3}, {2, 5, 3}, {true, false, true});
+    CHECK(d.nodes[0] > 9);
+    CHECK(d.nodes[1] == 1);
+    CHECK(d.values.size() == d.nodes[0] * d.nodes[2]);
+    CHECK(d.contains({2, 100, -3}));
+    CHECK_FALSE(d.contains({2.1, 0, 0}));
+    for (const Point &p : std::vector<Point>{{-2, 0, -3}, {2, 1, 3}, {0.3, -4, 1.1}, {-1.7, 2, -2.9}}) {
+        CHECK(std::fabs(grid.eval(d, p) - f(p)) < 1e-4);
+    }
+    CHECK(grid.eval(d, {0, 0, 0}) == Approx(0).epsilon(1e-12));
+
+    auto bilinear = [](const Point &p) { return p[0] * p[1] + 2 * p[2]; }; // exact on the coarsest grid
+    d = grid.generate(bilinear, {-1, -1, -1}, {1, 1, 1}, {true, true, true});
+    CHECK(d.values.size() == 9 * 9 * 9);
+    CHECK(grid.eval(d, {0.33, -0.71, 0.1}) == Approx(bilinear({0.33, -0.71, 0.1})));
+
+    d = grid.sample(f, {-2, -5, -3}, {2, 5, 3}, {5, 2, 7});
+    CHECK(d.values.size() == 5 * 2 * 7);
+    CHECK(grid.eval(d, {1, 5, 3}) == Approx(f({1, 5, 3}))); // on a node
+
+    CHECK_THROWS(grid.generate([](const Point &p) { return 1 / p[0]; }, {-1, 0, 0}, {1, 0, 0}, {true, false, false}));
+    grid.setMaxNodes(100);
+    CHECK_THROWS(grid.generate(f, {-2, -5, -3}, {2, 5, 3}, {true, false, true}));
+}
+
 TEST_CASE("[Faunus] Andrea") {
     using doctest::Approx;
     using namespace Faunus::Tabulate;
@@ -316,6 +699,18 @@ TEST_CASE("[Faunus] Andrea") {
     CHECK(spline.eval(d, 5) == Approx(f(5)));
     CHECK(spline.eval(d, 10) == Approx(f(10)));
 
+    // branch-free knot lookup must match the logarithmic search in `eval()`
+    for (double x : {1e-9, 0.5, 1.0, 5.0, 9.99, 10.0}) {
+        const size_t pos = std::lower_bound(d.r2.begin(), d.r2.end(), x) - d.r2.begin() - 1;
+        CHECK(spline.interval(d, x) == pos);
+    }
+    for (double x : d.r2) { // exactly on the knots
+        if (x > d.r2.front()) {
+            const size_t pos = std::lower_bound(d.r2.begin(), d.r2.end(), x) - d.r2.begin() - 1;
+            CHECK(spline.interval(d, x) == pos);
+        }
+    }
+
     // Check if numerical derivation of *splined* function
     // matches the analytical solution in `evalDer()`.
     auto f_prime = [&](double x, double dx = 1e-10) {